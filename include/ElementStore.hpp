@@ -0,0 +1,206 @@
+#ifndef OCR_ELEMENT_STORE_HPP
+#define OCR_ELEMENT_STORE_HPP
+
+#include "OCRAnalysis.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ocr {
+
+/// Small integer handle for an interned font name (0 = no font).
+using FontId = std::uint16_t;
+
+/**
+ * @brief Interning table for font names.
+ *
+ * A label typically uses a handful of distinct fonts, but every extracted word
+ * carries its own copy of the name.  The table stores each distinct name once
+ * and hands out a small id that element stores keep instead of the string.
+ * Id 0 is reserved for the empty name.
+ */
+class FontTable {
+public:
+  FontTable();
+
+  /**
+   * @brief Return the id for @p name, adding it to the table if unseen
+   * @param name Font family name
+   * @return Interned id (0 for an empty name)
+   */
+  FontId intern(std::string_view name);
+
+  /**
+   * @brief Look up the name for an id previously returned by intern()
+   * @param id Interned id
+   * @return View of the stored name (empty for unknown ids)
+   */
+  std::string_view name(FontId id) const;
+
+  /// Number of distinct names, including the reserved empty name.
+  size_t size() const { return m_names.size(); }
+
+private:
+  std::vector<std::string> m_names;               ///< id -> name
+  std::unordered_map<std::string, FontId> m_ids; ///< name -> id
+};
+
+/**
+ * @brief Read-only view of one entry in a TextRegionStore
+ *
+ * The string fields point into the owning store's text arena and font table,
+ * so a view must not outlive the store (or survive a call that appends to it).
+ */
+struct TextRegionView {
+  std::string_view text;     ///< Text content (arena-backed)
+  std::string_view fontName; ///< Interned font family name
+  cv::Rect boundingBox;      ///< Integer bounding rectangle
+  float confidence = 0.0f;   ///< Confidence score (0-100)
+  int level = 0;             ///< Hierarchy level
+  TextOrientation orientation = TextOrientation::Unknown;
+  double preciseX = 0.0;      ///< X position in points
+  double preciseY = 0.0;      ///< Y position in points
+  double preciseWidth = 0.0;  ///< Width in points
+  double preciseHeight = 0.0; ///< Height in points
+  double fontSize = 0.0;      ///< Font size in points
+  bool isBold = false;        ///< Whether font is bold
+  bool isItalic = false;      ///< Whether font is italic
+
+  /// Materialise an owning TextRegion (copies the strings).
+  TextRegion toTextRegion() const;
+};
+
+/**
+ * @brief Columnar (struct-of-arrays) store for text regions
+ *
+ * Coordinates, sizes and flags live in parallel contiguous arrays, all text is
+ * packed into a single character arena addressed by offset/length, and font
+ * names are interned through a FontTable.  Geometry passes (bounds, ROI
+ * filtering, reading-order sort) stream through the coordinate columns only
+ * and never touch the strings.
+ *
+ * Conversion to and from std::vector<TextRegion> is provided so the store can
+ * be used alongside the existing PDFElements / OCRResult APIs.
+ *
+ * Example usage:
+ * @code
+ * ocr::TextRegionStore store =
+ *     ocr::TextRegionStore::fromRegions(elements.hiddenTextLines);
+ * for (uint32_t i : store.indicesInBounds(minX, minY, maxX, maxY))
+ *     std::cout << store.text(i) << std::endl;
+ * @endcode
+ */
+class TextRegionStore {
+public:
+  TextRegionStore() = default;
+
+  /**
+   * @brief Build a store from an existing vector of regions
+   * @param regions Source regions (not modified)
+   * @return Store holding a compact copy of @p regions
+   */
+  static TextRegionStore fromRegions(const std::vector<TextRegion> &regions);
+
+  /**
+   * @brief Reserve capacity for @p count regions and @p textBytes characters
+   */
+  void reserve(size_t count, size_t textBytes = 0);
+
+  /// Remove all regions (the font table is kept).
+  void clear();
+
+  /// Append one region.
+  void push_back(const TextRegion &region);
+
+  /// Append every region in @p regions.
+  void append(const std::vector<TextRegion> &regions);
+
+  size_t size() const { return m_x.size(); }
+  bool empty() const { return m_x.empty(); }
+
+  /// View of region @p i (strings point into this store).
+  TextRegionView operator[](size_t i) const;
+
+  std::string_view text(size_t i) const {
+    return std::string_view(m_arena.data() + m_textOffset[i], m_textLength[i]);
+  }
+  std::string_view fontName(size_t i) const { return m_fonts.name(m_fontId[i]); }
+  FontId fontId(size_t i) const { return m_fontId[i]; }
+  bool isBold(size_t i) const { return (m_flags[i] & kBold) != 0; }
+  bool isItalic(size_t i) const { return (m_flags[i] & kItalic) != 0; }
+
+  // Geometry columns (PDF points, same conventions as TextRegion::precise*)
+  const std::vector<double> &xs() const { return m_x; }
+  const std::vector<double> &ys() const { return m_y; }
+  const std::vector<double> &widths() const { return m_width; }
+  const std::vector<double> &heights() const { return m_height; }
+  const std::vector<double> &fontSizes() const { return m_fontSize; }
+
+  const FontTable &fonts() const { return m_fonts; }
+
+  /// Materialise region @p i as an owning TextRegion.
+  TextRegion toTextRegion(size_t i) const { return (*this)[i].toTextRegion(); }
+
+  /// Materialise every region, in store order.
+  std::vector<TextRegion> toRegions() const;
+
+  /**
+   * @brief Compute the union bounding box of all regions
+   *
+   * Uses the precise coordinates when available (preciseWidth > 0), falling
+   * back to the integer bounding box otherwise, matching the rule used when
+   * regions are mapped to relative coordinates.
+   *
+   * @return false if the store is empty
+   */
+  bool bounds(double &minX, double &minY, double &maxX, double &maxY) const;
+
+  /**
+   * @brief Indices of regions whose precise centre lies inside the given box
+   * @return Ascending list of indices
+   */
+  std::vector<uint32_t> indicesInBounds(double minX, double minY, double maxX,
+                                        double maxY) const;
+
+  /**
+   * @brief Reading-order permutation (top to bottom, then left to right)
+   *
+   * Regions are ordered by Y, then grouped into lines: a region whose Y is
+   * within @p yTolerance points of the first region of the current line joins
+   * that line.  Regions within a line are ordered by X.
+   *
+   * @return Permutation of [0, size())
+   */
+  std::vector<uint32_t> sortedByPosition(double yTolerance = 2.0) const;
+
+  /// Approximate heap usage of the store in bytes.
+  size_t memoryBytes() const;
+
+private:
+  enum : std::uint8_t { kBold = 1, kItalic = 2 };
+
+  // Precise geometry (points)
+  std::vector<double> m_x, m_y, m_width, m_height;
+  // Integer bounding box
+  std::vector<int32_t> m_boxX, m_boxY, m_boxW, m_boxH;
+  // Per-region attributes
+  std::vector<float> m_confidence;
+  std::vector<double> m_fontSize;
+  std::vector<int32_t> m_level;
+  std::vector<std::uint8_t> m_orientation;
+  std::vector<std::uint8_t> m_flags;
+  std::vector<FontId> m_fontId;
+  // Text arena
+  std::vector<uint32_t> m_textOffset;
+  std::vector<uint32_t> m_textLength;
+  std::string m_arena;
+
+  FontTable m_fonts;
+};
+
+} // namespace ocr
+
+#endif // OCR_ELEMENT_STORE_HPP
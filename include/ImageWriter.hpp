@@ -0,0 +1,112 @@
+#ifndef OCR_IMAGE_WRITER_HPP
+#define OCR_IMAGE_WRITER_HPP
+
+#include <opencv2/core.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ocr {
+
+/**
+ * @brief Bounded background pool that encodes and writes images to disk
+ *
+ * Each write() queues a (path, image, encoder params) job that a worker
+ * thread encodes with cv::imwrite, so the caller does not wait on zlib or
+ * the disk.  At most @c maxQueued jobs may be pending; write() blocks while
+ * the queue is full, which bounds the memory held by images in flight.
+ *
+ * The writer keeps a reference to each image until it has been written, so
+ * the caller must not draw into a Mat after handing it over.  Mats that wrap
+ * an external buffer (e.g. a renderer's bitmap) are copied on submission.
+ *
+ * By default .png files are encoded with OpenCV's default settings, so the
+ * bytes match a plain cv::imwrite.  Setting a compression level also makes
+ * OpenCV switch zlib from its RLE strategy to the default one, so files
+ * written with any explicit level differ from the default output.
+ *
+ * With zero threads every write() runs inline on the calling thread.
+ *
+ * Example usage:
+ * @code
+ * ocr::ImageWriter writer(2, 16, 3);
+ * writer.write("page.png", image);
+ * ...
+ * writer.wait(); // all files are on disk
+ * @endcode
+ */
+class ImageWriter {
+public:
+  /**
+   * @param threads Number of worker threads (0 = write inline)
+   * @param maxQueued Maximum number of pending jobs before write() blocks
+   * @param pngCompression zlib level (0-9) used for .png files, or -1 to
+   *        leave OpenCV's default encoder settings
+   */
+  explicit ImageWriter(int threads = 2, size_t maxQueued = 16,
+                       int pngCompression = -1);
+
+  /// Finishes every queued job, then stops the workers.
+  ~ImageWriter();
+
+  ImageWriter(const ImageWriter &) = delete;
+  ImageWriter &operator=(const ImageWriter &) = delete;
+
+  /**
+   * @brief Queue @p image to be written to @p path
+   * @param path Output file; the format follows the extension
+   * @param image Image to write
+   * @param params Extra cv::imwrite parameters.  When a compression level
+   *        was configured, .png files get IMWRITE_PNG_COMPRESSION unless
+   *        @p params already sets it.
+   * @return Future that becomes true once the file is written, or false if
+   *         encoding or writing failed
+   */
+  std::future<bool> write(const std::string &path, const cv::Mat &image,
+                          std::vector<int> params = {});
+
+  /// Block until every job queued so far has finished.
+  void wait();
+
+  int threadCount() const { return static_cast<int>(m_workers.size()); }
+  int pngCompression() const { return m_pngCompression; }
+
+  /// Number of files written successfully / unsuccessfully so far.
+  size_t writtenCount() const { return m_written; }
+  size_t failedCount() const { return m_failed; }
+
+private:
+  struct Job {
+    std::string path;
+    cv::Mat image;
+    std::vector<int> params;
+    std::promise<bool> done;
+  };
+
+  void workerLoop();
+  bool run(Job &job);
+
+  std::vector<std::thread> m_workers;
+  std::deque<Job> m_queue;
+  std::mutex m_mutex;
+  std::condition_variable m_notEmpty; ///< Signalled when a job is queued
+  std::condition_variable m_notFull;  ///< Signalled when a job is taken
+  std::condition_variable m_idle;     ///< Signalled when a job finishes
+  size_t m_maxQueued;
+  size_t m_active = 0; ///< Jobs currently being encoded
+  bool m_stopping = false;
+  int m_pngCompression;
+  std::atomic<size_t> m_written{0};
+  std::atomic<size_t> m_failed{0};
+};
+
+} // namespace ocr
+
+#endif // OCR_IMAGE_WRITER_HPP
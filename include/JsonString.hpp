@@ -0,0 +1,49 @@
+#ifndef OCR_JSON_STRING_HPP
+#define OCR_JSON_STRING_HPP
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace ocr {
+
+/**
+ * @brief Append @p s to @p out as a quoted JSON string
+ *
+ * Escapes quotes, backslashes and control characters; other bytes,
+ * including UTF-8 sequences, are copied unchanged.  Internal helper shared
+ * by the tracer and the command-line tools' JSON writers.
+ */
+inline void appendJsonString(std::string &out, std::string_view s) {
+  out += '"';
+  for (unsigned char c : s) {
+    switch (c) {
+    case '"':  out += "\\\""; break;
+    case '\\': out += "\\\\"; break;
+    case '\n': out += "\\n"; break;
+    case '\r': out += "\\r"; break;
+    case '\t': out += "\\t"; break;
+    default:
+      if (c < 0x20) {
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+        out += buf;
+      } else {
+        out += static_cast<char>(c);
+      }
+    }
+  }
+  out += '"';
+}
+
+/// @brief @p s as a quoted JSON string (see appendJsonString)
+inline std::string jsonString(std::string_view s) {
+  std::string out;
+  out.reserve(s.size() + 2);
+  appendJsonString(out, s);
+  return out;
+}
+
+} // namespace ocr
+
+#endif // OCR_JSON_STRING_HPP
@@ -0,0 +1,110 @@
+#ifndef OCR_LOG_HPP
+#define OCR_LOG_HPP
+
+#include <atomic>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace ocr {
+
+enum class LogLevel { Debug = 0, Info = 1, Warning = 2, Error = 3, Off = 4 };
+
+/**
+ * @brief Process-wide log level and sink used by the library's diagnostics
+ *
+ * Messages are written with the OCR_DEBUG / OCR_INFO / OCR_WARN / OCR_ERROR
+ * macros below.  Each message is formatted into its own buffer and handed to
+ * the sink in one call, so lines from concurrent workers never interleave.
+ *
+ * Messages below OCR_LOG_MIN_LEVEL are removed at compile time.  It defaults
+ * to Info when NDEBUG is defined and Debug otherwise; define it (0-4) to
+ * override.  Above that, the runtime level decides; it starts at Info, or
+ * at the value of the OCR_LOG_LEVEL environment variable (debug, info,
+ * warning, error or off).
+ *
+ * Example usage:
+ * @code
+ * ocr::Log::setLevel(ocr::LogLevel::Warning);
+ * ocr::Log::setSink([](ocr::LogLevel level, std::string_view message) {
+ *   myLogger.write(ocr::Log::levelName(level), message);
+ * });
+ * @endcode
+ */
+class Log {
+public:
+  using Sink = std::function<void(LogLevel, std::string_view)>;
+
+  static void setLevel(LogLevel level);
+  static LogLevel level();
+
+  static bool enabled(LogLevel level) {
+    return static_cast<int>(level) >= s_level.load(std::memory_order_relaxed);
+  }
+
+  /// Replace the sink; an empty function restores the default (stderr).
+  static void setSink(Sink sink);
+
+  /// Sink for messages logged on the calling thread only, used instead of
+  /// the process-wide one until reset with an empty function.  Lets a
+  /// worker collect the diagnostics of the document it is processing.
+  /// Messages from threads the library starts itself (parallel barcode
+  /// reads, image writes, cv::parallel_for_) still go to the process-wide
+  /// sink, as does anything Tesseract prints.
+  static void setThreadSink(Sink sink);
+
+  /// One message as the default sink prints it: level prefix, message and
+  /// trailing newline.
+  static std::string formatLine(LogLevel level, std::string_view message);
+
+  /// Pass one complete message (without trailing newline) to the sink.
+  static void write(LogLevel level, std::string_view message);
+
+  /// "debug", "info", "warning", "error" or "off".
+  static const char *levelName(LogLevel level);
+
+private:
+  static std::atomic<int> s_level;
+};
+
+/// Collects one message and writes it when the statement ends.
+class LogLine {
+public:
+  explicit LogLine(LogLevel level) : m_level(level) {}
+  ~LogLine() { Log::write(m_level, m_stream.str()); }
+
+  LogLine(const LogLine &) = delete;
+  LogLine &operator=(const LogLine &) = delete;
+
+  std::ostream &stream() { return m_stream; }
+
+private:
+  LogLevel m_level;
+  std::ostringstream m_stream;
+};
+
+} // namespace ocr
+
+#ifndef OCR_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define OCR_LOG_MIN_LEVEL 1
+#else
+#define OCR_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+// Usable as a statement prefix: OCR_WARN << "x=" << x;  The message is
+// neither formatted nor evaluated unless its level is enabled.
+#define OCR_LOG(level)                                                         \
+  if constexpr (static_cast<int>(level) < OCR_LOG_MIN_LEVEL) {                \
+  } else if (!::ocr::Log::enabled(level)) {                                    \
+  } else                                                                       \
+    ::ocr::LogLine(level).stream()
+
+#define OCR_DEBUG OCR_LOG(::ocr::LogLevel::Debug)
+#define OCR_INFO OCR_LOG(::ocr::LogLevel::Info)
+#define OCR_WARN OCR_LOG(::ocr::LogLevel::Warning)
+#define OCR_ERROR OCR_LOG(::ocr::LogLevel::Error)
+
+#endif // OCR_LOG_HPP
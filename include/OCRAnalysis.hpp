@@ -1,6 +1,8 @@
 #ifndef OCR_ANALYSIS_HPP
 #define OCR_ANALYSIS_HPP
 
+#include "StageProfile.hpp"
+
 #include <opencv2/opencv.hpp>
 #include <tesseract/baseapi.h>
 
@@ -10,6 +12,8 @@
 
 namespace ocr {
 
+class ImageWriter;
+
 /**
  * @brief Text orientation detected in a region
  */
@@ -54,6 +58,7 @@ struct OCRResult {
   double processingTimeMs;         ///< Processing time in milliseconds
   bool success;                    ///< Whether OCR was successful
   std::string errorMessage;        ///< Error message if failed
+  StageProfile profile;            ///< Per-stage timings and counters
 };
 
 /**
@@ -67,6 +72,30 @@ struct OCRConfig {
   int minConfidence = 0;       ///< Minimum confidence threshold (0-100)
   std::string tessDataPath =
       ""; ///< Path to tessdata directory (empty = default)
+
+  // Content-rect PDF export (extractPDFElements with renderContentRectPdf)
+  bool incrementalContentPdf =
+      true; ///< Append an incremental update instead of rewriting every object
+  bool contentPreviewFromOpenDoc =
+      true; ///< Render the PNG preview from the open document (no re-open)
+
+  // High-DPI page rasters (DataMatrix page scan, covered-text check)
+  size_t rasterMemoryBudget =
+      128 * 1024 * 1024; ///< Max bytes per render band (0 = whole page)
+  bool targetedDataMatrixScan =
+      true; ///< Find vector DataMatrix codes from the page geometry: scan
+            ///< clusters of filled shapes at ~4 px/module, then clusters of
+            ///< strokes, curves and glyphs no decoded code explains, instead
+            ///< of the whole page at 600 DPI (always used on rotated pages)
+  bool fullPageDataMatrixScan =
+      false; ///< Also run the full-page 600 DPI scan after the targeted one,
+             ///< for codes the page geometry does not show (slow)
+
+  // Image files written by extraction and rendering (see ImageWriter)
+  int imageWriterThreads =
+      0; ///< Background encoder threads (0 = write inline, before returning)
+  int pngCompression = -1; ///< zlib level (0-9) for PNG output; -1 keeps
+                           ///< OpenCV's default level and zlib strategy
 };
 
 /**
@@ -400,6 +429,11 @@ public:
 
     // Whether crop marks were detected and used to define the content area
     bool hasCropMarks = false;
+
+    /// Per-stage timings and counters: "text" (with "text/hiddenRaster"),
+    /// "fonts", "images", "dataMatrix1", "dataMatrix2", "rects", "lines",
+    /// "vectorGraphics", "l1ImageOcr" and "contentRect", as they ran
+    StageProfile profile;
   };
 
   /**
@@ -426,6 +460,8 @@ public:
    *                       file is named "<stem>_content.pdf" and is produced
    *                       by rewriting the page CropBox/TrimBox/BleedBox/
    *                       ArtBox so trim marks fall outside the visible area.
+   *                       See OCRConfig::incrementalContentPdf and
+   *                       OCRConfig::contentPreviewFromOpenDoc.
    * @param pairPdfPath    Optional path to the paired LAF PDF (e.g. when
    *                       processing L1, pass the L2 path and vice versa).
    *                       When set and @p renderContentRectPdf is true, both
@@ -442,6 +478,90 @@ public:
                                  bool renderContentRectPdf = false,
                                  const std::string &pairPdfPath = "");
 
+  /**
+   * @brief Callback interface for streaming PDF element extraction
+   *
+   * Override the callbacks you need; the defaults do nothing.  Elements are
+   * passed by const reference and are only valid for the duration of the
+   * call — copy anything you want to keep.
+   *
+   * Coordinates use the same PDF bottom-left, y-up space as
+   * extractTextFromPDF() and extractPDFElements().
+   */
+  struct PDFVisitor {
+    virtual ~PDFVisitor() = default;
+
+    /// Called before any element of a page is emitted.
+    virtual void onPageBegin(int /*pageNumber*/, double /*width*/,
+                             double /*height*/) {}
+
+    /// Called for each word; TextRegion::level holds the page number.
+    virtual void onWord(const TextRegion & /*word*/) {}
+
+    /// Called for each closed rectangular path.
+    virtual void onRect(const PDFRectangle & /*rect*/) {}
+
+    /// Called for each straight stroked segment.
+    virtual void onLine(const PDFLine & /*line*/) {}
+
+    /// Called for each embedded image (only if wantImages() returns true).
+    virtual void onImage(const PDFEmbeddedImage & /*image*/) {}
+
+    /// Called after every element of a page has been emitted.
+    virtual void onPageEnd(int /*pageNumber*/) {}
+
+    /// Return false to skip decoding image pixels entirely.
+    virtual bool wantImages() const { return true; }
+  };
+
+  /**
+   * @brief Result of a visitPDF() call
+   */
+  struct PDFVisitResult {
+    bool success = false;        ///< Whether the document was processed
+    std::string errorMessage;    ///< Error message if failed
+    int pageCount = 0;           ///< Number of pages visited
+    int wordCount = 0;           ///< Number of onWord() calls
+    int rectangleCount = 0;      ///< Number of onRect() calls
+    int lineCount = 0;           ///< Number of onLine() calls
+    int imageCount = 0;          ///< Number of onImage() calls
+    double processingTimeMs = 0; ///< Processing time in milliseconds
+  };
+
+  /**
+   * @brief Stream the text and vector elements of every page to a visitor
+   *
+   * Unlike extractTextFromPDF() and extractPDFElements(), nothing is
+   * collected into vectors: each page is interpreted once and rectangles,
+   * lines and images are handed to the visitor as the content stream draws
+   * them.  Words are emitted when the page finishes, since Poppler has to
+   * see every glyph on the page before it can assemble them into words.
+   * Memory use is therefore bounded by a single page regardless of the
+   * document length.
+   *
+   * Invisible (render mode 3) text is skipped, matching
+   * extractTextFromPDF().  No covered-text, crop-mark or DataMatrix
+   * analysis is performed.
+   *
+   * Example usage:
+   * @code
+   * struct Indexer : ocr::OCRAnalysis::PDFVisitor {
+   *     void onWord(const ocr::TextRegion &w) override { index.add(w); }
+   *     bool wantImages() const override { return false; }
+   * } indexer;
+   * auto r = analyzer.visitPDF("label.pdf", indexer);
+   * @endcode
+   *
+   * @param pdfPath Path to the PDF file
+   * @param visitor Receives the elements
+   * @param minRectSize Minimum rectangle size in points (default: 5)
+   * @param minLineLength Minimum line length in points (default: 5)
+   * @return PDFVisitResult with element counts
+   */
+  PDFVisitResult visitPDF(const std::string &pdfPath, PDFVisitor &visitor,
+                          double minRectSize = 5.0,
+                          double minLineLength = 5.0);
+
   /**
    * @brief Extract all embedded images from a PDF and save them as PNG files
    *
@@ -548,6 +668,7 @@ public:
     int imageWidth = 0;
     int imageHeight = 0;
     std::vector<RenderedElement> elements;
+    cv::Mat image; ///< Rendered page (BGR); only set when deferWrite is true
   };
 
   /**
@@ -572,6 +693,9 @@ public:
    * USE_CROP_MARKS)
    * @param markToFile Optional path to an image file to mark with element
    * bounding boxes (default: empty string = no marking)
+   * @param deferWrite If true, the rendered page is returned in
+   * PNGRenderResult::image instead of being written to outputPath, so a
+   * caller that draws on it pays for a single PNG encode (default: false)
    * @return PNGRenderResult containing success status, output path, and pixel
    * coordinates
    */
@@ -579,7 +703,7 @@ public:
       const PDFElements &elements, const std::string &pdfPath,
       double dpi = 300.0, const std::string &outputDir = "images",
       RenderBoundsMode boundsMode = RenderBoundsMode::USE_CROP_MARKS,
-      const std::string &markToFile = "");
+      const std::string &markToFile = "", bool deferWrite = false);
 
   /**
    * @brief Sort rendered elements by position (top to bottom, left to right)
@@ -654,6 +778,31 @@ public:
   static cv::Mat cleanupForOCR(const cv::Mat &image,
                                 CleanupDiagnostics *diag = nullptr);
 
+  /**
+   * @brief Scratch memory for cleanupForOCR, reusable across calls.
+   *
+   * Passing the same object to repeated calls avoids reallocating the
+   * working images when the ROI sizes repeat or shrink.
+   */
+  struct CleanupBuffers {
+    cv::Mat blurred;   ///< Blurred greyscale image (CV_8UC1)
+    cv::Mat ring;      ///< Three-row greyscale ring used by the blur
+    cv::Mat columnSum; ///< One row of vertical blur sums (CV_16UC1)
+  };
+
+  /**
+   * @brief cleanupForOCR writing into caller-provided memory
+   *
+   * Same result as the overload above.  @p output is (re)allocated only if
+   * its size or type differs, and the intermediate images live in
+   * @p buffers.  The work is done in two sweeps over the pixels: greyscale
+   * conversion, blur and the opaque-pixel histogram in the first, threshold
+   * and the forced-white fill in the second.
+   */
+  static void cleanupForOCR(const cv::Mat &image, cv::Mat &output,
+                            CleanupBuffers &buffers,
+                            CleanupDiagnostics *diag = nullptr);
+
   /**
    * @brief Crop an image to the label region by removing the surrounding dark
    * background and the grey backing paper.
@@ -670,6 +819,11 @@ public:
    *     or darker than the backing paper.  The union bounding rectangle of all
    *     significant deviant regions is used as the tight label crop.
    *
+   * Photos over about 2 MP are searched on a 1/2, 1/4 or 1/8 downscale; the
+   * resulting edges are then refined at full resolution within narrow bands
+   * around each edge, so the full-size image is only read near the crop
+   * boundary.
+   *
    * @param image       Input image (any channel count, CV_8U depth).
    * @param darkThresh  Intensity below which a pixel is considered dark
    *                    background (default 50).
@@ -686,6 +840,70 @@ public:
                              int  diffThresh  = 40,
                              bool tightLabel  = true);
 
+  /**
+   * @brief Like cropToLabel but returns the crop rectangle in @p image
+   * coordinates instead of a copy of the pixels.
+   * @param fullResolution  Skip the downscaled search and run it on the
+   *                        full image, as before the pyramid was added.
+   *                        Slower; used to check the pyramid result.
+   * @return Crop rectangle, or an empty rect if no region was found.
+   */
+  static cv::Rect cropToLabelRect(const cv::Mat &image,
+                                  int  darkThresh  = 50,
+                                  int  diffThresh  = 40,
+                                  bool tightLabel  = true,
+                                  bool fullResolution = false);
+
+  /**
+   * @brief Backing-paper crop and orientation of a label photo
+   *
+   * createRelativeMap, createAbsoluteMap and checkImage all work on the
+   * backing-paper crop of the photo turned clockwise by @c cwRotations
+   * quarter turns (the "working image").  In colour that image is only built
+   * for annotated output: otherwise rectangles in working-image coordinates
+   * are mapped back to the photo with toSource(), and upright() turns only
+   * the pixels of one region.
+   *
+   * Prepare a photo once with preparePhoto() and pass the same object to the
+   * map and check calls to avoid repeating the crop search.
+   */
+  struct PreparedPhoto {
+    cv::Rect crop;       ///< Backing-paper rectangle in the photo
+    int cwRotations = 0; ///< Clockwise 90° turns from photo to working image
+    cv::Mat grey;        ///< Optional upright greyscale working image
+
+    /// Working-image width (pixels)
+    int width() const { return (cwRotations & 1) ? crop.height : crop.width; }
+    /// Working-image height (pixels)
+    int height() const { return (cwRotations & 1) ? crop.width : crop.height; }
+
+    /// Rotation (0 or 1) whose working aspect ratio (width / height) is
+    /// closest to @p aspect.  Turning by 2 or 3 gives the same ratios.
+    int rotationForAspect(double aspect) const;
+
+    /// Map a rectangle in working-image coordinates to photo coordinates.
+    cv::Rect toSource(const cv::Rect &r) const;
+
+    /**
+     * @brief Pixels of the working-image rectangle @p r, upright
+     * @param source  The photo this object was prepared from
+     * @param scratch Receives the turned copy when cwRotations is non-zero;
+     *                otherwise a view into @p source is returned
+     */
+    cv::Mat upright(const cv::Mat &source, const cv::Rect &r,
+                    cv::Mat &scratch) const;
+
+    /// Fill @c grey with the whole working image of @p source.
+    void makeGrey(const cv::Mat &source);
+  };
+
+  /**
+   * @brief Locate the backing paper in @p image (cropToLabelRect with
+   *        tightLabel = false).  The whole image is used if none is found.
+   * @return Prepared photo with no rotation and no greyscale copy
+   */
+  static PreparedPhoto preparePhoto(const cv::Mat &image);
+
   /**
    * @brief Structure to hold element position and size in relative coordinates
    *
@@ -804,6 +1022,26 @@ public:
       const std::string &l1PdfPath,
       double dpi = 300.0, const std::string &l2PdfPath = "");
 
+  /// Overload that reuses a prepared @p photo of @p image.  The crop is
+  /// searched for only if @p photo has none; the chosen rotation and the
+  /// greyscale working image are stored back into @p photo.  Anchor OCR
+  /// runs on that greyscale image rather than on the colour crop.
+  RelativeMapResult createRelativeMap(
+      const PDFElements &elements, const cv::Mat &image, PreparedPhoto &photo,
+      const std::string &imageFilePath, bool markImage,
+      const std::string &l1PdfPath,
+      double dpi = 300.0, const std::string &l2PdfPath = "");
+
+  /// Outcome of checking one TEXT element of a map (see checkImage).
+  struct ElementCheckResult {
+    size_t index = 0;         ///< Index into the map's elements
+    std::string expected;     ///< Element text after placeholder substitution
+    std::string ocrText;      ///< Text read from the element's region
+    cv::Rect roi;             ///< Region checked, in working-image pixels
+    bool usedCleanup = false; ///< Matched only after cleanupForOCR
+    bool match = false;       ///< Whether the element passed
+  };
+
   /**
    * @brief Check image text against expected values from the relative map.
    *
@@ -814,13 +1052,15 @@ public:
    * compares the joined OCR text to the substituted expected text using
    * normalised fuzzy matching.
    *
-   * Elements where the text does not match have a red bounding box drawn
-   * directly onto @p image.
+   * On return @p image is replaced by the working image (the backing-paper
+   * crop, turned upright) with a green box drawn round each element that
+   * matched and a red box round each that did not.  This is a new buffer;
+   * the photo's pixels are not modified.
    *
    * @param relMap       Relative map produced by createRelativeMap for the same
    *                     label design.
-   * @param image        Photo of the physical label to validate; mismatching
-   *                     regions are annotated with red rectangles in-place.
+   * @param image        Photo of the physical label to validate; replaced by
+   *                     the annotated working image.
    * @param placeholders Ordered list of (token, value) pairs.  Every occurrence
    *                     of @p token in an element's text is replaced by @p value
    *                     before comparison (e.g. @c {"<MED>","ADALIMUMAB"}).
@@ -831,6 +1071,18 @@ public:
       const RelativeMapResult &relMap, cv::Mat &image,
       const std::vector<std::pair<std::string, std::string>> &placeholders);
 
+  /// Overload that reuses a prepared @p photo of @p image instead of
+  /// searching for the crop again.  The rotation is taken from @p relMap.
+  /// When @p results is non-null it receives one entry per element checked.
+  /// With @p annotate false, @p image is left as it is and the colour crop
+  /// is never turned; only the element regions are read.
+  bool checkImage(
+      const RelativeMapResult &relMap, cv::Mat &image,
+      const PreparedPhoto &photo,
+      const std::vector<std::pair<std::string, std::string>> &placeholders,
+      std::vector<ElementCheckResult> *results = nullptr,
+      bool annotate = true);
+
   /// Overload that uses the map stored by the last call to createRelativeMap.
   bool checkImage(
       cv::Mat &image,
@@ -851,6 +1103,14 @@ public:
       const std::string &l1PdfPath,
       double dpi = 300.0, const std::string &l2PdfPath = "");
 
+  /// Overload that reuses a prepared @p photo of @p image (see the
+  /// PreparedPhoto overload of createRelativeMap).
+  AbsoluteMapResult createAbsoluteMap(
+      const PDFElements &elements, const cv::Mat &image, PreparedPhoto &photo,
+      const std::string &imageFilePath, bool markImage,
+      const std::string &l1PdfPath,
+      double dpi = 300.0, const std::string &l2PdfPath = "");
+
   /// Check a photo against an absolute-coordinate map.
   /// Identical semantics to checkImage(RelativeMapResult, …) but uses stored
   /// pixel bounding boxes directly instead of projecting through a crop rect.
@@ -858,6 +1118,16 @@ public:
       const AbsoluteMapResult &absMap, cv::Mat &image,
       const std::vector<std::pair<std::string, std::string>> &placeholders);
 
+  /// Overload that reuses a prepared @p photo of @p image.  The rotation is
+  /// taken from @p absMap; @p results and @p annotate behave as for the
+  /// relative overload.
+  bool checkImage(
+      const AbsoluteMapResult &absMap, cv::Mat &image,
+      const PreparedPhoto &photo,
+      const std::vector<std::pair<std::string, std::string>> &placeholders,
+      std::vector<ElementCheckResult> *results = nullptr,
+      bool annotate = true);
+
   /**
    * @brief Align elements using OCR and create marked image with adjusted boxes
    *
@@ -945,12 +1215,49 @@ public:
    */
   void setConfig(const OCRConfig &config);
 
+  /**
+   * @brief Wait for all queued image files to be written
+   *
+   * With OCRConfig::imageWriterThreads > 0, the PNGs written by
+   * extractPDFElements(), writeAllImages() and renderElementsToPNG() are
+   * encoded in the background and may still be pending when those calls
+   * return.  Call this before reading them back.  The destructor also waits.
+   *
+   * @return Number of files that failed to write since the last call
+   */
+  size_t waitForImageWrites();
+
+  /**
+   * @brief Write an image through the analyser's image writer
+   *
+   * Honours OCRConfig::imageWriterThreads and OCRConfig::pngCompression.
+   * In background mode the Mat must not be modified after the call.
+   *
+   * @return true if written (inline mode) or queued (background mode)
+   */
+  bool writeImage(const std::string &path, const cv::Mat &image);
+
   /**
    * @brief Get the Tesseract version string
    * @return Tesseract version
    */
   static std::string getTesseractVersion();
 
+  /**
+   * @brief Get the OcrAnalysis library version string
+   * @return Project version the library was built from (e.g. "1.0.0")
+   */
+  static std::string getLibraryVersion();
+
+  /**
+   * @brief Revision of the detection code, independent of the version
+   *
+   * Bumped by every change that can alter what extractPDFElements() or the
+   * label-crop search find for the same input, so tools that cache results
+   * (pdfcheck -i) know to redo them between releases.
+   */
+  static int getDetectionRevision();
+
   /**
    * @brief Get available languages
    * @return Vector of available language codes
@@ -965,6 +1272,11 @@ private:
    */
   cv::Mat preprocessImage(const cv::Mat &image);
 
+  /// writeImage() for a Mat that is also handed back in a result: in
+  /// background mode a copy is queued, so the caller may draw on the
+  /// returned image before waitForImageWrites().
+  bool writeReturnedImage(const std::string &path, const cv::Mat &image);
+
   /**
    * @brief Convert OpenCV Mat to Tesseract-compatible format
    * @param image OpenCV Mat image
@@ -989,10 +1301,30 @@ private:
                        const std::vector<cv::Point> &contour,
                        const cv::Rect &boundingRect);
 
+  /**
+   * @brief Implementation of extractPDFElements()
+   * @param contentRectOnly If true, only the stages needed for the content
+   *        rect run (rectangles, lines, crop marks, page size); text,
+   *        embedded images, DataMatrix, vector-graphic detection and image
+   *        OCR are skipped.  Used for the paired PDF in content-rect export.
+   */
+  PDFElements extractPDFElementsImpl(const std::string &pdfPath,
+                                     double minRectSize, double minLineLength,
+                                     const std::string &imageOutputDir,
+                                     bool renderContentRectPdf,
+                                     const std::string &pairPdfPath,
+                                     bool contentRectOnly);
+
   std::unique_ptr<tesseract::TessBaseAPI>
       m_tesseract;    ///< Tesseract API instance
   OCRConfig m_config; ///< Current configuration
   bool m_initialized; ///< Initialization state
+  std::unique_ptr<ImageWriter> m_imageWriter; ///< Created by writeImage()
+  size_t m_imageWriteFailures = 0; ///< Failures already returned by wait
+  /// English engine for createRelativeMap / checkImage (see labelTesseract)
+  std::unique_ptr<tesseract::TessBaseAPI> m_labelTesseract;
+
+  tesseract::TessBaseAPI *labelTesseract();
 
   /// Stores the result of the most recent successful createRelativeMap call.
   static RelativeMapResult s_lastRelativeMap;
@@ -0,0 +1,133 @@
+#ifndef OCR_STAGE_PROFILE_HPP
+#define OCR_STAGE_PROFILE_HPP
+
+#include "Trace.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tesseract {
+class TessBaseAPI;
+}
+
+namespace ocr {
+
+/**
+ * @brief Wall-clock and CPU time spent in one named stage of a call
+ *
+ * CPU time is that of the calling thread only, so stages run concurrently
+ * on other threads do not inflate it, but work OpenCV hands to its worker
+ * threads (cv::parallel_for_) is not included either.
+ */
+struct StageTiming {
+  std::string name;  ///< e.g. "fonts"; "text/hiddenRaster" is inside "text"
+  double wallMs = 0; ///< Elapsed time
+  double cpuMs = 0;  ///< CPU time of the calling thread
+};
+
+/**
+ * @brief Per-stage timings and work counters attached to a result
+ *
+ * Stages are listed in the order they finished.  A stage whose name
+ * contains '/' ran inside the stage named by its prefix, so totals should
+ * only add up stages without one.
+ *
+ * The counters are kept per thread (see ProfileRecorder), so calls made
+ * from inside cv::parallel_for_ bodies or other helper threads are not
+ * counted.
+ */
+struct StageProfile {
+  std::vector<StageTiming> stages;
+  std::uint64_t displayPageCalls = 0; ///< Poppler page renders (displayPage,
+                                      ///< displayPageSlice, render_page)
+  std::uint64_t recognizeCalls = 0;   ///< Tesseract Recognize calls
+  std::uint64_t pixelsRendered = 0;   ///< Pixels rasterised by Poppler
+
+  /// Stage called @p name, or nullptr if it did not run.
+  const StageTiming *find(std::string_view name) const;
+
+  /// Add @p child's counters and append its stages as "<prefix>/<name>".
+  void merge(const StageProfile &child, std::string_view prefix);
+};
+
+/**
+ * @brief Fills a StageProfile for the duration of one library call
+ *
+ * The recorder makes itself current on the constructing thread (restoring
+ * the previous one on destruction), so nested calls record into their own
+ * result and the caller merges them.  Work done on other threads, such as
+ * the bodies of cv::parallel_for_, sees no recorder and is not counted.
+ * Stage scopes and counters are no-ops when no recorder is current, which
+ * keeps helpers usable outside a profiled call.
+ *
+ * @code
+ * ProfileRecorder recorder(result.profile);
+ * {
+ *   ProfileRecorder::Stage stage("fonts");
+ *   ...
+ * }
+ * ProfileRecorder::countDisplayPage(width * height);
+ * @endcode
+ */
+class ProfileRecorder {
+public:
+  explicit ProfileRecorder(StageProfile &profile);
+  ~ProfileRecorder();
+
+  ProfileRecorder(const ProfileRecorder &) = delete;
+  ProfileRecorder &operator=(const ProfileRecorder &) = delete;
+
+  /// Recorder of the calling thread, or nullptr.
+  static ProfileRecorder *current();
+
+  /// Count a Poppler page render (displayPage, displayPageSlice or
+  /// render_page) that rasterised @p pixels (0 for text and graphics output
+  /// devices).
+  static void countDisplayPage(std::uint64_t pixels = 0);
+
+  /// Count a Tesseract Recognize call.
+  static void countRecognize();
+
+  StageProfile &profile() { return m_profile; }
+
+  /// Times the enclosing scope (or until stop()) as a stage of the current
+  /// recorder, and as a "stage" trace span when tracing is on.
+  class Stage {
+  public:
+    explicit Stage(const char *name);
+    ~Stage() { stop(); }
+
+    Stage(const Stage &) = delete;
+    Stage &operator=(const Stage &) = delete;
+
+    void stop();
+
+  private:
+    ProfileRecorder *m_recorder;
+    const char *m_name;
+    TraceSpan m_span;
+    std::chrono::steady_clock::time_point m_wallStart;
+    double m_cpuStartMs = 0;
+  };
+
+private:
+  StageProfile &m_profile;
+  ProfileRecorder *m_previous;
+};
+
+/// CPU time consumed by the process so far (all threads), in milliseconds.
+double processCpuMs();
+
+/// CPU time consumed by the calling thread so far, in milliseconds.
+double threadCpuMs();
+
+/// @p api's Recognize, as a trace span and counted on the current
+/// recorder.  Returns Recognize's result.
+int timedRecognize(tesseract::TessBaseAPI &api);
+
+} // namespace ocr
+
+#endif // OCR_STAGE_PROFILE_HPP
@@ -0,0 +1,99 @@
+#ifndef OCR_TRACE_HPP
+#define OCR_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace ocr {
+
+/**
+ * @brief Opt-in span recorder that writes Chrome trace-event JSON
+ *
+ * While tracing is on, every TraceSpan appends one complete ("X") event to
+ * a buffer owned by the recording thread, so threads never contend with
+ * each other.  writeJson() gathers all buffers into a file that loads in
+ * chrome://tracing or https://ui.perfetto.dev.  Buffers only shrink when
+ * writeJson() drains them, so a process that runs indefinitely should not
+ * trace.  While tracing is off a span costs one relaxed atomic load.
+ *
+ * Example usage:
+ * @code
+ * ocr::Tracer::start();
+ * analyzer.extractPDFElements("label.pdf");
+ * ocr::Tracer::writeJson("label.trace.json");
+ * @endcode
+ */
+class Tracer {
+public:
+  /// Discard any recorded events and start recording.
+  static void start();
+
+  /// Stop recording; recorded events are kept for writeJson().
+  static void stop();
+
+  static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Write every recorded event to @p path and clear the buffers
+   * @return false if the file could not be written
+   */
+  static bool writeJson(const std::string &path);
+
+  /// Number of events recorded so far.
+  static size_t eventCount();
+
+private:
+  friend class TraceSpan;
+
+  static void record(const char *name, const char *category,
+                     std::string &&detail,
+                     std::chrono::steady_clock::time_point begin,
+                     std::chrono::steady_clock::time_point end);
+
+  static std::atomic<bool> s_enabled;
+};
+
+/**
+ * @brief Records the enclosing scope (or until end()) as one trace event
+ *
+ * @p name and @p category must outlive the trace (string literals);
+ * @p detail is copied and shown as the event's "detail" argument.
+ */
+class TraceSpan {
+public:
+  explicit TraceSpan(const char *name, const char *category = "ocr")
+      : m_name(Tracer::enabled() ? name : nullptr), m_category(category) {
+    if (m_name)
+      m_begin = std::chrono::steady_clock::now();
+  }
+
+  TraceSpan(const char *name, const char *category, const std::string &detail)
+      : TraceSpan(name, category) {
+    if (m_name)
+      m_detail = detail;
+  }
+
+  ~TraceSpan() { end(); }
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+  void end() {
+    if (!m_name)
+      return;
+    Tracer::record(m_name, m_category, std::move(m_detail), m_begin,
+                   std::chrono::steady_clock::now());
+    m_name = nullptr;
+  }
+
+private:
+  const char *m_name;
+  const char *m_category;
+  std::string m_detail;
+  std::chrono::steady_clock::time_point m_begin;
+};
+
+} // namespace ocr
+
+#endif // OCR_TRACE_HPP
@@ -0,0 +1,260 @@
+#include "ElementStore.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace ocr {
+
+// ─────────────────────────────────────────────────────────────────────────────
+// FontTable
+// ─────────────────────────────────────────────────────────────────────────────
+
+FontTable::FontTable() {
+  m_names.emplace_back(); // id 0 = empty name
+  m_ids.emplace(std::string(), FontId(0));
+}
+
+FontId FontTable::intern(std::string_view name) {
+  if (name.empty())
+    return 0;
+
+  std::string key(name);
+  auto it = m_ids.find(key);
+  if (it != m_ids.end())
+    return it->second;
+
+  // Font names come from a small set per document; running out of ids means
+  // something upstream is feeding garbage, so fold the overflow into "no font"
+  // rather than wrapping onto an unrelated name.
+  if (m_names.size() > std::numeric_limits<FontId>::max())
+    return 0;
+
+  FontId id = static_cast<FontId>(m_names.size());
+  m_names.push_back(key);
+  m_ids.emplace(std::move(key), id);
+  return id;
+}
+
+std::string_view FontTable::name(FontId id) const {
+  if (id >= m_names.size())
+    return {};
+  return m_names[id];
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// TextRegionView
+// ─────────────────────────────────────────────────────────────────────────────
+
+TextRegion TextRegionView::toTextRegion() const {
+  TextRegion r;
+  r.boundingBox = boundingBox;
+  r.text = std::string(text);
+  r.confidence = confidence;
+  r.level = level;
+  r.orientation = orientation;
+  r.preciseX = preciseX;
+  r.preciseY = preciseY;
+  r.preciseWidth = preciseWidth;
+  r.preciseHeight = preciseHeight;
+  r.fontName = std::string(fontName);
+  r.fontSize = fontSize;
+  r.isBold = isBold;
+  r.isItalic = isItalic;
+  return r;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// TextRegionStore
+// ─────────────────────────────────────────────────────────────────────────────
+
+TextRegionStore
+TextRegionStore::fromRegions(const std::vector<TextRegion> &regions) {
+  TextRegionStore store;
+  store.append(regions);
+  return store;
+}
+
+void TextRegionStore::reserve(size_t count, size_t textBytes) {
+  m_x.reserve(count);
+  m_y.reserve(count);
+  m_width.reserve(count);
+  m_height.reserve(count);
+  m_boxX.reserve(count);
+  m_boxY.reserve(count);
+  m_boxW.reserve(count);
+  m_boxH.reserve(count);
+  m_confidence.reserve(count);
+  m_fontSize.reserve(count);
+  m_level.reserve(count);
+  m_orientation.reserve(count);
+  m_flags.reserve(count);
+  m_fontId.reserve(count);
+  m_textOffset.reserve(count);
+  m_textLength.reserve(count);
+  if (textBytes > 0)
+    m_arena.reserve(textBytes);
+}
+
+void TextRegionStore::clear() {
+  m_x.clear();
+  m_y.clear();
+  m_width.clear();
+  m_height.clear();
+  m_boxX.clear();
+  m_boxY.clear();
+  m_boxW.clear();
+  m_boxH.clear();
+  m_confidence.clear();
+  m_fontSize.clear();
+  m_level.clear();
+  m_orientation.clear();
+  m_flags.clear();
+  m_fontId.clear();
+  m_textOffset.clear();
+  m_textLength.clear();
+  m_arena.clear();
+}
+
+void TextRegionStore::push_back(const TextRegion &region) {
+  m_x.push_back(region.preciseX);
+  m_y.push_back(region.preciseY);
+  m_width.push_back(region.preciseWidth);
+  m_height.push_back(region.preciseHeight);
+  m_boxX.push_back(region.boundingBox.x);
+  m_boxY.push_back(region.boundingBox.y);
+  m_boxW.push_back(region.boundingBox.width);
+  m_boxH.push_back(region.boundingBox.height);
+  m_confidence.push_back(region.confidence);
+  m_fontSize.push_back(region.fontSize);
+  m_level.push_back(region.level);
+  m_orientation.push_back(static_cast<std::uint8_t>(region.orientation));
+  m_flags.push_back(static_cast<std::uint8_t>((region.isBold ? kBold : 0) |
+                                              (region.isItalic ? kItalic : 0)));
+  m_fontId.push_back(m_fonts.intern(region.fontName));
+  m_textOffset.push_back(static_cast<uint32_t>(m_arena.size()));
+  m_textLength.push_back(static_cast<uint32_t>(region.text.size()));
+  m_arena.append(region.text);
+}
+
+void TextRegionStore::append(const std::vector<TextRegion> &regions) {
+  size_t textBytes = m_arena.size();
+  for (const auto &r : regions)
+    textBytes += r.text.size();
+  reserve(size() + regions.size(), textBytes);
+  for (const auto &r : regions)
+    push_back(r);
+}
+
+TextRegionView TextRegionStore::operator[](size_t i) const {
+  TextRegionView v;
+  v.text = text(i);
+  v.fontName = fontName(i);
+  v.boundingBox = cv::Rect(m_boxX[i], m_boxY[i], m_boxW[i], m_boxH[i]);
+  v.confidence = m_confidence[i];
+  v.level = m_level[i];
+  v.orientation = static_cast<TextOrientation>(m_orientation[i]);
+  v.preciseX = m_x[i];
+  v.preciseY = m_y[i];
+  v.preciseWidth = m_width[i];
+  v.preciseHeight = m_height[i];
+  v.fontSize = m_fontSize[i];
+  v.isBold = isBold(i);
+  v.isItalic = isItalic(i);
+  return v;
+}
+
+std::vector<TextRegion> TextRegionStore::toRegions() const {
+  std::vector<TextRegion> out;
+  out.reserve(size());
+  for (size_t i = 0; i < size(); ++i)
+    out.push_back(toTextRegion(i));
+  return out;
+}
+
+bool TextRegionStore::bounds(double &minX, double &minY, double &maxX,
+                             double &maxY) const {
+  if (empty())
+    return false;
+
+  double loX = std::numeric_limits<double>::max();
+  double loY = std::numeric_limits<double>::max();
+  double hiX = std::numeric_limits<double>::lowest();
+  double hiY = std::numeric_limits<double>::lowest();
+
+  const size_t n = size();
+  for (size_t i = 0; i < n; ++i) {
+    bool precise = m_width[i] > 0;
+    double x = precise ? m_x[i] : m_boxX[i];
+    double y = precise ? m_y[i] : m_boxY[i];
+    double w = precise ? m_width[i] : m_boxW[i];
+    double h = precise ? m_height[i] : m_boxH[i];
+    loX = std::min(loX, x);
+    loY = std::min(loY, y);
+    hiX = std::max(hiX, x + w);
+    hiY = std::max(hiY, y + h);
+  }
+
+  minX = loX;
+  minY = loY;
+  maxX = hiX;
+  maxY = hiY;
+  return true;
+}
+
+std::vector<uint32_t> TextRegionStore::indicesInBounds(double minX, double minY,
+                                                       double maxX,
+                                                       double maxY) const {
+  std::vector<uint32_t> out;
+  const size_t n = size();
+  for (size_t i = 0; i < n; ++i) {
+    double cx = m_x[i] + m_width[i] / 2.0;
+    double cy = m_y[i] + m_height[i] / 2.0;
+    if (cx >= minX && cx <= maxX && cy >= minY && cy <= maxY)
+      out.push_back(static_cast<uint32_t>(i));
+  }
+  return out;
+}
+
+std::vector<uint32_t> TextRegionStore::sortedByPosition(double yTolerance) const {
+  std::vector<uint32_t> order(size());
+  std::iota(order.begin(), order.end(), 0u);
+
+  std::stable_sort(order.begin(), order.end(),
+                   [&](uint32_t a, uint32_t b) { return m_y[a] < m_y[b]; });
+
+  // Walk the Y-sorted list, cutting a new line whenever the next region is
+  // further than yTolerance below the first region of the current line, and
+  // order each line left to right.
+  size_t lineStart = 0;
+  for (size_t i = 1; i <= order.size(); ++i) {
+    if (i == order.size() ||
+        m_y[order[i]] - m_y[order[lineStart]] > yTolerance) {
+      std::stable_sort(order.begin() + lineStart, order.begin() + i,
+                       [&](uint32_t a, uint32_t b) { return m_x[a] < m_x[b]; });
+      lineStart = i;
+    }
+  }
+  return order;
+}
+
+size_t TextRegionStore::memoryBytes() const {
+  size_t bytes = 0;
+  bytes += (m_x.capacity() + m_y.capacity() + m_width.capacity() +
+            m_height.capacity() + m_fontSize.capacity()) *
+           sizeof(double);
+  bytes += (m_boxX.capacity() + m_boxY.capacity() + m_boxW.capacity() +
+            m_boxH.capacity()) *
+           sizeof(int32_t);
+  bytes += m_confidence.capacity() * sizeof(float);
+  bytes += m_level.capacity() * sizeof(int32_t);
+  bytes += m_orientation.capacity() + m_flags.capacity();
+  bytes += m_fontId.capacity() * sizeof(FontId);
+  bytes += (m_textOffset.capacity() + m_textLength.capacity()) * sizeof(uint32_t);
+  bytes += m_arena.capacity();
+  for (size_t id = 0; id < m_fonts.size(); ++id)
+    bytes += m_fonts.name(static_cast<FontId>(id)).size();
+  return bytes;
+}
+
+} // namespace ocr
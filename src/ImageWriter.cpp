@@ -0,0 +1,133 @@
+#include "ImageWriter.hpp"
+#include "Log.hpp"
+
+#include <opencv2/imgcodecs.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+namespace ocr {
+
+namespace {
+
+bool hasPngExtension(const std::string &path) {
+  if (path.size() < 4)
+    return false;
+  std::string ext = path.substr(path.size() - 4);
+  std::transform(ext.begin(), ext.end(), ext.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return ext == ".png";
+}
+
+/// True if the (key, value) list @p params already contains @p key.
+bool hasParam(const std::vector<int> &params, int key) {
+  for (size_t i = 0; i + 1 < params.size(); i += 2)
+    if (params[i] == key)
+      return true;
+  return false;
+}
+
+} // namespace
+
+ImageWriter::ImageWriter(int threads, size_t maxQueued, int pngCompression)
+    : m_maxQueued(std::max<size_t>(maxQueued, 1)),
+      m_pngCompression(pngCompression < 0 ? -1
+                                          : std::min(pngCompression, 9)) {
+  for (int i = 0; i < threads; ++i)
+    m_workers.emplace_back(&ImageWriter::workerLoop, this);
+}
+
+ImageWriter::~ImageWriter() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_notEmpty.notify_all();
+  for (auto &t : m_workers)
+    t.join();
+}
+
+std::future<bool> ImageWriter::write(const std::string &path,
+                                     const cv::Mat &image,
+                                     std::vector<int> params) {
+  Job job;
+  job.path = path;
+  job.params = std::move(params);
+  if (m_pngCompression >= 0 && hasPngExtension(path) &&
+      !hasParam(job.params, cv::IMWRITE_PNG_COMPRESSION)) {
+    job.params.push_back(cv::IMWRITE_PNG_COMPRESSION);
+    job.params.push_back(m_pngCompression);
+  }
+  std::future<bool> done = job.done.get_future();
+
+  if (m_workers.empty()) {
+    job.image = image;
+    job.done.set_value(run(job));
+    return done;
+  }
+
+  // A Mat over someone else's buffer (no allocator-owned data) may be freed
+  // or reused as soon as we return, so take a copy of the pixels.
+  job.image = image.u ? image : image.clone();
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notFull.wait(lock, [&] { return m_queue.size() < m_maxQueued; });
+    m_queue.push_back(std::move(job));
+  }
+  m_notEmpty.notify_one();
+  return done;
+}
+
+void ImageWriter::wait() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_idle.wait(lock, [&] { return m_queue.empty() && m_active == 0; });
+}
+
+void ImageWriter::workerLoop() {
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_notEmpty.wait(lock, [&] { return m_stopping || !m_queue.empty(); });
+      // Drain the queue before honouring a stop request.
+      if (m_queue.empty())
+        return;
+      job = std::move(m_queue.front());
+      m_queue.pop_front();
+      ++m_active;
+    }
+    m_notFull.notify_one();
+
+    job.done.set_value(run(job));
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      --m_active;
+    }
+    m_idle.notify_all();
+  }
+}
+
+bool ImageWriter::run(Job &job) {
+  bool ok = false;
+  try {
+    ok = !job.image.empty() && cv::imwrite(job.path, job.image, job.params);
+  } catch (const std::exception &e) {
+    // cv::Exception, but also bad_alloc or a filesystem error: an exception
+    // escaping a worker thread would terminate the process.
+    OCR_ERROR << "Failed to encode " << job.path << ": " << e.what();
+  }
+  if (ok) {
+    ++m_written;
+  } else {
+    ++m_failed;
+    OCR_ERROR << "Failed to write image: " << job.path;
+  }
+  // Release the pixels now rather than when the job is overwritten.
+  job.image.release();
+  return ok;
+}
+
+} // namespace ocr
@@ -0,0 +1,97 @@
+#include "Log.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+namespace ocr {
+
+namespace {
+
+int initialLevel() {
+  const char *env = std::getenv("OCR_LOG_LEVEL");
+  if (!env)
+    return static_cast<int>(LogLevel::Info);
+  std::string name(env);
+  for (auto &c : name)
+    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  for (int l = 0; l <= static_cast<int>(LogLevel::Off); ++l)
+    if (name == Log::levelName(static_cast<LogLevel>(l)))
+      return l;
+  return static_cast<int>(LogLevel::Info);
+}
+
+std::mutex g_sinkMutex;
+Log::Sink g_sink;
+thread_local Log::Sink t_threadSink;
+
+} // namespace
+
+std::atomic<int> Log::s_level{initialLevel()};
+
+// static
+void Log::setLevel(LogLevel level) {
+  s_level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+// static
+LogLevel Log::level() {
+  return static_cast<LogLevel>(s_level.load(std::memory_order_relaxed));
+}
+
+// static
+void Log::setSink(Sink sink) {
+  std::lock_guard<std::mutex> lock(g_sinkMutex);
+  g_sink = std::move(sink);
+}
+
+// static
+void Log::setThreadSink(Sink sink) { t_threadSink = std::move(sink); }
+
+// static
+std::string Log::formatLine(LogLevel level, std::string_view message) {
+  static const char *const kPrefix[] = {"DEBUG: ", "", "WARNING: ", "ERROR: "};
+  std::string line = kPrefix[std::min(static_cast<int>(level), 3)];
+  line += message;
+  line += '\n';
+  return line;
+}
+
+// static
+void Log::write(LogLevel level, std::string_view message) {
+  if (t_threadSink) {
+    t_threadSink(level, message); // only this thread uses it; no lock
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(g_sinkMutex);
+  if (g_sink) {
+    g_sink(level, message);
+    return;
+  }
+
+  // Default sink: the whole line goes to std::cerr in one write.
+  std::string line = formatLine(level, message);
+  std::cerr.write(line.data(), static_cast<std::streamsize>(line.size()));
+}
+
+// static
+const char *Log::levelName(LogLevel level) {
+  switch (level) {
+  case LogLevel::Debug:
+    return "debug";
+  case LogLevel::Info:
+    return "info";
+  case LogLevel::Warning:
+    return "warning";
+  case LogLevel::Error:
+    return "error";
+  default:
+    return "off";
+  }
+}
+
+} // namespace ocr
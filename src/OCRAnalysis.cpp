@@ -1,14 +1,27 @@
 ﻿#include "OCRAnalysis.hpp"
+#include "ImageWriter.hpp"
+#include "Log.hpp"
+#include "Trace.hpp"
 
 #include <chrono>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
 #include <set>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
 
 // Cairo for PDF/PNG rendering (if available)
 #ifdef HAVE_CAIRO
@@ -55,6 +68,287 @@
 
 namespace ocr {
 
+namespace {
+
+/// Poppler error callback (installed by every GlobalParamsIniter below).
+/// Reporting through Log rather than straight to stderr lets a per-thread
+/// sink (Log::setThreadSink) collect Poppler's messages with the library's.
+void popplerErrorToLog(ErrorCategory, Goffset pos, const char *msg) {
+  if (pos >= 0)
+    OCR_WARN << "Poppler (" << pos << "): " << msg;
+  else
+    OCR_WARN << "Poppler: " << msg;
+}
+
+/// PDFDoc::displayPage at @p dpi, as a trace span and counted on the
+/// current ProfileRecorder.
+void timedDisplayPage(PDFDoc &doc, OutputDev *out, int page, double dpi,
+                      int rotate, bool useMediaBox, bool crop, bool printing) {
+  {
+    TraceSpan span("PDFDoc::displayPage", "poppler");
+    doc.displayPage(out, page, dpi, dpi, rotate, useMediaBox, crop, printing);
+  }
+  ProfileRecorder::countDisplayPage();
+}
+
+/// PDFDoc::displayPageSlice at @p dpi, as a trace span and counted with the
+/// slice's pixels on the current ProfileRecorder.
+void timedDisplayPageSlice(PDFDoc &doc, OutputDev *out, int page, double dpi,
+                           int rotate, bool useMediaBox, bool crop,
+                           bool printing, int sliceX, int sliceY, int sliceW,
+                           int sliceH) {
+  {
+    TraceSpan span("PDFDoc::displayPageSlice", "poppler");
+    doc.displayPageSlice(out, page, dpi, dpi, rotate, useMediaBox, crop,
+                         printing, sliceX, sliceY, sliceW, sliceH);
+  }
+  ProfileRecorder::countDisplayPage(static_cast<std::uint64_t>(sliceW) *
+                                    sliceH);
+}
+
+/// poppler-cpp page_renderer::render_page at @p dpi, as a trace span and
+/// counted with the image's pixels on the current ProfileRecorder.
+poppler::image timedRenderPage(const poppler::page_renderer &renderer,
+                               const poppler::page *page, double dpi) {
+  poppler::image img;
+  {
+    TraceSpan span("page_renderer::render_page", "poppler");
+    img = renderer.render_page(page, dpi, dpi);
+  }
+  ProfileRecorder::countDisplayPage(
+      img.is_valid() ? static_cast<std::uint64_t>(img.width()) * img.height()
+                     : 0);
+  return img;
+}
+
+/// Initial block size for the per-call scratch arenas used by the PDF
+/// extraction functions.  Transient containers (word text buffers, lookup
+/// sets, line/crop-mark working lists) are carved out of a
+/// std::pmr::monotonic_buffer_resource and released in one shot when the call
+/// returns, so concurrent extractions do not contend on the global heap for
+/// thousands of short-lived allocations.  A typical label page fits in the
+/// first block; larger pages grow geometrically from the default resource.
+constexpr size_t kScratchArenaBytes = 64 * 1024;
+
+/// Append the UTF-8 encoding of a Poppler TextWord to @p out.
+void appendWordUtf8(const TextWord *word, std::string &out) {
+  for (int ci = 0; ci < word->getLength(); ci++) {
+    const Unicode *uns = word->getChar(ci);
+    if (!uns)
+      continue;
+    Unicode u = *uns;
+    if (u < 0x80) {
+      out += static_cast<char>(u);
+    } else if (u < 0x800) {
+      out += static_cast<char>(0xC0 | (u >> 6));
+      out += static_cast<char>(0x80 | (u & 0x3F));
+    } else {
+      out += static_cast<char>(0xE0 | (u >> 12));
+      out += static_cast<char>(0x80 | ((u >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (u & 0x3F));
+    }
+  }
+}
+
+/// Fill the geometry, font and orientation fields of @p region from a
+/// Poppler TextWord.  @p dispH is the displayed page height used to flip the
+/// TextOutputDev screen-Y-down box into PDF bottom-left, y-up coordinates.
+/// The text itself is left to the caller.
+void fillWordRegion(const TextWord *word, double dispH, TextRegion &region) {
+  // getBBox() returns coordinates in screen-Y-down space:
+  //   xMin/xMax = left/right (same as PDF x)
+  //   yMin = TOP of word  (screen-Y, 0=top of display)
+  //   yMax = BOTTOM of word (screen-Y, larger = lower on page)
+  // Convert to PDF y-up (bottom-left origin, y-up from bottom of
+  // display) using the display height (dispH):
+  //   pdf_y_bottom = dispH - yMax   ← bottom edge (y-up)
+  //   pdf_y_top    = dispH - yMin   ← top edge (y-up)
+  double xMin, yMinScr, xMax, yMaxScr;
+  word->getBBox(&xMin, &yMinScr, &xMax, &yMaxScr);
+  double pdf_y_bottom = dispH - yMaxScr; // PDF y-up bottom edge
+  double pdf_y_top = dispH - yMinScr;    // PDF y-up top edge
+  double width = xMax - xMin;
+  double height = pdf_y_top - pdf_y_bottom;
+
+  // Store bottom-left y-up coordinate (PDF bottom-left origin,
+  // same space as images and line-extraction crop marks).
+  region.boundingBox = cv::Rect(
+      static_cast<int>(xMin), static_cast<int>(pdf_y_bottom),
+      static_cast<int>(width), static_cast<int>(height + 0.5));
+  region.preciseX = xMin;
+  region.preciseY = pdf_y_bottom; // PDF bottom-left y (bottom edge)
+  region.preciseWidth = width;
+  region.preciseHeight = height;
+  region.fontSize = height; // approximation
+
+  // Font info
+  region.fontName.clear();
+  region.isBold = false;
+  region.isItalic = false;
+  const TextFontInfo *fi = word->getFontInfo(0);
+  if (fi) {
+    const GooString *fn = fi->getFontName();
+    if (fn) {
+      region.fontName = fn->toStr();
+      auto plusPos = region.fontName.find('+');
+      if (plusPos != std::string::npos)
+        region.fontName.erase(0, plusPos + 1);
+    }
+    region.isBold = fi->isBold();
+    region.isItalic = fi->isItalic();
+  }
+
+  // Orientation from TextWord rotation (0=0°,1=90°,2=180°,3=270°)
+  int rot = word->getRotation();
+  if (rot == 1 || rot == 3)
+    region.orientation = TextOrientation::Vertical;
+  else
+    region.orientation = TextOrientation::Horizontal;
+}
+
+// ---------------------------------------------------------------------------
+// Zero-copy views between renderer output and cv::Mat.
+//
+// The views below alias the renderer's own buffer: they are only valid while
+// that buffer is alive and must be clone()d (or converted into a new Mat) if
+// the pixels have to outlive it.
+// ---------------------------------------------------------------------------
+
+/// View a SplashBitmap as a cv::Mat.  Rendering with splashModeBGR8 gives a
+/// buffer that is already in OpenCV channel order.
+cv::Mat splashBitmapView(SplashBitmap *bmp) {
+  if (!bmp)
+    return cv::Mat();
+  int type;
+  switch (bmp->getMode()) {
+  case splashModeMono8:
+    type = CV_8UC1;
+    break;
+  case splashModeRGB8:
+  case splashModeBGR8:
+    type = CV_8UC3;
+    break;
+  case splashModeXBGR8:
+    type = CV_8UC4;
+    break;
+  default:
+    return cv::Mat();
+  }
+  return cv::Mat(bmp->getHeight(), bmp->getWidth(), type, bmp->getDataPtr(),
+                 bmp->getRowSize());
+}
+
+/// View a poppler::image as a cv::Mat.  format_argb32 is stored as B,G,R,A
+/// bytes on little-endian hosts, i.e. a CV_8UC4 BGRA image.
+cv::Mat popplerImageView(const poppler::image &img) {
+  if (!img.is_valid())
+    return cv::Mat();
+  int type;
+  switch (img.format()) {
+  case poppler::image::format_argb32:
+    type = CV_8UC4;
+    break;
+  case poppler::image::format_rgb24:
+  case poppler::image::format_bgr24:
+    type = CV_8UC3;
+    break;
+  case poppler::image::format_gray8:
+    type = CV_8UC1;
+    break;
+  default:
+    return cv::Mat();
+  }
+  return cv::Mat(img.height(), img.width(), type,
+                 const_cast<char *>(img.const_data()), img.bytes_per_row());
+}
+
+#ifdef HAVE_CAIRO
+/// Create a Cairo image surface over the pixels of a CV_8UC4 Mat (BGRA
+/// byte order, which is Cairo's ARGB32/RGB24 layout on little-endian hosts).
+/// The Mat must outlive the surface.  Returns nullptr if the Mat's row
+/// stride is not one Cairo accepts.
+cairo_surface_t *cairoSurfaceForMat(cv::Mat &bgra, cairo_format_t format) {
+  if (bgra.empty() || bgra.type() != CV_8UC4)
+    return nullptr;
+  int stride = cairo_format_stride_for_width(format, bgra.cols);
+  if (stride != static_cast<int>(bgra.step))
+    return nullptr;
+  return cairo_image_surface_create_for_data(bgra.data, format, bgra.cols,
+                                             bgra.rows, stride);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Banded page rendering.
+//
+// Consumers that only inspect a window of rows at a time render the page as
+// a sequence of horizontal bands instead of one full-page bitmap, so peak
+// memory is bounded by OCRConfig::rasterMemoryBudget rather than by the
+// artwork size.
+// ---------------------------------------------------------------------------
+
+/// Pixel size of the bitmap displayPage() would allocate for @p pageNum at
+/// @p dpi (crop box, page rotation applied, same rounding as Splash).
+void renderedPageSize(PDFDoc *doc, int pageNum, double dpi, int &width,
+                      int &height) {
+  double w = doc->getPageCropWidth(pageNum) * dpi / 72.0;
+  double h = doc->getPageCropHeight(pageNum) * dpi / 72.0;
+  int rotate = doc->getPageRotate(pageNum);
+  if (rotate == 90 || rotate == 270)
+    std::swap(w, h);
+  width = static_cast<int>(w + 0.5);
+  height = static_cast<int>(h + 0.5);
+}
+
+/// Render @p pageNum in full-width horizontal BGR8 bands of at most
+/// @p budgetBytes each (0 = a single band) and call @p fn with each band and
+/// the page row of its first line.  Consecutive bands share @p overlapPx
+/// rows so that anything up to that tall is wholly inside at least one band.
+/// The band Mat aliases the renderer's bitmap and is only valid during the
+/// call; @p fn may draw on it, since every band is rendered afresh.  @p fn
+/// returns false to stop early.  Returns false if nothing could be rendered.
+bool forEachPageBand(PDFDoc *doc, int pageNum, double dpi, size_t budgetBytes,
+                     int overlapPx, bool antialias,
+                     const std::function<bool(cv::Mat &, int)> &fn) {
+  int pageW = 0, pageH = 0;
+  renderedPageSize(doc, pageNum, dpi, pageW, pageH);
+  if (pageW <= 0 || pageH <= 0)
+    return false;
+
+  overlapPx = std::max(0, overlapPx);
+  int bandH = pageH;
+  if (budgetBytes > 0) {
+    size_t rows = budgetBytes / (static_cast<size_t>(pageW) * 3);
+    bandH = static_cast<int>(
+        std::min<size_t>(static_cast<size_t>(pageH), std::max<size_t>(rows, 1)));
+  }
+  // Every band must advance past the overlap, whatever the budget says.
+  bandH = std::max(bandH, std::min(pageH, 2 * overlapPx + 1));
+
+  SplashColor white = {255, 255, 255};
+  SplashOutputDev splashOut(splashModeBGR8, 4, false, white);
+  if (antialias) {
+    splashOut.setFontAntialias(true);
+    splashOut.setVectorAntialias(true);
+  }
+  splashOut.startDoc(doc);
+
+  for (int top = 0;;) {
+    int h = std::min(bandH, pageH - top);
+    timedDisplayPageSlice(*doc, &splashOut, pageNum, dpi, 0, false, true,
+                          false, 0, top, pageW, h);
+    cv::Mat band = splashBitmapView(splashOut.getBitmap());
+    if (band.empty())
+      return top > 0;
+    if (!fn(band, top) || top + h >= pageH)
+      break;
+    top += h - overlapPx;
+  }
+  return true;
+}
+
+} // namespace
+
 OCRAnalysis::OCRAnalysis()
     : m_tesseract(std::make_unique<tesseract::TessBaseAPI>()), m_config(),
       m_initialized(false) {}
@@ -67,11 +361,18 @@ OCRAnalysis::~OCRAnalysis() {
   if (m_tesseract) {
     m_tesseract->End();
   }
+  if (m_labelTesseract) {
+    m_labelTesseract->End();
+  }
+  // m_imageWriter's destructor finishes any queued writes.
 }
 
 OCRAnalysis::OCRAnalysis(OCRAnalysis &&other) noexcept
     : m_tesseract(std::move(other.m_tesseract)),
-      m_config(std::move(other.m_config)), m_initialized(other.m_initialized) {
+      m_config(std::move(other.m_config)), m_initialized(other.m_initialized),
+      m_imageWriter(std::move(other.m_imageWriter)),
+      m_imageWriteFailures(other.m_imageWriteFailures),
+      m_labelTesseract(std::move(other.m_labelTesseract)) {
   other.m_initialized = false;
 }
 
@@ -84,6 +385,12 @@ OCRAnalysis &OCRAnalysis::operator=(OCRAnalysis &&other) noexcept {
     m_config = std::move(other.m_config);
     m_initialized = other.m_initialized;
     other.m_initialized = false;
+    m_imageWriter = std::move(other.m_imageWriter);
+    m_imageWriteFailures = other.m_imageWriteFailures;
+    if (m_labelTesseract) {
+      m_labelTesseract->End();
+    }
+    m_labelTesseract = std::move(other.m_labelTesseract);
   }
   return *this;
 }
@@ -107,16 +414,15 @@ bool OCRAnalysis::initialize() {
     } else {
       // Priority 3: Use default path
       tessDataPath = "c:\\tessdata\\tessdata";
-      std::cerr << "TESSDATA_PREFIX not set, using default: " << tessDataPath
-                << std::endl;
+      OCR_INFO << "TESSDATA_PREFIX not set, using default: " << tessDataPath;
     }
   }
 
   int result = m_tesseract->Init(tessDataPath, m_config.language.c_str());
 
   if (result != 0) {
-    std::cerr << "Failed to initialize Tesseract with language: "
-              << m_config.language << std::endl;
+    OCR_ERROR << "Failed to initialize Tesseract with language: "
+              << m_config.language;
     return false;
   }
 
@@ -142,6 +448,7 @@ OCRResult OCRAnalysis::analyzeImage(const std::string &imagePath) {
 }
 
 OCRResult OCRAnalysis::analyzeImage(const cv::Mat &image) {
+  TraceSpan span("analyzeImage");
   OCRResult result;
   result.success = false;
 
@@ -157,6 +464,7 @@ OCRResult OCRAnalysis::analyzeImage(const cv::Mat &image) {
   }
 
   auto startTime = std::chrono::high_resolution_clock::now();
+  ProfileRecorder recorder(result.profile);
 
   try {
     // Preprocess image if configured
@@ -164,7 +472,9 @@ OCRResult OCRAnalysis::analyzeImage(const cv::Mat &image) {
         m_config.preprocessImage ? preprocessImage(image) : image;
 
     // Find the best rotation for the image
+    ProfileRecorder::Stage rotationStage("rotation");
     int bestRotation = findBestRotation(processedImage);
+    rotationStage.stop();
 
     // Apply the best rotation
     cv::Mat orientedImage;
@@ -175,8 +485,9 @@ OCRResult OCRAnalysis::analyzeImage(const cv::Mat &image) {
     }
 
     // Set the correctly oriented image for Tesseract
+    ProfileRecorder::Stage recognizeStage("recognize");
     setImage(orientedImage);
-    m_tesseract->Recognize(nullptr);
+    timedRecognize(*m_tesseract);
 
     // Get the recognized text from the correctly oriented image
     char *outText = m_tesseract->GetUTF8Text();
@@ -185,8 +496,12 @@ OCRResult OCRAnalysis::analyzeImage(const cv::Mat &image) {
       delete[] outText;
     }
 
+    recognizeStage.stop();
+
     // Get detailed text regions (this will also detect orientation internally)
+    ProfileRecorder::Stage regionsStage("regions");
     result.regions = detectTextRegions(processedImage);
+    regionsStage.stop();
 
     // Filter regions by confidence if configured
     if (m_config.minConfidence > 0) {
@@ -212,17 +527,19 @@ OCRResult OCRAnalysis::analyzeImage(const cv::Mat &image) {
 
 OCRResult OCRAnalysis::extractTextFromPDF(const std::string &pdfPath,
                                           PDFExtractionLevel level) {
+  TraceSpan span("extractTextFromPDF", "ocr", pdfPath);
   OCRResult result;
   result.success = false;
 
   auto startTime = std::chrono::high_resolution_clock::now();
+  ProfileRecorder recorder(result.profile);
 
   try {
     // Use TextOutputDev via displayPage so coordinates are in the same
     // rendered/rotated space as LineExtractorOutputDev.  This ensures
     // text bounding boxes share the same PDF bottom-left origin as the
     // crop-mark and image data later used by renderElementsToPNG.
-    GlobalParamsIniter gpi(nullptr);
+    GlobalParamsIniter gpi(popplerErrorToLog);
     auto gooFile = std::make_unique<GooString>(pdfPath);
     std::unique_ptr<PDFDoc> doc(new PDFDoc(std::move(gooFile)));
 
@@ -264,13 +581,18 @@ OCRResult OCRAnalysis::extractTextFromPDF(const std::string &pdfPath,
     };
 
     // Run TextOutputDev through the same displayPage used by line extraction.
+    ProfileRecorder::Stage wordsStage("words");
     VisibleTextOutputDev textOut(nullptr, true, 0, false, false);
-    doc->displayPage(&textOut, 1, 72, 72, 0 /*use PDF rotation*/, false, true,
-                     false);
+    timedDisplayPage(*doc, &textOut, 1, 72, 0 /*use PDF rotation*/, false,
+                     true, false);
     TextPage *textPage = textOut.takeText();
 
+    // Scratch arena for the lookup structures below; freed on return.
+    std::pmr::monotonic_buffer_resource scratch(kScratchArenaBytes);
+
     std::vector<TextRegion> pageRegions;
     std::string fullText;
+    std::string text; // reused UTF-8 buffer, one per call instead of per word
 
     for (const TextFlow *flow = textPage->getFlows(); flow;
          flow = flow->getNext()) {
@@ -283,91 +605,34 @@ OCRResult OCRAnalysis::extractTextFromPDF(const std::string &pdfPath,
               continue;
 
             // Build UTF-8 text for this word
-            std::string text;
-            for (int ci = 0; ci < word->getLength(); ci++) {
-              const Unicode *uns = word->getChar(ci);
-              if (!uns)
-                continue;
-              Unicode u = *uns;
-              if (u < 0x80) {
-                text += static_cast<char>(u);
-              } else if (u < 0x800) {
-                text += static_cast<char>(0xC0 | (u >> 6));
-                text += static_cast<char>(0x80 | (u & 0x3F));
-              } else {
-                text += static_cast<char>(0xE0 | (u >> 12));
-                text += static_cast<char>(0x80 | ((u >> 6) & 0x3F));
-                text += static_cast<char>(0x80 | (u & 0x3F));
-              }
-            }
+            text.clear();
+            appendWordUtf8(word, text);
             if (text.empty())
               continue;
 
-            // getBBox() returns coordinates in screen-Y-down space:
-            //   xMin/xMax = left/right (same as PDF x)
-            //   yMin = TOP of word  (screen-Y, 0=top of display)
-            //   yMax = BOTTOM of word (screen-Y, larger = lower on page)
-            // Convert to PDF y-up (bottom-left origin, y-up from bottom of
-            // display) using the display height (dispH):
-            //   pdf_y_bottom = dispH - yMax   ← bottom edge (y-up)
-            //   pdf_y_top    = dispH - yMin   ← top edge (y-up)
-            double xMin, yMinScr, xMax, yMaxScr;
-            word->getBBox(&xMin, &yMinScr, &xMax, &yMaxScr);
-            double pdf_y_bottom = dispH - yMaxScr; // PDF y-up bottom edge
-            double pdf_y_top = dispH - yMinScr;    // PDF y-up top edge
-            double width = xMax - xMin;
-            double height = pdf_y_top - pdf_y_bottom;
-
             TextRegion region;
             region.text = text;
-            // Store bottom-left y-up coordinate (PDF bottom-left origin,
-            // same space as images and line-extraction crop marks).
-            region.boundingBox = cv::Rect(
-                static_cast<int>(xMin), static_cast<int>(pdf_y_bottom),
-                static_cast<int>(width), static_cast<int>(height + 0.5));
-            region.preciseX = xMin;
-            region.preciseY = pdf_y_bottom; // PDF bottom-left y (bottom edge)
-            region.preciseWidth = width;
-            region.preciseHeight = height;
-            region.fontSize = height; // approximation
-
-            // Font info
-            const TextFontInfo *fi = word->getFontInfo(0);
-            if (fi) {
-              const GooString *fn = fi->getFontName();
-              if (fn) {
-                region.fontName = fn->toStr();
-                auto plusPos = region.fontName.find('+');
-                if (plusPos != std::string::npos)
-                  region.fontName = region.fontName.substr(plusPos + 1);
-              }
-              region.isBold = fi->isBold();
-              region.isItalic = fi->isItalic();
-            }
-
-            // Orientation from TextWord rotation (0=0°,1=90°,2=180°,3=270°)
-            int rot = word->getRotation();
-            if (rot == 1 || rot == 3)
-              region.orientation = TextOrientation::Vertical;
-            else
-              region.orientation = TextOrientation::Horizontal;
+            fillWordRegion(word, dispH, region);
 
             region.confidence = 80.0f;
             region.level = 1; // page 1
 
-            pageRegions.push_back(region);
-            fullText += text + " ";
+            pageRegions.push_back(std::move(region));
+            fullText += text;
+            fullText += ' ';
           }
         }
       }
     }
     textPage->decRefCnt();
+    wordsStage.stop();
 
     // Filter out text that is covered by subsequent opaque drawing (e.g. a
     // white rectangle painted over hidden template text).  Rasterize the page
     // at 72 DPI and discard any word whose bounding box has no dark pixels.
     // Filtered words are saved to result.hiddenRegions for diagnostics.
     {
+      ProfileRecorder::Stage stage("hiddenRaster");
       constexpr double kRasterDpi  = 72.0;
       constexpr double kScale      = kRasterDpi / 72.0; // == 1.0
       constexpr int    kDarkThresh = 600; // sum R+G+B < this → "dark"
@@ -376,18 +641,15 @@ OCRResult OCRAnalysis::extractTextFromPDF(const std::string &pdfPath,
       // opaque white shape) has minSum = 765 (pure white).  600 sits safely
       // between the two populations.
 
-      SplashColor white = {255, 255, 255};
-      SplashOutputDev *sp = new SplashOutputDev(splashModeRGB8, 4, false, white);
-      sp->startDoc(doc.get());
-      doc->displayPage(sp, 1, kRasterDpi, kRasterDpi, 0, false, true, false);
-      SplashBitmap *bmp = sp->getBitmap();
-      const int bmpW = bmp->getWidth(), bmpH = bmp->getHeight();
-      const int rowStride = bmp->getRowSize();
-      const unsigned char *data = bmp->getDataPtr();
+      // The page is rendered in bands (OCRConfig::rasterMemoryBudget); each
+      // word's box is tested against every band it overlaps, so no band
+      // overlap is needed.
+      int bmpW = 0, bmpH = 0;
+      renderedPageSize(doc.get(), 1, kRasterDpi, bmpW, bmpH);
 
-      std::vector<TextRegion> kept;
-      kept.reserve(pageRegions.size());
-      for (auto &tr : pageRegions) {
+      std::vector<cv::Rect> boxes;
+      boxes.reserve(pageRegions.size());
+      for (const auto &tr : pageRegions) {
         // Convert PDF y-up bottom-left coords to pixel top-left.
         int px = static_cast<int>(tr.preciseX * kScale);
         int py = static_cast<int>((dispH - tr.preciseY - tr.preciseHeight) * kScale);
@@ -397,45 +659,70 @@ OCRResult OCRAnalysis::extractTextFromPDF(const std::string &pdfPath,
         py = std::max(0, std::min(py, bmpH - 1));
         pw = std::min(pw, bmpW - px);
         ph = std::min(ph, bmpH - py);
-        bool hasDark = false;
-        for (int sy = py; sy < py + ph && !hasDark; ++sy) {
-          const unsigned char *row = data + sy * rowStride + px * 3;
-          for (int sx = 0; sx < pw; ++sx, row += 3) {
-            if (static_cast<int>(row[0]) + row[1] + row[2] < kDarkThresh) {
-              hasDark = true;
-              break;
+        boxes.emplace_back(px, py, pw, ph);
+      }
+
+      std::vector<char> dark(pageRegions.size(), 0);
+      forEachPageBand(
+          doc.get(), 1, kRasterDpi, m_config.rasterMemoryBudget, 0, false,
+          [&](const cv::Mat &band, int top) {
+            for (size_t i = 0; i < boxes.size(); ++i) {
+              if (dark[i])
+                continue;
+              const cv::Rect &b = boxes[i];
+              int y0 = std::max(b.y, top);
+              int y1 = std::min(b.y + b.height, top + band.rows);
+              int x1 = std::min(b.x + b.width, band.cols);
+              for (int sy = y0; sy < y1 && !dark[i]; ++sy) {
+                const unsigned char *row = band.ptr<unsigned char>(sy - top) + b.x * 3;
+                for (int sx = b.x; sx < x1; ++sx, row += 3) {
+                  if (static_cast<int>(row[0]) + row[1] + row[2] < kDarkThresh) {
+                    dark[i] = 1;
+                    break;
+                  }
+                }
+              }
             }
-          }
-        }
-        if (hasDark) {
+            return true;
+          });
+
+      std::vector<TextRegion> kept;
+      kept.reserve(pageRegions.size());
+      for (size_t i = 0; i < pageRegions.size(); ++i) {
+        TextRegion &tr = pageRegions[i];
+        if (dark[i]) {
           kept.push_back(std::move(tr));
         } else {
-          std::cerr << "Filtered invisible text \"" << tr.text
-                    << "\" (covered by opaque shape in PDF)" << std::endl;
+          OCR_DEBUG << "Filtered invisible text \"" << tr.text
+                    << "\" (covered by opaque shape in PDF)";
           result.hiddenRegions.push_back(std::move(tr));
         }
       }
       pageRegions = std::move(kept);
-
-      delete sp;
     }
 
     // Also detect render-mode-3 (invisible/glyphless) text that the
     // VisibleTextOutputDev suppressed.  Run a standard TextOutputDev to
     // capture ALL text, then find words present there but not in pageRegions.
     {
+      ProfileRecorder::Stage stage("renderMode3");
       TextOutputDev allTextOut(nullptr, true, 0, false, false);
-      doc->displayPage(&allTextOut, 1, 72, 72, 0, false, true, false);
+      timedDisplayPage(*doc, &allTextOut, 1, 72, 0, false, true, false);
       TextPage *allPage = allTextOut.takeText();
 
-      // Build a set of (text, x, y) from visible words for fast lookup
-      std::set<std::tuple<std::string, int, int>> visibleSet;
+      // Build a set of (text, x, y) from visible words for fast lookup.
+      // Keys (and their strings) live in the scratch arena; lookups use a
+      // string_view so no temporary key string is built per word.
+      std::pmr::set<std::tuple<std::pmr::string, int, int>, std::less<>>
+          visibleSet(&scratch);
       for (const auto &r : pageRegions) {
-        visibleSet.insert({r.text, r.boundingBox.x, r.boundingBox.y});
+        visibleSet.emplace(std::string_view(r.text), r.boundingBox.x,
+                           r.boundingBox.y);
       }
       // Also include already-filtered hidden regions to avoid duplicates
       for (const auto &r : result.hiddenRegions) {
-        visibleSet.insert({r.text, r.boundingBox.x, r.boundingBox.y});
+        visibleSet.emplace(std::string_view(r.text), r.boundingBox.x,
+                           r.boundingBox.y);
       }
 
       for (const TextFlow *flow = allPage->getFlows(); flow;
@@ -447,21 +734,8 @@ OCRResult OCRAnalysis::extractTextFromPDF(const std::string &pdfPath,
                  word = word->getNext()) {
               if (word->getLength() == 0)
                 continue;
-              std::string text;
-              for (int ci = 0; ci < word->getLength(); ci++) {
-                const Unicode *uns = word->getChar(ci);
-                if (!uns) continue;
-                Unicode uc = *uns;
-                if (uc < 0x80) text += static_cast<char>(uc);
-                else if (uc < 0x800) {
-                  text += static_cast<char>(0xC0 | (uc >> 6));
-                  text += static_cast<char>(0x80 | (uc & 0x3F));
-                } else {
-                  text += static_cast<char>(0xE0 | (uc >> 12));
-                  text += static_cast<char>(0x80 | ((uc >> 6) & 0x3F));
-                  text += static_cast<char>(0x80 | (uc & 0x3F));
-                }
-              }
+              text.clear();
+              appendWordUtf8(word, text);
               if (text.empty()) continue;
 
               double xMin, yMinScr, xMax, yMaxScr;
@@ -473,7 +747,8 @@ OCRResult OCRAnalysis::extractTextFromPDF(const std::string &pdfPath,
               int ix = static_cast<int>(xMin);
               int iy = static_cast<int>(pyb);
 
-              if (visibleSet.count({text, ix, iy}) == 0) {
+              if (visibleSet.count(std::make_tuple(std::string_view(text),
+                                                   ix, iy)) == 0) {
                 TextRegion region;
                 region.text = text;
                 region.boundingBox = cv::Rect(ix, iy,
@@ -485,8 +760,8 @@ OCRResult OCRAnalysis::extractTextFromPDF(const std::string &pdfPath,
                 region.fontSize = h;
                 region.confidence = 0.0f; // render mode 3
                 result.hiddenRegions.push_back(region);
-                std::cerr << "Detected render-mode-3 invisible text \""
-                          << text << "\"" << std::endl;
+                OCR_DEBUG << "Detected render-mode-3 invisible text \""
+                          << text << "\"";
               }
             }
           }
@@ -501,7 +776,7 @@ OCRResult OCRAnalysis::extractTextFromPDF(const std::string &pdfPath,
     } else {
       // Simple greedy line grouping by Y proximity (bottom-left coords).
       std::vector<TextRegion> lineRegions;
-      std::vector<bool> used(pageRegions.size(), false);
+      std::pmr::vector<bool> used(pageRegions.size(), false, &scratch);
       for (size_t i = 0; i < pageRegions.size(); i++) {
         if (used[i])
           continue;
@@ -601,7 +876,7 @@ OCRAnalysis::extractGraphicsFromPDF(const std::string &pdfPath, double dpi) {
     }
 
     // Render page at specified DPI
-    poppler::image popplerImage = renderer.render_page(page.get(), dpi, dpi);
+    poppler::image popplerImage = timedRenderPage(renderer, page.get(), dpi);
 
     if (!popplerImage.is_valid()) {
       result.errorMessage = "Failed to render first page";
@@ -612,45 +887,27 @@ OCRAnalysis::extractGraphicsFromPDF(const std::string &pdfPath, double dpi) {
     int width = popplerImage.width();
     int height = popplerImage.height();
 
-    // Create OpenCV Mat based on Poppler image format
+    // Create OpenCV Mat based on Poppler image format.  The conversion
+    // reads straight from the Poppler buffer and writes the owned result,
+    // so each pixel is touched once.
+    cv::Mat view = popplerImageView(popplerImage);
     cv::Mat mat;
 
     switch (popplerImage.format()) {
-    case poppler::image::format_argb32: {
-      // ARGB32 format - 4 bytes per pixel
-      mat = cv::Mat(height, width, CV_8UC4,
-                    const_cast<char *>(popplerImage.const_data()),
-                    popplerImage.bytes_per_row())
-                .clone();
-      // Convert ARGB to BGRA (OpenCV format)
-      cv::cvtColor(mat, mat, cv::COLOR_BGRA2BGR);
+    case poppler::image::format_argb32:
+      // ARGB32 format - BGRA bytes in memory
+      cv::cvtColor(view, mat, cv::COLOR_BGRA2BGR);
       break;
-    }
-    case poppler::image::format_rgb24: {
+    case poppler::image::format_rgb24:
       // RGB24 format - 3 bytes per pixel
-      mat = cv::Mat(height, width, CV_8UC3,
-                    const_cast<char *>(popplerImage.const_data()),
-                    popplerImage.bytes_per_row())
-                .clone();
-      cv::cvtColor(mat, mat, cv::COLOR_RGB2BGR);
+      cv::cvtColor(view, mat, cv::COLOR_RGB2BGR);
       break;
-    }
-    case poppler::image::format_bgr24: {
+    case poppler::image::format_bgr24:
       // BGR24 format - already in OpenCV format
-      mat = cv::Mat(height, width, CV_8UC3,
-                    const_cast<char *>(popplerImage.const_data()),
-                    popplerImage.bytes_per_row())
-                .clone();
-      break;
-    }
-    case poppler::image::format_gray8: {
+    case poppler::image::format_gray8:
       // Grayscale
-      mat = cv::Mat(height, width, CV_8UC1,
-                    const_cast<char *>(popplerImage.const_data()),
-                    popplerImage.bytes_per_row())
-                .clone();
+      mat = view.clone();
       break;
-    }
     default:
       result.errorMessage = "Unsupported image format";
       return result;
@@ -697,6 +954,11 @@ public:
 
   void setDoc(PDFDoc *d) { doc = d; }
 
+  // Hand each image to fn as it is decoded instead of collecting it
+  void setSink(std::function<void(OCRAnalysis::PDFEmbeddedImage &)> fn) {
+    sink = std::move(fn);
+  }
+
   // Required OutputDev overrides
   bool upsideDown() override { return false; }
   bool useDrawChar() override { return false; }
@@ -711,8 +973,8 @@ public:
                      int height, bool invert, bool /*interpolate*/,
                      bool /*inlineImg*/) override {
 
-    std::cerr << "DEBUG: drawImageMask called: " << width << "x" << height
-              << " invert=" << invert << std::endl;
+    OCR_DEBUG << "drawImageMask called: " << width << "x" << height
+              << " invert=" << invert;
 
     if (width <= 0 || height <= 0) {
       return;
@@ -785,12 +1047,12 @@ public:
     img.rotationAngle = rotationAngle;
     img.type = "image_mask";
 
-    std::cerr << "DEBUG: drawImageMask extracted " << width << "x" << height
+    OCR_DEBUG << "drawImageMask extracted " << width << "x" << height
               << " at (" << x << ", " << y << "), display " << displayWidth
               << "x" << displayHeight << ", fill=(" << (int)fgR << ","
-              << (int)fgG << "," << (int)fgB << ")" << std::endl;
+              << (int)fgG << "," << (int)fgB << ")";
 
-    images.push_back(img);
+    emit(img);
   }
 
   // This is called for each image in the PDF
@@ -798,9 +1060,9 @@ public:
                  int height, GfxImageColorMap *colorMap, bool /*interpolate*/,
                  const int * /*maskColors*/, bool inlineImg) override {
 
-    std::cerr << "DEBUG: drawImage called: " << width << "x" << height
+    OCR_DEBUG << "drawImage called: " << width << "x" << height
               << " nComps=" << (colorMap ? colorMap->getNumPixelComps() : -1)
-              << " inline=" << inlineImg << std::endl;
+              << " inline=" << inlineImg;
 
     if (width <= 0 || height <= 0 || !colorMap) {
       return;
@@ -907,7 +1169,7 @@ public:
     img.rotationAngle = rotationAngle;
     img.type = "raw";
 
-    images.push_back(img);
+    emit(img);
   }
 
   // Handle images with soft masks (SMask / alpha channel).
@@ -919,9 +1181,8 @@ public:
                            int maskHeight, GfxImageColorMap *maskColorMap,
                            bool /*maskInterpolate*/) override {
 
-    std::cerr << "DEBUG: drawSoftMaskedImage called: base " << width << "x"
-              << height << ", mask " << maskWidth << "x" << maskHeight
-              << std::endl;
+    OCR_DEBUG << "drawSoftMaskedImage called: base " << width << "x"
+              << height << ", mask " << maskWidth << "x" << maskHeight;
 
     if (maskWidth <= 0 || maskHeight <= 0 || !maskColorMap) {
       // Fall back to regular drawImage if no usable mask
@@ -1029,7 +1290,7 @@ public:
     img.rotationAngle = rotationAngle;
     img.type = "soft_masked";
 
-    images.push_back(img);
+    emit(img);
   }
 
   // Handle images with a 1-bit (hard) mask.
@@ -1042,9 +1303,9 @@ public:
                        int maskHeight, bool maskInvert,
                        bool /*maskInterpolate*/) override {
 
-    std::cerr << "DEBUG: drawMaskedImage called: image " << width << "x"
+    OCR_DEBUG << "drawMaskedImage called: image " << width << "x"
               << height << ", mask " << maskWidth << "x" << maskHeight
-              << ", invert=" << maskInvert << std::endl;
+              << ", invert=" << maskInvert;
 
     if (width <= 0 || height <= 0 || !colorMap) {
       return;
@@ -1158,15 +1419,23 @@ public:
     img.rotationAngle = rotationAngle;
     img.type = "masked";
 
-    std::cerr << "DEBUG: drawMaskedImage extracted " << img.width << "x"
+    OCR_DEBUG << "drawMaskedImage extracted " << img.width << "x"
               << img.height << " at (" << x << ", " << y << "), display "
-              << displayWidth << "x" << displayHeight << std::endl;
+              << displayWidth << "x" << displayHeight;
 
-    images.push_back(img);
+    emit(img);
   }
 
 private:
+  void emit(OCRAnalysis::PDFEmbeddedImage &img) {
+    if (sink)
+      sink(img);
+    else
+      images.push_back(std::move(img));
+  }
+
   std::vector<OCRAnalysis::PDFEmbeddedImage> images;
+  std::function<void(OCRAnalysis::PDFEmbeddedImage &)> sink;
   PDFDoc *doc;
   int pageNumber;
   int imageIndex;
@@ -1184,7 +1453,7 @@ OCRAnalysis::extractEmbeddedImagesFromPDF(const std::string &pdfPath) {
   try {
     // Initialize Poppler's global parameters (required for low-level API)
     // GlobalParamsIniter is a RAII class that manages the lifecycle
-    GlobalParamsIniter globalParamsInit(nullptr);
+    GlobalParamsIniter globalParamsInit(popplerErrorToLog);
 
     // Load PDF using low-level Poppler API
     auto fileName = std::make_unique<GooString>(pdfPath);
@@ -1202,7 +1471,7 @@ OCRAnalysis::extractEmbeddedImagesFromPDF(const std::string &pdfPath) {
     }
 
     // Create our custom output device to capture images
-    std::cerr << "DEBUG: Creating ImageExtractorOutputDev..." << std::endl;
+    OCR_DEBUG << "Creating ImageExtractorOutputDev...";
     ImageExtractorOutputDev outputDev;
     outputDev.setDoc(doc.get());
 
@@ -1212,16 +1481,14 @@ OCRAnalysis::extractEmbeddedImagesFromPDF(const std::string &pdfPath) {
 
     // Display (render) the page to our output device
     // This triggers drawImage callbacks for each image
-    std::cerr << "DEBUG: Calling displayPage for embedded images..."
-              << std::endl;
-    doc->displayPage(&outputDev, pageIndex, 72.0,
+    OCR_DEBUG << "Calling displayPage for embedded images...";
+    timedDisplayPage(*doc, &outputDev, pageIndex,
                      72.0,   // DPI (not used since we capture raw)
                      0,      // rotation
                      true,   // useMediaBox
                      false,  // crop
                      false); // printing
-    std::cerr << "DEBUG: displayPage completed for embedded images"
-              << std::endl;
+    OCR_DEBUG << "displayPage completed for embedded images";
 
     // Get the extracted images
     result.images = std::move(outputDev.getImages());
@@ -1250,6 +1517,11 @@ public:
 
   void setPageNumber(int page) { pageNumber = page; }
 
+  // Hand each rectangle to fn as it is found instead of collecting it
+  void setSink(std::function<void(OCRAnalysis::PDFRectangle &)> fn) {
+    sink = std::move(fn);
+  }
+
   // Required OutputDev overrides
   bool upsideDown() override { return false; }
   bool useDrawChar() override { return false; }
@@ -1342,7 +1614,10 @@ private:
       rect.filled = isFilled;
       rect.stroked = isStroked;
 
-      rectangles.push_back(rect);
+      if (sink)
+        sink(rect);
+      else
+        rectangles.push_back(rect);
     }
   }
 
@@ -1382,6 +1657,7 @@ private:
   }
 
   std::vector<OCRAnalysis::PDFRectangle> rectangles;
+  std::function<void(OCRAnalysis::PDFRectangle &)> sink;
   int pageNumber;
   double minSize;
 };
@@ -1398,7 +1674,7 @@ OCRAnalysis::extractRectanglesFromPDF(const std::string &pdfPath,
 
   try {
     // Initialize Poppler's global parameters
-    GlobalParamsIniter globalParamsInit(nullptr);
+    GlobalParamsIniter globalParamsInit(popplerErrorToLog);
 
     // Load PDF
     auto fileName = std::make_unique<GooString>(pdfPath);
@@ -1422,7 +1698,7 @@ OCRAnalysis::extractRectanglesFromPDF(const std::string &pdfPath,
     int pageIndex = 1;
     outputDev.setPageNumber(pageIndex);
 
-    doc->displayPage(&outputDev, pageIndex, 72.0, 72.0, // DPI
+    timedDisplayPage(*doc, &outputDev, pageIndex, 72.0, // DPI
                      0,                                 // rotation
                      true,                              // useMediaBox
                      false,                             // crop
@@ -1454,6 +1730,11 @@ public:
 
   void setPageNumber(int page) { pageNumber = page; }
 
+  // Hand each line to fn as it is found instead of collecting it
+  void setSink(std::function<void(OCRAnalysis::PDFLine &)> fn) {
+    sink = std::move(fn);
+  }
+
   // Required OutputDev overrides
   bool upsideDown() override { return false; }
   bool useDrawChar() override { return false; }
@@ -1524,7 +1805,7 @@ private:
         line.isHorizontal = isHorizontal;
         line.isVertical = isVertical;
 
-        lines.push_back(line);
+        emit(line);
       }
 
       // If closed, also add the closing segment
@@ -1558,13 +1839,21 @@ private:
           line.isHorizontal = angle < 5.0;
           line.isVertical = angle > 85.0;
 
-          lines.push_back(line);
+          emit(line);
         }
       }
     }
   }
 
+  void emit(OCRAnalysis::PDFLine &line) {
+    if (sink)
+      sink(line);
+    else
+      lines.push_back(line);
+  }
+
   std::vector<OCRAnalysis::PDFLine> lines;
+  std::function<void(OCRAnalysis::PDFLine &)> sink;
   int pageNumber;
   double minLength;
 };
@@ -1580,7 +1869,7 @@ OCRAnalysis::extractLinesFromPDF(const std::string &pdfPath, double minLength) {
 
   try {
     // Initialize Poppler's global parameters
-    GlobalParamsIniter globalParamsInit(nullptr);
+    GlobalParamsIniter globalParamsInit(popplerErrorToLog);
 
     // Load PDF
     auto fileName = std::make_unique<GooString>(pdfPath);
@@ -1604,7 +1893,7 @@ OCRAnalysis::extractLinesFromPDF(const std::string &pdfPath, double minLength) {
     int pageIndex = 1;
     outputDev.setPageNumber(pageIndex);
 
-    doc->displayPage(&outputDev, pageIndex, 72.0, 72.0, // DPI
+    timedDisplayPage(*doc, &outputDev, pageIndex, 72.0, // DPI
                      0,                                 // rotation
                      true,                              // useMediaBox
                      false,                             // crop
@@ -1677,6 +1966,232 @@ OCRAnalysis::extractLinesFromPDF(const std::string &pdfPath, double minLength) {
   return result;
 }
 
+// TextOutputDev that also forwards paths and images to the extractor devices
+// above as they are drawn, so visitPDF() gets every element kind from a single
+// interpretation of each page.
+namespace {
+
+class VisitorOutputDev : public TextOutputDev {
+public:
+  VisitorOutputDev(double minRectSize, double minLineLength, bool decodeImages)
+      : TextOutputDev(nullptr, true, 0, false, false), rectDev(minRectSize),
+        lineDev(minLineLength), wantImages(decodeImages) {}
+
+  RectangleExtractorOutputDev &rects() { return rectDev; }
+  LineExtractorOutputDev &lines() { return lineDev; }
+  ImageExtractorOutputDev &images() { return imageDev; }
+
+  void setPageNumber(int page) {
+    rectDev.setPageNumber(page);
+    lineDev.setPageNumber(page);
+    imageDev.setPageNumber(page);
+  }
+
+  // TextOutputDev only asks for glyphs; we need paths and images too
+  bool needNonText() override { return true; }
+
+  // Suppress rendering-mode-3 (invisible) text, as extractTextFromPDF does
+  void drawChar(GfxState *state, double x, double y, double dx, double dy,
+                double originX, double originY, CharCode c, int nBytes,
+                const Unicode *u, int uLen) override {
+    if (state->getRender() == 3)
+      return;
+    TextOutputDev::drawChar(state, x, y, dx, dy, originX, originY, c, nBytes,
+                            u, uLen);
+  }
+
+  void stroke(GfxState *state) override {
+    TextOutputDev::stroke(state);
+    rectDev.stroke(state);
+    lineDev.stroke(state);
+  }
+
+  void fill(GfxState *state) override {
+    TextOutputDev::fill(state);
+    rectDev.fill(state);
+  }
+
+  void drawImageMask(GfxState *state, Object *ref, Stream *str, int width,
+                     int height, bool invert, bool interpolate,
+                     bool inlineImg) override {
+    if (wantImages)
+      imageDev.drawImageMask(state, ref, str, width, height, invert,
+                             interpolate, inlineImg);
+    else
+      TextOutputDev::drawImageMask(state, ref, str, width, height, invert,
+                                   interpolate, inlineImg);
+  }
+
+  void drawImage(GfxState *state, Object *ref, Stream *str, int width,
+                 int height, GfxImageColorMap *colorMap, bool interpolate,
+                 const int *maskColors, bool inlineImg) override {
+    if (wantImages)
+      imageDev.drawImage(state, ref, str, width, height, colorMap, interpolate,
+                         maskColors, inlineImg);
+    else
+      TextOutputDev::drawImage(state, ref, str, width, height, colorMap,
+                               interpolate, maskColors, inlineImg);
+  }
+
+  void drawSoftMaskedImage(GfxState *state, Object *ref, Stream *str, int width,
+                           int height, GfxImageColorMap *colorMap,
+                           bool interpolate, Stream *maskStr, int maskWidth,
+                           int maskHeight, GfxImageColorMap *maskColorMap,
+                           bool maskInterpolate) override {
+    if (wantImages)
+      imageDev.drawSoftMaskedImage(state, ref, str, width, height, colorMap,
+                                   interpolate, maskStr, maskWidth, maskHeight,
+                                   maskColorMap, maskInterpolate);
+    else
+      TextOutputDev::drawSoftMaskedImage(
+          state, ref, str, width, height, colorMap, interpolate, maskStr,
+          maskWidth, maskHeight, maskColorMap, maskInterpolate);
+  }
+
+  void drawMaskedImage(GfxState *state, Object *ref, Stream *str, int width,
+                       int height, GfxImageColorMap *colorMap, bool interpolate,
+                       Stream *maskStr, int maskWidth, int maskHeight,
+                       bool maskInvert, bool maskInterpolate) override {
+    if (wantImages)
+      imageDev.drawMaskedImage(state, ref, str, width, height, colorMap,
+                               interpolate, maskStr, maskWidth, maskHeight,
+                               maskInvert, maskInterpolate);
+    else
+      TextOutputDev::drawMaskedImage(state, ref, str, width, height, colorMap,
+                                     interpolate, maskStr, maskWidth,
+                                     maskHeight, maskInvert, maskInterpolate);
+  }
+
+private:
+  RectangleExtractorOutputDev rectDev;
+  LineExtractorOutputDev lineDev;
+  ImageExtractorOutputDev imageDev;
+  bool wantImages;
+};
+
+} // anonymous namespace
+
+OCRAnalysis::PDFVisitResult
+OCRAnalysis::visitPDF(const std::string &pdfPath, PDFVisitor &visitor,
+                      double minRectSize, double minLineLength) {
+  PDFVisitResult result;
+  result.success = false;
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  try {
+    GlobalParamsIniter gpi(popplerErrorToLog);
+    auto gooFile = std::make_unique<GooString>(pdfPath);
+    std::unique_ptr<PDFDoc> doc(new PDFDoc(std::move(gooFile)));
+
+    if (!doc || !doc->isOk()) {
+      result.errorMessage = "Failed to load PDF file: " + pdfPath;
+      return result;
+    }
+    int pageCount = doc->getNumPages();
+    if (pageCount < 1) {
+      result.errorMessage = "PDF has no pages";
+      return result;
+    }
+
+    VisitorOutputDev outputDev(minRectSize, minLineLength,
+                               visitor.wantImages());
+    outputDev.images().setDoc(doc.get());
+
+    // TextOutputDev renders upside down (screen Y-down), so the path and
+    // image coordinates coming out of the extractor devices are flipped back
+    // into PDF y-up space using the current page's display height before
+    // they reach the visitor.
+    double dispH = 0;
+    outputDev.rects().setSink([&](PDFRectangle &rect) {
+      rect.y = dispH - (rect.y + rect.height);
+      visitor.onRect(rect);
+      result.rectangleCount++;
+    });
+    outputDev.lines().setSink([&](PDFLine &line) {
+      line.y1 = dispH - line.y1;
+      line.y2 = dispH - line.y2;
+      visitor.onLine(line);
+      result.lineCount++;
+    });
+    outputDev.images().setSink([&](PDFEmbeddedImage &img) {
+      double bottom = dispH - img.aabbMaxY;
+      img.aabbMaxY = dispH - img.y;
+      img.y = bottom;
+      img.rotationAngle = -img.rotationAngle;
+      visitor.onImage(img);
+      result.imageCount++;
+    });
+
+    // One TextRegion is reused for every word so its string buffers keep
+    // their capacity across the whole document.
+    TextRegion word;
+    word.confidence = 80.0f;
+
+    for (int page = 1; page <= pageCount; page++) {
+      Page *pg = doc->getPage(page);
+      if (!pg)
+        continue;
+
+      // Same display-size rule as extractTextFromPDF
+      const ::PDFRectangle *mb = pg->getMediaBox();
+      int pageRotate = pg->getRotate();
+      double dispW;
+      if (pageRotate == 90 || pageRotate == 270) {
+        dispW = mb->y2 - mb->y1;
+        dispH = mb->x2 - mb->x1;
+      } else {
+        dispW = mb->x2 - mb->x1;
+        dispH = mb->y2 - mb->y1;
+      }
+
+      outputDev.setPageNumber(page);
+      visitor.onPageBegin(page, dispW, dispH);
+
+      // Paths and images are emitted from inside this call
+      timedDisplayPage(*doc, &outputDev, page, 72, 0, false, true, false);
+
+      TextPage *textPage = outputDev.takeText();
+      for (const TextFlow *flow = textPage->getFlows(); flow;
+           flow = flow->getNext()) {
+        for (const TextBlock *blk = flow->getBlocks(); blk;
+             blk = blk->getNext()) {
+          for (const TextLine *ln = blk->getLines(); ln; ln = ln->getNext()) {
+            for (const TextWord *tw = ln->getWords(); tw;
+                 tw = tw->getNext()) {
+              if (tw->getLength() == 0)
+                continue;
+              word.text.clear();
+              appendWordUtf8(tw, word.text);
+              if (word.text.empty())
+                continue;
+              fillWordRegion(tw, dispH, word);
+              word.level = page;
+              visitor.onWord(word);
+              result.wordCount++;
+            }
+          }
+        }
+      }
+      textPage->decRefCnt();
+
+      visitor.onPageEnd(page);
+      result.pageCount++;
+    }
+
+    result.success = true;
+
+  } catch (const std::exception &e) {
+    result.errorMessage = std::string("PDF visit failed: ") + e.what();
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  result.processingTimeMs =
+      std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+  return result;
+}
+
 // Write a copy of the PDF whose CropBox/TrimBox/BleedBox/ArtBox are shrunk
 // to the supplied content rectangle (PDF y-up coords).  Output goes to
 // "<pdfDir>/graphics/<stem>_content.pdf".  Returns true on success.
@@ -1684,9 +2199,16 @@ OCRAnalysis::extractLinesFromPDF(const std::string &pdfPath, double minLength) {
 // Trim marks and other content outside the rectangle fall outside the
 // visible area when the resulting PDF is opened in a viewer.  Vector
 // content is preserved — no rasterisation occurs.
+//
+// With incremental=true the original bytes are copied verbatim and only the
+// modified page object plus a new xref section are appended, instead of
+// re-serialising every object.  With previewFromOpenDoc=true the PNG
+// preview is rendered from the document already in memory rather than by
+// re-opening the written file.
 static bool writeContentRectPDF(const std::string &pdfPath,
                                 double minX, double minY,
                                 double maxX, double maxY,
+                                bool incremental, bool previewFromOpenDoc,
                                 std::string &outPath,
                                 std::string &errorMessage) {
   try {
@@ -1696,7 +2218,7 @@ static bool writeContentRectPDF(const std::string &pdfPath,
     std::filesystem::path dst = outDir / (src.stem().string() + "_content.pdf");
     outPath = dst.string();
 
-    GlobalParamsIniter gpi(nullptr);
+    GlobalParamsIniter gpi(popplerErrorToLog);
     auto fileName = std::make_unique<GooString>(pdfPath);
     std::unique_ptr<PDFDoc> doc(new PDFDoc(std::move(fileName)));
     if (!doc->isOk()) {
@@ -1740,17 +2262,16 @@ static bool writeContentRectPDF(const std::string &pdfPath,
 
     xref->setModifiedObject(&pageObj, pageRef);
 
+    // writeStandard saves as an incremental update because the xref now
+    // holds a modified object.
     GooString outName(dst.string());
-    int rc = doc->saveAs(outName, writeForceRewrite);
+    int rc = doc->saveAs(outName,
+                         incremental ? writeStandard : writeForceRewrite);
     if (rc != errNone) {
       errorMessage = "PDFDoc::saveAs returned error " + std::to_string(rc);
       return false;
     }
 
-    // Release the underlying PDFDoc handle so the file can be re-opened by
-    // the poppler-cpp renderer below (Windows holds the file exclusive).
-    doc.reset();
-
     // Compute physical dimensions (mm + inches).  PDF user units are points.
     double widthPt  = maxX - minX;
     double heightPt = maxY - minY;
@@ -1767,7 +2288,51 @@ static bool writeContentRectPDF(const std::string &pdfPath,
         outDir / (src.stem().string() + "_content.png");
     int pngWidth = 0, pngHeight = 0;
     bool pngOk = false;
-    {
+    bool rendered = false;
+    auto writePreview = [&](const cv::Mat &bgr) {
+      pngWidth = bgr.cols;
+      pngHeight = bgr.rows;
+      pngOk = cv::imwrite(pngPath.string(), bgr);
+      rendered = true;
+    };
+
+    // The Page object still carries the CropBox it was loaded with, so render
+    // the media box and slice out the content rectangle ourselves.  Poppler
+    // clips a CropBox to the MediaBox on load; do the same here so the
+    // preview matches what the re-opened file would produce.  Rotated pages
+    // take the re-open path below.
+    if (previewFromOpenDoc && page->getRotate() == 0) {
+      const ::PDFRectangle *mb = page->getMediaBox();
+      double cx1 = std::max(minX, mb->x1), cy1 = std::max(minY, mb->y1);
+      double cx2 = std::min(maxX, mb->x2), cy2 = std::min(maxY, mb->y2);
+      const double scale = kRenderDpi / 72.0;
+      int sliceX = static_cast<int>(std::floor((cx1 - mb->x1) * scale));
+      int sliceY = static_cast<int>(std::floor((mb->y2 - cy2) * scale));
+      int sliceW = static_cast<int>(std::ceil((cx2 - cx1) * scale));
+      int sliceH = static_cast<int>(std::ceil((cy2 - cy1) * scale));
+      if (sliceW > 0 && sliceH > 0) {
+        SplashColor white = {255, 255, 255};
+        SplashOutputDev splashOut(splashModeBGR8, 4, false, white);
+        splashOut.setFontAntialias(true);
+        splashOut.setVectorAntialias(true);
+        splashOut.startDoc(doc.get());
+        timedDisplayPageSlice(*doc, &splashOut, 1, kRenderDpi, 0,
+                              true,  // useMediaBox
+                              false, // crop
+                              false, // printing
+                              sliceX, sliceY, sliceW, sliceH);
+        // BGR8 output is written straight from the Splash buffer
+        cv::Mat view = splashBitmapView(splashOut.getBitmap());
+        if (!view.empty())
+          writePreview(view);
+      }
+    }
+
+    // Release the underlying PDFDoc handle so the file can be re-opened by
+    // the poppler-cpp renderer below (Windows holds the file exclusive).
+    doc.reset();
+
+    if (!rendered) {
       std::unique_ptr<poppler::document> renderDoc(
           poppler::document::load_from_file(dst.string()));
       if (renderDoc && !renderDoc->is_locked() && renderDoc->pages() >= 1) {
@@ -1778,54 +2343,474 @@ static bool writeContentRectPDF(const std::string &pdfPath,
           renderer.set_render_hint(
               poppler::page_renderer::text_antialiasing, true);
           renderer.set_image_format(poppler::image::format_argb32);
-          poppler::image img =
-              renderer.render_page(pg.get(), kRenderDpi, kRenderDpi);
+          poppler::image img = timedRenderPage(renderer, pg.get(), kRenderDpi);
           if (img.is_valid()) {
-            pngWidth = img.width();
-            pngHeight = img.height();
-            cv::Mat mat(pngHeight, pngWidth, CV_8UC4,
-                        const_cast<char *>(img.const_data()),
-                        img.bytes_per_row());
             cv::Mat bgr;
-            cv::cvtColor(mat, bgr, cv::COLOR_BGRA2BGR);
-            pngOk = cv::imwrite(pngPath.string(), bgr);
+            cv::cvtColor(popplerImageView(img), bgr, cv::COLOR_BGRA2BGR);
+            writePreview(bgr);
           }
         }
       }
     }
 
-    // Append a single line per file to dimensions.txt in the graphics dir.
-    std::filesystem::path dimsPath = outDir / "dimensions.txt";
-    std::ofstream dimsOut(dimsPath, std::ios::app);
-    if (dimsOut) {
-      auto writeLine = [&](const std::string &name, bool withPx) {
-        dimsOut << name
-                << "  " << std::fixed << std::setprecision(2)
-                << widthMm << " x " << heightMm << " mm  ("
-                << std::setprecision(3)
-                << widthIn << " x " << heightIn << " in)";
-        if (withPx) {
-          dimsOut << "  " << pngWidth << " x " << pngHeight
-                  << " px @ " << std::setprecision(0) << kRenderDpi << " dpi";
-        }
-        dimsOut << "\n";
-      };
-      writeLine(dst.filename().string(), false);
-      if (pngOk) writeLine(pngPath.filename().string(), true);
+    // Append a single line per file to dimensions.txt in the graphics dir.
+    std::filesystem::path dimsPath = outDir / "dimensions.txt";
+    std::ofstream dimsOut(dimsPath, std::ios::app);
+    if (dimsOut) {
+      auto writeLine = [&](const std::string &name, bool withPx) {
+        dimsOut << name
+                << "  " << std::fixed << std::setprecision(2)
+                << widthMm << " x " << heightMm << " mm  ("
+                << std::setprecision(3)
+                << widthIn << " x " << heightIn << " in)";
+        if (withPx) {
+          dimsOut << "  " << pngWidth << " x " << pngHeight
+                  << " px @ " << std::setprecision(0) << kRenderDpi << " dpi";
+        }
+        dimsOut << "\n";
+      };
+      writeLine(dst.filename().string(), false);
+      if (pngOk) writeLine(pngPath.filename().string(), true);
+    }
+    return true;
+  } catch (const std::exception &e) {
+    errorMessage = std::string("writeContentRectPDF exception: ") + e.what();
+    return false;
+  }
+}
+
+// Content rects computed by extractPDFElements, keyed by canonical file path.
+// An entry is only reused while the file's size and modification time are
+// unchanged and the extraction thresholds match, so an L1/L2 pair processed
+// back to back shares the work without ever serving stale geometry.  The
+// cache holds the most recently used kContentRectCacheCapacity files, so a
+// long-running watcher or server does not accumulate an entry per PDF seen.
+namespace {
+
+constexpr size_t kContentRectCacheCapacity = 64;
+
+struct ContentRectCacheEntry {
+  std::uintmax_t fileSize = 0;
+  std::filesystem::file_time_type mtime;
+  double minRectSize = 0, minLineLength = 0;
+  double minX = 0, minY = 0, maxX = 0, maxY = 0;
+  std::list<std::string>::iterator lruPos; ///< Entry in ContentRectCache::lru
+};
+
+struct ContentRectCache {
+  std::mutex mutex;
+  std::map<std::string, ContentRectCacheEntry> entries;
+  std::list<std::string> lru; ///< Keys, most recently used first
+};
+
+ContentRectCache &contentRectCache() {
+  static ContentRectCache cache;
+  return cache;
+}
+
+// Canonical path plus the file's current size/mtime; false if the file
+// cannot be stat'ed (in which case nothing is cached).
+bool contentRectCacheKey(const std::string &pdfPath, std::string &key,
+                         std::uintmax_t &size,
+                         std::filesystem::file_time_type &mtime) {
+  std::error_code ec;
+  auto canon = std::filesystem::weakly_canonical(pdfPath, ec);
+  key = ec ? pdfPath : canon.string();
+  size = std::filesystem::file_size(pdfPath, ec);
+  if (ec)
+    return false;
+  mtime = std::filesystem::last_write_time(pdfPath, ec);
+  return !ec;
+}
+
+bool lookupContentRect(const std::string &pdfPath, double minRectSize,
+                       double minLineLength, double &minX, double &minY,
+                       double &maxX, double &maxY) {
+  std::string key;
+  std::uintmax_t size;
+  std::filesystem::file_time_type mtime;
+  if (!contentRectCacheKey(pdfPath, key, size, mtime))
+    return false;
+
+  auto &cache = contentRectCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto it = cache.entries.find(key);
+  if (it == cache.entries.end())
+    return false;
+  const auto &e = it->second;
+  if (e.fileSize != size || e.mtime != mtime) {
+    // The file has changed; its rect will never be valid again.
+    cache.lru.erase(e.lruPos);
+    cache.entries.erase(it);
+    return false;
+  }
+  if (e.minRectSize != minRectSize || e.minLineLength != minLineLength)
+    return false;
+  cache.lru.splice(cache.lru.begin(), cache.lru, e.lruPos);
+  minX = e.minX;
+  minY = e.minY;
+  maxX = e.maxX;
+  maxY = e.maxY;
+  return true;
+}
+
+void storeContentRect(const std::string &pdfPath, double minRectSize,
+                      double minLineLength, double minX, double minY,
+                      double maxX, double maxY) {
+  ContentRectCacheEntry e;
+  std::string key;
+  if (!contentRectCacheKey(pdfPath, key, e.fileSize, e.mtime))
+    return;
+  e.minRectSize = minRectSize;
+  e.minLineLength = minLineLength;
+  e.minX = minX;
+  e.minY = minY;
+  e.maxX = maxX;
+  e.maxY = maxY;
+
+  auto &cache = contentRectCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto it = cache.entries.find(key);
+  if (it != cache.entries.end()) {
+    e.lruPos = it->second.lruPos;
+    cache.lru.splice(cache.lru.begin(), cache.lru, e.lruPos);
+    it->second = e;
+    return;
+  }
+  cache.lru.push_front(key);
+  e.lruPos = cache.lru.begin();
+  cache.entries.emplace(std::move(key), e);
+  while (cache.entries.size() > kContentRectCacheCapacity) {
+    cache.entries.erase(cache.lru.back());
+    cache.lru.pop_back();
+  }
+}
+
+} // anonymous namespace
+
+#ifdef HAVE_ZXING
+// Geometry hints for vector-drawn DataMatrix codes
+namespace {
+
+/// A cluster of small marks that may be a vector DataMatrix.  Coordinates
+/// are page points, y-up, relative to the media box origin (the same space
+/// as RectangleExtractorOutputDev).
+struct DataMatrixCandidate {
+  double minX, minY, maxX, maxY;
+  double modulePt; ///< Estimated module size (shortest straight edge)
+  int shapes;      ///< Marks in the cluster
+  bool filled;     ///< Straight-edged fills; otherwise strokes, curves or
+                   ///< glyphs, whose module size is only a guess
+};
+
+// Collects the bounding box of every mark small enough to be part of a
+// DataMatrix.  Codes are usually drawn either as one rectangle per module or
+// as the outline of merged module runs, both filled and made of horizontal
+// and vertical edges only; those are kept as "filled" shapes with a reliable
+// edge length.  Everything else that could make up a code (stroked module
+// runs, curved or slanted fills, barcode-font glyphs) is kept separately so
+// it can be clustered and scanned without rasterising the whole page.
+class DataMatrixCandidateOutputDev : public OutputDev {
+public:
+  struct Shape {
+    double minX, minY, maxX, maxY;
+    double minEdge; ///< Shortest edge, or the mark's module-size guess
+  };
+
+  std::vector<Shape> &getShapes() { return shapes; }
+  std::vector<Shape> &getOtherMarks() { return otherMarks; }
+
+  bool upsideDown() override { return false; }
+  bool useDrawChar() override { return true; }
+  bool interpretType3Chars() override { return false; }
+  bool needNonText() override { return true; }
+
+  void fill(GfxState *state) override { collect(state); }
+  void eoFill(GfxState *state) override { collect(state); }
+
+  void stroke(GfxState *state) override {
+    const GfxPath *path = state->getPath();
+    if (!path)
+      return;
+    double halfWidth = 0.5 * std::max(state->getTransformedLineWidth(),
+                                      kMinEdgePt);
+    for (int i = 0; i < path->getNumSubpaths(); i++) {
+      const GfxSubpath *subpath = path->getSubpath(i);
+      Shape s = emptyShape();
+      for (int k = 0; k < subpath->getNumPoints(); k++) {
+        double tx, ty;
+        state->transform(subpath->getX(k), subpath->getY(k), &tx, &ty);
+        extend(s, tx, ty);
+      }
+      s.minX -= halfWidth;
+      s.minY -= halfWidth;
+      s.maxX += halfWidth;
+      s.maxY += halfWidth;
+      // A stroked code is drawn one module run per line, so the pen width
+      // is the module size.
+      s.minEdge = 2.0 * halfWidth;
+      addOther(s);
+    }
+  }
+
+  void drawChar(GfxState *state, double x, double y, double dx, double dy,
+                double, double, CharCode, int, const Unicode *,
+                int) override {
+    if (state->getRender() == 3)
+      return; // invisible
+    double x0, y0, x1, y1;
+    state->transform(x, y, &x0, &y0);
+    state->transformDelta(dx, dy, &x1, &y1);
+    x1 += x0;
+    double size = std::abs(state->getTransformedFontSize());
+    Shape s{std::min(x0, x1), y0, std::max(x0, x1), y0 + size, 0};
+    // Barcode fonts pack a few modules into each glyph.
+    s.minEdge = 0.5 * std::min(std::max(s.maxX - s.minX, kMinEdgePt), size);
+    addOther(s);
+  }
+
+private:
+  static constexpr double kMaxShapePt = 144.0; ///< Largest code we look for
+  static constexpr double kAxisTol = 0.01;     ///< Axis-alignment tolerance
+  static constexpr double kMinEdgePt = 0.1;    ///< Shorter edges are noise
+
+  static Shape emptyShape() {
+    return {std::numeric_limits<double>::max(),
+            std::numeric_limits<double>::max(),
+            std::numeric_limits<double>::lowest(),
+            std::numeric_limits<double>::lowest(),
+            std::numeric_limits<double>::max()};
+  }
+
+  static void extend(Shape &s, double tx, double ty) {
+    s.minX = std::min(s.minX, tx);
+    s.minY = std::min(s.minY, ty);
+    s.maxX = std::max(s.maxX, tx);
+    s.maxY = std::max(s.maxY, ty);
+  }
+
+  void addOther(const Shape &s) {
+    if (s.maxX < s.minX || s.maxY < s.minY || s.minEdge < kMinEdgePt)
+      return;
+    if (s.maxX - s.minX > kMaxShapePt || s.maxY - s.minY > kMaxShapePt)
+      return;
+    otherMarks.push_back(s);
+  }
+
+  void collect(GfxState *state) {
+    const GfxPath *path = state->getPath();
+    if (!path)
+      return;
+    const auto &ctm = state->getCTM();
+
+    for (int i = 0; i < path->getNumSubpaths(); i++) {
+      const GfxSubpath *subpath = path->getSubpath(i);
+      int n = subpath->getNumPoints();
+      if (n < 2)
+        continue;
+
+      Shape s = emptyShape();
+      bool ok = n >= 4;
+      double px = 0, py = 0;
+      for (int j = 0; j <= n; j++) {
+        int k = j % n;
+        if (subpath->getCurve(k))
+          ok = false;
+        double x = subpath->getX(k), y = subpath->getY(k);
+        double tx = ctm[0] * x + ctm[2] * y + ctm[4];
+        double ty = ctm[1] * x + ctm[3] * y + ctm[5];
+        if (j > 0) {
+          double dx = std::abs(tx - px), dy = std::abs(ty - py);
+          if (dx > kAxisTol && dy > kAxisTol)
+            ok = false;
+          double len = std::max(dx, dy);
+          if (len >= kMinEdgePt)
+            s.minEdge = std::min(s.minEdge, len);
+        }
+        if (j < n)
+          extend(s, tx, ty);
+        px = tx;
+        py = ty;
+      }
+      if (!ok) {
+        // Curved or slanted: keep it as a mark of its own size.
+        s.minEdge = std::min(s.maxX - s.minX, s.maxY - s.minY);
+        addOther(s);
+        continue;
+      }
+      if (s.minEdge == std::numeric_limits<double>::max())
+        continue;
+      if (s.maxX - s.minX > kMaxShapePt || s.maxY - s.minY > kMaxShapePt)
+        continue;
+      shapes.push_back(s);
+    }
+  }
+
+  std::vector<Shape> shapes;
+  std::vector<Shape> otherMarks;
+};
+
+/// Find square-ish clusters of @p shapes.  Shapes join a cluster when they
+/// lie within two module widths of each other, which is enough to chain a
+/// code together through its finder and timing patterns.
+void clusterDataMatrixShapes(
+    const std::vector<DataMatrixCandidateOutputDev::Shape> &shapes,
+    bool filled, std::vector<DataMatrixCandidate> &out) {
+  if (shapes.empty())
+    return;
+
+  // Union-find over shapes, using a coarse grid so each shape is only
+  // compared with its neighbours.
+  std::vector<int> parent(shapes.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&](int i) {
+    while (parent[i] != i)
+      i = parent[i] = parent[parent[i]];
+    return i;
+  };
+
+  constexpr double kCell = 8.0;
+  std::map<std::pair<int, int>, std::vector<int>> grid;
+  for (int i = 0; i < static_cast<int>(shapes.size()); i++) {
+    const auto &s = shapes[i];
+    double tol = 2.0 * s.minEdge;
+    int cx0 = static_cast<int>(std::floor((s.minX - tol) / kCell));
+    int cx1 = static_cast<int>(std::floor((s.maxX + tol) / kCell));
+    int cy0 = static_cast<int>(std::floor((s.minY - tol) / kCell));
+    int cy1 = static_cast<int>(std::floor((s.maxY + tol) / kCell));
+    for (int cy = cy0; cy <= cy1; cy++) {
+      for (int cx = cx0; cx <= cx1; cx++) {
+        auto &cell = grid[{cx, cy}];
+        for (int j : cell) {
+          const auto &o = shapes[j];
+          if (s.minX - tol <= o.maxX && o.minX <= s.maxX + tol &&
+              s.minY - tol <= o.maxY && o.minY <= s.maxY + tol)
+            parent[find(i)] = find(j);
+        }
+        cell.push_back(i);
+      }
+    }
+  }
+
+  std::map<int, DataMatrixCandidate> clusters;
+  for (int i = 0; i < static_cast<int>(shapes.size()); i++) {
+    const auto &s = shapes[i];
+    auto it = clusters.find(find(i));
+    if (it == clusters.end()) {
+      clusters.emplace(find(i), DataMatrixCandidate{s.minX, s.minY, s.maxX,
+                                                    s.maxY, s.minEdge, 1,
+                                                    filled});
+      continue;
     }
-    return true;
-  } catch (const std::exception &e) {
-    errorMessage = std::string("writeContentRectPDF exception: ") + e.what();
-    return false;
+    auto &c = it->second;
+    c.minX = std::min(c.minX, s.minX);
+    c.minY = std::min(c.minY, s.minY);
+    c.maxX = std::max(c.maxX, s.maxX);
+    c.maxY = std::max(c.maxY, s.maxY);
+    c.modulePt = std::min(c.modulePt, s.minEdge);
+    c.shapes++;
+  }
+
+  // ECC200 symbols are 10x10 to 144x144 modules (rectangular ones down to
+  // 8x18), so both sides must span at least 8 modules and the aspect ratio
+  // stays within 1:4.
+  for (const auto &[root, c] : clusters) {
+    double w = c.maxX - c.minX, h = c.maxY - c.minY;
+    if (c.shapes < 4 || w > 144.0 || h > 144.0)
+      continue;
+    if (std::min(w, h) < 8.0 * c.modulePt || std::max(w, h) > 4.0 * std::min(w, h))
+      continue;
+    out.push_back(c);
+  }
+}
+
+/// Find DataMatrix-sized clusters of marks on @p pageNum: clusters of
+/// straight-edged filled shapes first, then clusters of the other marks
+/// (strokes, curves, glyphs).  Each group is sorted largest first.
+std::vector<DataMatrixCandidate> findDataMatrixCandidates(PDFDoc *doc,
+                                                          int pageNum) {
+  DataMatrixCandidateOutputDev dev;
+  timedDisplayPage(*doc, &dev, pageNum, 72.0, 0, true, false, false);
+
+  auto largestFirst = [](const DataMatrixCandidate &a,
+                         const DataMatrixCandidate &b) {
+    return (a.maxX - a.minX) * (a.maxY - a.minY) >
+           (b.maxX - b.minX) * (b.maxY - b.minY);
+  };
+  std::vector<DataMatrixCandidate> out;
+  clusterDataMatrixShapes(dev.getShapes(), true, out);
+  std::sort(out.begin(), out.end(), largestFirst);
+  size_t filledCount = out.size();
+  clusterDataMatrixShapes(dev.getOtherMarks(), false, out);
+  std::sort(out.begin() + filledCount, out.end(), largestFirst);
+  return out;
+}
+
+/// ZXing pixel format for a CV_8U Mat, or None if unsupported.  4-channel
+/// rasters (BGRA) are read in place as BGRX.
+ZXing::ImageFormat zxingFormat(const cv::Mat &m) {
+  if (m.depth() != CV_8U)
+    return ZXing::ImageFormat::None;
+  switch (m.channels()) {
+  case 1:
+    return ZXing::ImageFormat::Lum;
+  case 3:
+    return ZXing::ImageFormat::BGR;
+  case 4:
+    return ZXing::ImageFormat::BGRX;
+  default:
+    return ZXing::ImageFormat::None;
   }
 }
 
+/// Read barcodes from every raster in @p rasters in parallel (OpenCV's
+/// thread pool).  Slot i of the result holds the codes found in rasters[i].
+/// If @p fastOpts is given it is tried first and @p opts is only used for
+/// rasters where the fast pass finds nothing.
+std::vector<ZXing::Barcodes>
+readBarcodesParallel(const std::vector<cv::Mat> &rasters,
+                     const ZXing::ReaderOptions &opts,
+                     const ZXing::ReaderOptions *fastOpts = nullptr) {
+  std::vector<ZXing::Barcodes> found(rasters.size());
+  cv::parallel_for_(
+      cv::Range(0, static_cast<int>(rasters.size())),
+      [&](const cv::Range &range) {
+        for (int i = range.start; i < range.end; i++) {
+          const cv::Mat &m = rasters[i];
+          auto fmt = zxingFormat(m);
+          if (m.empty() || fmt == ZXing::ImageFormat::None)
+            continue;
+          ZXing::ImageView iv(m.data, m.cols, m.rows, fmt,
+                              static_cast<int>(m.step));
+          TraceSpan span("ZXing::ReadBarcodes", "zxing");
+          if (fastOpts)
+            found[i] = ZXing::ReadBarcodes(iv, *fastOpts);
+          if (found[i].empty())
+            found[i] = ZXing::ReadBarcodes(iv, opts);
+        }
+      });
+  return found;
+}
+
+} // anonymous namespace
+#endif // HAVE_ZXING
+
 OCRAnalysis::PDFElements
 OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
                                 double minLineLength,
                                 const std::string &imageOutputDir,
                                 bool renderContentRectPdf,
                                 const std::string &pairPdfPath) {
+  TraceSpan span("extractPDFElements", "ocr", pdfPath);
+  return extractPDFElementsImpl(pdfPath, minRectSize, minLineLength,
+                                imageOutputDir, renderContentRectPdf,
+                                pairPdfPath, false);
+}
+
+OCRAnalysis::PDFElements OCRAnalysis::extractPDFElementsImpl(
+    const std::string &pdfPath, double minRectSize, double minLineLength,
+    const std::string &imageOutputDir, bool renderContentRectPdf,
+    const std::string &pairPdfPath, bool contentRectOnly) {
   // NOTE: This function processes ONLY the first page of the PDF.
   // All sub-functions (text, images, rectangles, lines) are hardcoded to
   // page 1.  Multi-page PDFs are accepted but only page 1 is ever read.
@@ -1847,34 +2832,44 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
       return result;
     }
     if (totalPages > 1) {
-      std::cerr << "DEBUG: PDF has " << totalPages
-                << " pages â€” only page 1 will be processed." << std::endl;
+      OCR_DEBUG << "PDF has " << totalPages
+                << " pages â€” only page 1 will be processed.";
     }
   }
 
   auto startTime = std::chrono::high_resolution_clock::now();
+  ProfileRecorder recorder(result.profile);
+
+  // Per-document scratch arena for the working lists built below (font
+  // matches, line groupings, crop-mark candidates, OCR words).  Everything
+  // allocated from it is released in one shot when this call returns.
+  std::pmr::monotonic_buffer_resource scratch(kScratchArenaBytes);
 
   try {
     // Extract text as individual words (preserves exact positioning) from first
     // page
-    std::cerr << "DEBUG: Extracting text from first page..." << std::endl;
-    try {
-      OCRResult textResult =
-          extractTextFromPDF(pdfPath, PDFExtractionLevel::Word);
-      std::cerr << "DEBUG: Text extraction completed, success="
-                << textResult.success << std::endl;
-      if (textResult.success) {
-        result.fullText = textResult.fullText;
-        result.textLines = std::move(textResult.regions);
-        result.textLineCount = static_cast<int>(result.textLines.size());
-        result.hiddenTextLines = std::move(textResult.hiddenRegions);
-      } else {
-        std::cerr << "DEBUG: Text extraction failed: "
-                  << textResult.errorMessage << std::endl;
+    if (!contentRectOnly) {
+      OCR_DEBUG << "Extracting text from first page...";
+      ProfileRecorder::Stage stage("text");
+      try {
+        OCRResult textResult =
+            extractTextFromPDF(pdfPath, PDFExtractionLevel::Word);
+        stage.stop();
+        result.profile.merge(textResult.profile, "text");
+        OCR_DEBUG << "Text extraction completed, success="
+                  << textResult.success;
+        if (textResult.success) {
+          result.fullText = textResult.fullText;
+          result.textLines = std::move(textResult.regions);
+          result.textLineCount = static_cast<int>(result.textLines.size());
+          result.hiddenTextLines = std::move(textResult.hiddenRegions);
+        } else {
+          OCR_DEBUG << "Text extraction failed: "
+                    << textResult.errorMessage;
+        }
+      } catch (const std::exception &e) {
+        OCR_DEBUG << "Text extraction threw exception: " << e.what();
       }
-    } catch (const std::exception &e) {
-      std::cerr << "DEBUG: Text extraction threw exception: " << e.what()
-                << std::endl;
     }
 
     // Enrich font names using Poppler's internal TextOutputDev, which provides
@@ -1882,8 +2877,9 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
     // font descriptor bits.  The C++ text_list() API returns "*ignored*" for
     // most PDFs, so this is the only reliable source of font identity.
     if (!result.textLines.empty()) {
+      ProfileRecorder::Stage stage("fonts");
       try {
-        GlobalParamsIniter gpi(nullptr);
+        GlobalParamsIniter gpi(popplerErrorToLog);
         auto gooFile = std::make_unique<GooString>(pdfPath);
         std::unique_ptr<PDFDoc> fontDoc(new PDFDoc(std::move(gooFile)));
         if (fontDoc->isOk() && fontDoc->getNumPages() >= 1) {
@@ -1901,7 +2897,7 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
             dispH_font = mb->y2 - mb->y1;
 
           TextOutputDev textOut(nullptr, true, 0, false, false);
-          fontDoc->displayPage(&textOut, 1, 72, 72, 0, false, true, false);
+          timedDisplayPage(*fontDoc, &textOut, 1, 72, 0, false, true, false);
           TextPage *textPage = textOut.takeText();
 
           // Collect per-word font entries.
@@ -1913,7 +2909,7 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
             bool isBold = false, isItalic = false;
             double xMin = 0, yBottom = 0, xMax = 0, yTop = 0;
           };
-          std::vector<WordFontEntry> wordFonts;
+          std::pmr::vector<WordFontEntry> wordFonts(&scratch);
 
           for (const TextFlow *flow = textPage->getFlows(); flow;
                flow = flow->getNext()) {
@@ -1983,7 +2979,7 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
           }
         }
       } catch (const std::exception &e) {
-        std::cerr << "DEBUG: Font enrichment failed: " << e.what() << std::endl;
+        OCR_DEBUG << "Font enrichment failed: " << e.what();
       }
     }
 
@@ -2008,206 +3004,356 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
     }
 
     // Extract embedded images from first page
-    std::cerr << "DEBUG: Extracting embedded images from first page..."
-              << std::endl;
-    try {
-      PDFEmbeddedImagesResult imageResult =
-          extractEmbeddedImagesFromPDF(pdfPath);
-      std::cerr << "DEBUG: Image extraction completed" << std::endl;
-      if (imageResult.success) {
-        result.images = std::move(imageResult.images);
-        result.imageCount = static_cast<int>(result.images.size());
+    if (!contentRectOnly) {
+      OCR_DEBUG << "Extracting embedded images from first page...";
+      ProfileRecorder::Stage stage("images");
+      try {
+        PDFEmbeddedImagesResult imageResult =
+            extractEmbeddedImagesFromPDF(pdfPath);
+        OCR_DEBUG << "Image extraction completed";
+        if (imageResult.success) {
+          result.images = std::move(imageResult.images);
+          result.imageCount = static_cast<int>(result.images.size());
+        }
+      } catch (const std::exception &e) {
+        OCR_DEBUG << "Image extraction threw exception: " << e.what();
       }
-    } catch (const std::exception &e) {
-      std::cerr << "DEBUG: Image extraction threw exception: " << e.what()
-                << std::endl;
     }
 
     // Scan for DataMatrix barcodes
 #ifdef HAVE_ZXING
-    std::cerr << "DEBUG: Scanning for DataMatrix barcodes..." << std::endl;
-    try {
-      ZXing::ReaderOptions opts;
-      opts.setFormats(ZXing::BarcodeFormat::DataMatrix);
-      opts.setTryHarder(true);
-      opts.setTryRotate(true);
-
-      // Strategy 1: Scan each embedded image
-      for (size_t imgIdx = 0; imgIdx < result.images.size(); imgIdx++) {
-        const auto &pdfImage = result.images[imgIdx];
-        if (pdfImage.image.empty())
-          continue;
+    if (!contentRectOnly) {
+      OCR_DEBUG << "Scanning for DataMatrix barcodes...";
+      try {
+        ZXing::ReaderOptions opts;
+        opts.setFormats(ZXing::BarcodeFormat::DataMatrix);
+        opts.setTryHarder(true);
+        opts.setTryRotate(true);
+
+        // A code counts as already found if it covers more than 30% of an
+        // existing one (dedup by position overlap)
+        auto isDuplicateCode = [&](double x, double y, double w, double h) {
+          for (const auto &existing : result.dataMatrices) {
+            double overlapX = std::max(
+                0.0, std::min(existing.x + existing.width, x + w) -
+                         std::max(existing.x, x));
+            double overlapY = std::max(
+                0.0, std::min(existing.y + existing.height, y + h) -
+                         std::max(existing.y, y));
+            double overlapArea = overlapX * overlapY;
+            double existingArea = existing.width * existing.height;
+            if (existingArea > 0 && overlapArea / existingArea > 0.3)
+              return true;
+          }
+          return false;
+        };
+
+        // Strategy 1: Scan the embedded images in parallel (BGRA images are
+        // read in place), then merge in image order
+        ProfileRecorder::Stage strategy1Stage("dataMatrix1");
+        std::vector<cv::Mat> imageRasters;
+        imageRasters.reserve(result.images.size());
+        for (const auto &pdfImage : result.images)
+          imageRasters.push_back(pdfImage.image);
+        auto imageBarcodes = readBarcodesParallel(imageRasters, opts);
+
+        for (size_t imgIdx = 0; imgIdx < result.images.size(); imgIdx++) {
+          const auto &pdfImage = result.images[imgIdx];
+          double scaleX = pdfImage.displayWidth / pdfImage.image.cols;
+          double scaleY = pdfImage.displayHeight / pdfImage.image.rows;
+
+          for (const auto &bc : imageBarcodes[imgIdx]) {
+            auto pos = bc.position();
+            int pxMinX =
+                std::max(0, std::min({pos[0].x, pos[1].x, pos[2].x, pos[3].x}));
+            int pxMinY =
+                std::max(0, std::min({pos[0].y, pos[1].y, pos[2].y, pos[3].y}));
+            int pxMaxX = std::min(pdfImage.image.cols,
+                                  std::max({pos[0].x, pos[1].x, pos[2].x, pos[3].x}));
+            int pxMaxY = std::min(pdfImage.image.rows,
+                                  std::max({pos[0].y, pos[1].y, pos[2].y, pos[3].y}));
+
+            if (isDuplicateCode(pdfImage.x + pxMinX * scaleX,
+                                pdfImage.y + pxMinY * scaleY,
+                                (pxMaxX - pxMinX) * scaleX,
+                                (pxMaxY - pxMinY) * scaleY))
+              continue;
 
-        cv::Mat scanImg;
-        if (pdfImage.image.channels() == 4) {
-          cv::cvtColor(pdfImage.image, scanImg, cv::COLOR_BGRA2BGR);
-        } else {
-          scanImg = pdfImage.image;
-        }
+            PDFDataMatrix dm;
+            dm.text = bc.text();
+            dm.x = pdfImage.x + pxMinX * scaleX;
+            dm.y = pdfImage.y + pxMinY * scaleY;
+            dm.width = (pxMaxX - pxMinX) * scaleX;
+            dm.height = (pxMaxY - pxMinY) * scaleY;
+            dm.sourceImageIndex = static_cast<int>(imgIdx);
+
+            int cropW = pxMaxX - pxMinX;
+            int cropH = pxMaxY - pxMinY;
+            if (cropW > 0 && cropH > 0) {
+              dm.image =
+                  pdfImage.image(cv::Rect(pxMinX, pxMinY, cropW, cropH)).clone();
+            }
 
-        auto fmt = ZXing::ImageFormat::None;
-        switch (scanImg.channels()) {
-        case 1:
-          fmt = ZXing::ImageFormat::Lum;
-          break;
-        case 3:
-          fmt = ZXing::ImageFormat::BGR;
-          break;
-        default:
-          continue;
+            OCR_DEBUG << "DataMatrix in image " << imgIdx << ": \""
+                      << dm.text.substr(0, 30) << "\" at PDF (" << dm.x << ", "
+                      << dm.y << ") size " << dm.width << "x" << dm.height;
+            result.dataMatrices.push_back(std::move(dm));
+          }
         }
 
-        ZXing::ImageView iv(scanImg.data, scanImg.cols, scanImg.rows, fmt);
-        auto barcodes = ZXing::ReadBarcodes(iv, opts);
-
-        double scaleX = pdfImage.displayWidth / pdfImage.image.cols;
-        double scaleY = pdfImage.displayHeight / pdfImage.image.rows;
-
-        for (const auto &bc : barcodes) {
-          auto pos = bc.position();
-          int pxMinX =
-              std::max(0, std::min({pos[0].x, pos[1].x, pos[2].x, pos[3].x}));
-          int pxMinY =
-              std::max(0, std::min({pos[0].y, pos[1].y, pos[2].y, pos[3].y}));
-          int pxMaxX = std::min(
-              scanImg.cols, std::max({pos[0].x, pos[1].x, pos[2].x, pos[3].x}));
-          int pxMaxY = std::min(
-              scanImg.rows, std::max({pos[0].y, pos[1].y, pos[2].y, pos[3].y}));
-
-          PDFDataMatrix dm;
-          dm.text = bc.text();
-          dm.x = pdfImage.x + pxMinX * scaleX;
-          dm.y = pdfImage.y + pxMinY * scaleY;
-          dm.width = (pxMaxX - pxMinX) * scaleX;
-          dm.height = (pxMaxY - pxMinY) * scaleY;
-          dm.sourceImageIndex = static_cast<int>(imgIdx);
-
-          int cropW = pxMaxX - pxMinX;
-          int cropH = pxMaxY - pxMinY;
-          if (cropW > 0 && cropH > 0) {
-            dm.image =
-                pdfImage.image(cv::Rect(pxMinX, pxMinY, cropW, cropH)).clone();
-          }
+        strategy1Stage.stop();
+
+        // Strategy 2: vector-drawn DataMatrix codes that won't appear as
+        // embedded images.  Clusters of small filled shapes are rendered
+        // one by one at ~4 px per module and scanned with a fast pass first;
+        // clusters of strokes, curves and glyphs that no decoded code
+        // explains are then scanned the same way at a higher resolution.
+        // The full-page 600 DPI scan only runs when the targeted scan is
+        // off or cannot be used, or when OCRConfig::fullPageDataMatrixScan
+        // asks for it.
+        ProfileRecorder::Stage strategy2Stage("dataMatrix2");
+        try {
+          GlobalParamsIniter gpi(popplerErrorToLog);
+          auto gooFile = std::make_unique<GooString>(pdfPath);
+          std::unique_ptr<PDFDoc> doc(new PDFDoc(std::move(gooFile)));
+          if (doc && doc->isOk() && doc->getNumPages() > 0) {
+            const ::PDFRectangle *cropBox = doc->getPage(1)->getCropBox();
+
+            // Record a code read from a page raster at pxPerPt pixels per
+            // point, where (offX, offY) is the raster's top-left pixel in
+            // the full-page render.  Returns false for a duplicate.
+            auto addPageCode = [&](const ZXing::Barcode &bc,
+                                   const cv::Mat &raster, int offX, int offY,
+                                   double pxPerPt) {
+              auto pos = bc.position();
+              int rMinX = std::max(
+                  0, std::min({pos[0].x, pos[1].x, pos[2].x, pos[3].x}));
+              int rMinY = std::max(
+                  0, std::min({pos[0].y, pos[1].y, pos[2].y, pos[3].y}));
+              int rMaxX = std::min(
+                  raster.cols, std::max({pos[0].x, pos[1].x, pos[2].x, pos[3].x}));
+              int rMaxY = std::min(
+                  raster.rows, std::max({pos[0].y, pos[1].y, pos[2].y, pos[3].y}));
+
+              double pdfX = cropBox->x1 + (offX + rMinX) / pxPerPt;
+              double pdfY = cropBox->y1 + (offY + rMinY) / pxPerPt;
+              double pdfW = (rMaxX - rMinX) / pxPerPt;
+              double pdfH = (rMaxY - rMinY) / pxPerPt;
+
+              // Check if this barcode was already found in an embedded image
+              // or another raster
+              if (isDuplicateCode(pdfX, pdfY, pdfW, pdfH))
+                return false;
+
+              PDFDataMatrix dm;
+              dm.text = bc.text();
+              dm.x = pdfX;
+              dm.y = pdfY;
+              dm.width = pdfW;
+              dm.height = pdfH;
+              dm.sourceImageIndex = -1; // from rasterised page
+
+              int cropW = rMaxX - rMinX;
+              int cropH = rMaxY - rMinY;
+              if (cropW > 0 && cropH > 0) {
+                // The raster is reused for the next slice; keep a copy.
+                dm.image =
+                    raster(cv::Rect(rMinX, rMinY, cropW, cropH)).clone();
+              }
 
-          std::cerr << "DEBUG: DataMatrix in image " << imgIdx << ": \""
-                    << dm.text.substr(0, 30) << "\" at PDF (" << dm.x << ", "
-                    << dm.y << ") size " << dm.width << "x" << dm.height
-                    << std::endl;
-          result.dataMatrices.push_back(std::move(dm));
-        }
-      }
+              OCR_DEBUG << "DataMatrix in rasterised page: \""
+                        << dm.text.substr(0, 30) << "\" at PDF (" << dm.x
+                        << ", " << dm.y << ") size " << dm.width << "x"
+                        << dm.height;
+              result.dataMatrices.push_back(std::move(dm));
+              return true;
+            };
 
-      // Strategy 2: Rasterise the full page and scan for vector-drawn
-      // DataMatrix codes that won't appear as embedded images
-      std::cerr << "DEBUG: Rasterising page for vector DataMatrix detection..."
-                << std::endl;
-      try {
-        std::unique_ptr<poppler::document> doc(
-            poppler::document::load_from_file(pdfPath));
-        if (doc && doc->pages() > 0) {
-          std::unique_ptr<poppler::page> page(doc->create_page(0));
-          if (page) {
-            poppler::page_renderer renderer;
-            renderer.set_render_hint(poppler::page_renderer::antialiasing,
-                                     true);
-            renderer.set_render_hint(poppler::page_renderer::text_antialiasing,
-                                     true);
-            renderer.set_image_format(poppler::image::format_argb32);
-
-            // Render at 600 DPI for reliable barcode detection
-            const double scanDpi = 600.0;
-            poppler::image popplerImg =
-                renderer.render_page(page.get(), scanDpi, scanDpi);
-
-            if (popplerImg.is_valid()) {
-              int w = popplerImg.width();
-              int h = popplerImg.height();
-              cv::Mat pageMat(h, w, CV_8UC4,
-                              const_cast<char *>(popplerImg.const_data()),
-                              popplerImg.bytes_per_row());
-              cv::Mat pageBGR;
-              cv::cvtColor(pageMat, pageBGR, cv::COLOR_BGRA2BGR);
-
-              ZXing::ImageView pageIV(pageBGR.data, pageBGR.cols, pageBGR.rows,
-                                      ZXing::ImageFormat::BGR);
-              auto pageBarcodes = ZXing::ReadBarcodes(pageIV, opts);
-
-              // Scale from raster pixels to PDF points
-              poppler::rectf pageRect = page->page_rect();
-              double pixToPtX = pageRect.width() / w;
-              double pixToPtY = pageRect.height() / h;
-
-              for (const auto &bc : pageBarcodes) {
-                auto pos = bc.position();
-                int pxMinX = std::max(
-                    0, std::min({pos[0].x, pos[1].x, pos[2].x, pos[3].x}));
-                int pxMinY = std::max(
-                    0, std::min({pos[0].y, pos[1].y, pos[2].y, pos[3].y}));
-                int pxMaxX = std::min(
-                    w, std::max({pos[0].x, pos[1].x, pos[2].x, pos[3].x}));
-                int pxMaxY = std::min(
-                    h, std::max({pos[0].y, pos[1].y, pos[2].y, pos[3].y}));
-
-                double pdfX = pageRect.x() + pxMinX * pixToPtX;
-                double pdfY = pageRect.y() + pxMinY * pixToPtY;
-                double pdfW = (pxMaxX - pxMinX) * pixToPtX;
-                double pdfH = (pxMaxY - pxMinY) * pixToPtY;
-
-                // Check if this barcode was already found in an embedded image
-                // (dedup by position overlap)
-                bool isDuplicate = false;
-                for (const auto &existing : result.dataMatrices) {
-                  double overlapX = std::max(
-                      0.0, std::min(existing.x + existing.width, pdfX + pdfW) -
-                               std::max(existing.x, pdfX));
-                  double overlapY = std::max(
-                      0.0, std::min(existing.y + existing.height, pdfY + pdfH) -
-                               std::max(existing.y, pdfY));
-                  double overlapArea = overlapX * overlapY;
-                  double existingArea = existing.width * existing.height;
-                  if (existingArea > 0 && overlapArea / existingArea > 0.3) {
-                    isDuplicate = true;
-                    break;
-                  }
-                }
+            // Targeted scan of geometry candidates.  Candidate boxes are in
+            // media-box-relative y-up points, so it is limited to unrotated
+            // pages where that maps directly onto the crop-box raster.
+            bool targeted = m_config.targetedDataMatrixScan &&
+                            doc->getPageRotate(1) == 0;
+            int targetedHits = 0;
+            if (targeted) {
+              auto candidates = findDataMatrixCandidates(doc.get(), 1);
+
+              ZXing::ReaderOptions fastOpts = opts;
+              fastOpts.setTryHarder(false);
+              fastOpts.setTryRotate(false);
+
+              int pageW = 0, pageH = 0;
+              const ::PDFRectangle *mediaBox = doc->getPage(1)->getMediaBox();
+              SplashColor white = {255, 255, 255};
+              SplashOutputDev splashOut(splashModeBGR8, 4, false, white);
+              splashOut.setFontAntialias(true);
+              splashOut.setVectorAntialias(true);
+              splashOut.startDoc(doc.get());
+
+              // Crop-box-relative, y-down page rect of candidate @p c grown
+              // by @p margin points: the space addPageCode reports codes in.
+              auto candidateRect = [&](const DataMatrixCandidate &c,
+                                       double margin) {
+                return cv::Rect2d(
+                    mediaBox->x1 + c.minX - margin - cropBox->x1,
+                    cropBox->y2 - (mediaBox->y1 + c.maxY + margin),
+                    c.maxX - c.minX + 2.0 * margin,
+                    c.maxY - c.minY + 2.0 * margin);
+              };
 
-                if (!isDuplicate) {
-                  PDFDataMatrix dm;
-                  dm.text = bc.text();
-                  dm.x = pdfX;
-                  dm.y = pdfY;
-                  dm.width = pdfW;
-                  dm.height = pdfH;
-                  dm.sourceImageIndex = -1; // from rasterised page
-
-                  int cropW = pxMaxX - pxMinX;
-                  int cropH = pxMaxY - pxMinY;
-                  if (cropW > 0 && cropH > 0) {
-                    dm.image =
-                        pageBGR(cv::Rect(pxMinX, pxMinY, cropW, cropH)).clone();
-                  }
+              // Render each of @p group at @p pxPerModule pixels per
+              // estimated module plus a two-module quiet zone.  Poppler
+              // renders one crop at a time; the crops are then scanned in
+              // parallel and merged in candidate order.
+              auto scanCandidates =
+                  [&](const std::vector<DataMatrixCandidate> &group,
+                      double pxPerModule) {
+                    struct CandidateCrop {
+                      int sx, sy;
+                      double pxPerPt;
+                    };
+                    std::vector<CandidateCrop> crops;
+                    std::vector<cv::Mat> cropRasters;
+
+                    for (const auto &c : group) {
+                      double dpi = std::clamp(
+                          pxPerModule * 72.0 / c.modulePt, 72.0, 600.0);
+                      double s = dpi / 72.0;
+                      cv::Rect2d r = candidateRect(c, 2.0 * c.modulePt + 1.0);
+                      renderedPageSize(doc.get(), 1, dpi, pageW, pageH);
+                      int sx = std::max(0, static_cast<int>(std::floor(r.x * s)));
+                      int sy = std::max(0, static_cast<int>(std::floor(r.y * s)));
+                      int ex = std::min(
+                          pageW, static_cast<int>(std::ceil(r.br().x * s)));
+                      int ey = std::min(
+                          pageH, static_cast<int>(std::ceil(r.br().y * s)));
+                      if (ex <= sx || ey <= sy)
+                        continue;
+
+                      timedDisplayPageSlice(*doc, &splashOut, 1, dpi, 0, false,
+                                            true, false, sx, sy, ex - sx,
+                                            ey - sy);
+                      // The bitmap is reused for the next slice; keep a copy.
+                      cv::Mat crop =
+                          splashBitmapView(splashOut.getBitmap()).clone();
+                      if (crop.empty())
+                        continue;
+                      crops.push_back({sx, sy, s});
+                      cropRasters.push_back(std::move(crop));
+                    }
 
-                  std::cerr << "DEBUG: DataMatrix in rasterised page: \""
-                            << dm.text.substr(0, 30) << "\" at PDF (" << dm.x
-                            << ", " << dm.y << ") size " << dm.width << "x"
-                            << dm.height << std::endl;
-                  result.dataMatrices.push_back(std::move(dm));
-                }
+                    auto cropBarcodes =
+                        readBarcodesParallel(cropRasters, opts, &fastOpts);
+                    for (size_t i = 0; i < crops.size(); i++)
+                      for (const auto &bc : cropBarcodes[i])
+                        if (addPageCode(bc, cropRasters[i], crops[i].sx,
+                                        crops[i].sy, crops[i].pxPerPt))
+                          targetedHits++;
+                  };
+
+              std::vector<DataMatrixCandidate> filled, other;
+              for (const auto &c : candidates)
+                (c.filled ? filled : other).push_back(c);
+
+              // Filled shapes have exact module edges: ~4 px per module.
+              scanCandidates(filled, 4.0);
+
+              // Marks inside a code that has already been read are
+              // explained; scan the remaining clusters at ~8 px per guessed
+              // module, since the guess can be off by a few modules' worth.
+              std::vector<DataMatrixCandidate> unexplained;
+              for (const auto &c : other) {
+                cv::Rect2d r = candidateRect(c, 0.0);
+                bool explained = std::any_of(
+                    result.dataMatrices.begin(), result.dataMatrices.end(),
+                    [&](const PDFDataMatrix &dm) {
+                      return dm.sourceImageIndex == -1 &&
+                             (r & cv::Rect2d(dm.x - cropBox->x1,
+                                             dm.y - cropBox->y1, dm.width,
+                                             dm.height))
+                                     .area() > 0.5 * r.area();
+                    });
+                if (!explained)
+                  unexplained.push_back(c);
+              }
+              OCR_DEBUG << "" << filled.size() << " filled and "
+                        << unexplained.size()
+                        << " other vector DataMatrix candidate(s) scanned";
+              scanCandidates(unexplained, 8.0);
+            }
+
+            // Full-page scan: render at 600 DPI in bands bounded by
+            // OCRConfig::rasterMemoryBudget, and split each band into
+            // column tiles that are scanned in parallel.  Bands and tiles
+            // overlap by 1.5 in so any label DataMatrix lies wholly inside
+            // one tile; a code seen twice is dropped by the overlap dedup.
+            // Codes the targeted pass read are blanked out of the raster
+            // so they are not decoded again.
+            if (!targeted || m_config.fullPageDataMatrixScan) {
+              OCR_DEBUG << "Rasterising page for vector DataMatrix detection ("
+                        << targetedHits << " code(s) from candidates)...";
+              const double scanDpi = 600.0;
+              const double scanScale = scanDpi / 72.0;
+              const int bandOverlapPx = static_cast<int>(1.5 * scanDpi);
+              const int tileWidthPx = static_cast<int>(4.0 * scanDpi);
+
+              // Page-raster codes found so far, in 600 DPI page pixels,
+              // grown by one point so the blanking covers anti-aliasing.
+              std::vector<cv::Rect> knownCodes;
+              for (const auto &dm : result.dataMatrices) {
+                if (dm.sourceImageIndex != -1)
+                  continue;
+                knownCodes.emplace_back(
+                    static_cast<int>(
+                        std::floor((dm.x - cropBox->x1 - 1.0) * scanScale)),
+                    static_cast<int>(
+                        std::floor((dm.y - cropBox->y1 - 1.0) * scanScale)),
+                    static_cast<int>(std::ceil((dm.width + 2.0) * scanScale)),
+                    static_cast<int>(
+                        std::ceil((dm.height + 2.0) * scanScale)));
               }
+
+              forEachPageBand(
+                  doc.get(), 1, scanDpi, m_config.rasterMemoryBudget,
+                  bandOverlapPx, true, [&](cv::Mat &band, int top) {
+                    cv::Rect bandRect(0, 0, band.cols, band.rows);
+                    for (const auto &known : knownCodes) {
+                      cv::Rect r = (known - cv::Point(0, top)) & bandRect;
+                      if (!r.empty())
+                        band(r).setTo(cv::Scalar::all(255));
+                    }
+
+                    // Tiles are views into the band, not copies.
+                    std::vector<int> tileX;
+                    std::vector<cv::Mat> tiles;
+                    for (int x = 0;; x += tileWidthPx - bandOverlapPx) {
+                      int w = std::min(tileWidthPx, band.cols - x);
+                      tileX.push_back(x);
+                      tiles.push_back(band(cv::Rect(x, 0, w, band.rows)));
+                      if (x + w >= band.cols)
+                        break;
+                    }
+                    auto tileBarcodes = readBarcodesParallel(tiles, opts);
+                    for (size_t i = 0; i < tiles.size(); i++)
+                      for (const auto &bc : tileBarcodes[i])
+                        addPageCode(bc, tiles[i], tileX[i], top,
+                                    scanDpi / 72.0);
+                    return true;
+                  });
             }
           }
+        } catch (const std::exception &e) {
+          OCR_DEBUG << "Page rasterisation for DataMatrix failed: "
+                    << e.what();
         }
+        strategy2Stage.stop();
+
+        result.dataMatrixCount = static_cast<int>(result.dataMatrices.size());
+        OCR_DEBUG << "Total DataMatrix barcodes found: "
+                  << result.dataMatrixCount;
       } catch (const std::exception &e) {
-        std::cerr << "DEBUG: Page rasterisation for DataMatrix failed: "
-                  << e.what() << std::endl;
+        OCR_DEBUG << "DataMatrix scanning threw exception: " << e.what();
       }
-
-      result.dataMatrixCount = static_cast<int>(result.dataMatrices.size());
-      std::cerr << "DEBUG: Total DataMatrix barcodes found: "
-                << result.dataMatrixCount << std::endl;
-    } catch (const std::exception &e) {
-      std::cerr << "DEBUG: DataMatrix scanning threw exception: " << e.what()
-                << std::endl;
     }
 #endif // HAVE_ZXING
 
@@ -2228,13 +3374,13 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
             std::string filename = (outDir / (pdfStem + "_image_" +
                                               std::to_string(i + 1) + ".png"))
                                        .string();
-            if (cv::imwrite(filename, img.image)) {
-              std::cerr << "DEBUG: Saved image " << (i + 1) << " ("
+            if (writeReturnedImage(filename, img.image)) {
+              OCR_DEBUG << "Saved image " << (i + 1) << " ("
                         << img.image.cols << "x" << img.image.rows
-                        << ") to: " << filename << std::endl;
+                        << ") to: " << filename;
             } else {
-              std::cerr << "DEBUG: Failed to save image " << (i + 1)
-                        << " to: " << filename << std::endl;
+              OCR_DEBUG << "Failed to save image " << (i + 1)
+                        << " to: " << filename;
             }
           }
         }
@@ -2246,45 +3392,48 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
             std::string filename = (outDir / (pdfStem + "_datamatrix_" +
                                               std::to_string(i + 1) + ".png"))
                                        .string();
-            if (cv::imwrite(filename, dm.image)) {
-              std::cerr << "DEBUG: Saved DataMatrix " << (i + 1) << " (\""
-                        << dm.text.substr(0, 30) << "\") to: " << filename
-                        << std::endl;
+            if (writeReturnedImage(filename, dm.image)) {
+              OCR_DEBUG << "Saved DataMatrix " << (i + 1) << " (\""
+                        << dm.text.substr(0, 30) << "\") to: " << filename;
             } else {
-              std::cerr << "DEBUG: Failed to save DataMatrix " << (i + 1)
-                        << " to: " << filename << std::endl;
+              OCR_DEBUG << "Failed to save DataMatrix " << (i + 1)
+                        << " to: " << filename;
             }
           }
         }
       } catch (const std::exception &e) {
-        std::cerr << "DEBUG: Failed to save images: " << e.what() << std::endl;
+        OCR_DEBUG << "Failed to save images: " << e.what();
       }
     }
 
     // Extract rectangles from first page
-    std::cerr << "DEBUG: Extracting rectangles from first page..." << std::endl;
+    OCR_DEBUG << "Extracting rectangles from first page...";
+    ProfileRecorder::Stage rectsStage("rects");
     try {
       PDFRectanglesResult rectResult =
           extractRectanglesFromPDF(pdfPath, minRectSize);
-      std::cerr << "DEBUG: Rectangle extraction completed" << std::endl;
+      OCR_DEBUG << "Rectangle extraction completed";
       if (rectResult.success) {
         result.rectangles = std::move(rectResult.rectangles);
         result.rectangleCount = static_cast<int>(result.rectangles.size());
       }
     } catch (const std::exception &e) {
-      std::cerr << "DEBUG: Rectangle extraction threw exception: " << e.what()
-                << std::endl;
+      OCR_DEBUG << "Rectangle extraction threw exception: " << e.what();
     }
+    rectsStage.stop();
 
-    // Extract drawn lines (vector graphics) from first page
-    std::cerr << "DEBUG: Extracting lines from first page..." << std::endl;
+    // Extract drawn lines (vector graphics) from first page, then rebuild
+    // rectangles and crop marks from them
+    OCR_DEBUG << "Extracting lines from first page...";
+    ProfileRecorder::Stage linesStage("lines");
     try {
       PDFLinesResult lineResult = extractLinesFromPDF(pdfPath, minLineLength);
-      std::cerr << "DEBUG: Line extraction completed" << std::endl;
+      OCR_DEBUG << "Line extraction completed";
       if (lineResult.success) {
         // First, detect rectangles formed by 4 lines
         // Group horizontal and vertical lines
-        std::vector<PDFLine> horizontalLines, verticalLines;
+        std::pmr::vector<PDFLine> horizontalLines(&scratch);
+        std::pmr::vector<PDFLine> verticalLines(&scratch);
         const double parallelTolerance = 2.0;
 
         for (const auto &line : lineResult.lines) {
@@ -2295,9 +3444,9 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
           }
         }
 
-        std::cerr << "DEBUG: Found " << horizontalLines.size()
+        OCR_DEBUG << "Found " << horizontalLines.size()
                   << " horizontal lines, " << verticalLines.size()
-                  << " vertical lines" << std::endl;
+                  << " vertical lines";
 
         // Simple case: if we have exactly 2 horizontal and 2 vertical lines,
         // they likely form a rectangle
@@ -2331,9 +3480,9 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
             rect.lineWidth = 1.0;
 
             result.rectangles.push_back(rect);
-            std::cerr << "DEBUG: Detected rectangle from 4 lines at (" << rect.x
+            OCR_DEBUG << "Detected rectangle from 4 lines at (" << rect.x
                       << ", " << rect.y << ") size: " << rect.width << "x"
-                      << rect.height << std::endl;
+                      << rect.height;
           }
         }
 
@@ -2421,10 +3570,9 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
 
                   if (!isDuplicate) {
                     result.rectangles.push_back(rect);
-                    std::cerr << "DEBUG: Detected rectangle from lines at ("
+                    OCR_DEBUG << "Detected rectangle from lines at ("
                               << rect.x << ", " << rect.y
-                              << ") size: " << rect.width << "x" << rect.height
-                              << std::endl;
+                              << ") size: " << rect.width << "x" << rect.height;
                   }
                 }
               }
@@ -2499,9 +3647,9 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
           }
         }
 
-        std::cerr << "DEBUG: Filtered "
+        OCR_DEBUG << "Filtered "
                   << (lineResult.lines.size() - filteredLines.size())
-                  << " lines that are part of rectangles" << std::endl;
+                  << " lines that are part of rectangles";
 
         result.graphicLines = std::move(filteredLines);
         result.graphicLineCount = static_cast<int>(result.graphicLines.size());
@@ -2510,15 +3658,14 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
         // (only if we don't already have a linesBoundingBox from TrimBox)
         if (result.linesBoundingBoxWidth > 0 &&
             result.linesBoundingBoxHeight > 0) {
-          std::cerr << "DEBUG: Skipping crop mark detection â€” using TrimBox"
-                    << std::endl;
+          OCR_DEBUG << "Skipping crop mark detection â€” using TrimBox";
         } else {
 
-          std::vector<std::pair<double, double>> cropMarkCorners;
+          std::pmr::vector<std::pair<double, double>> cropMarkCorners(&scratch);
 
           // Find short horizontal and vertical lines
-          std::vector<PDFLine> horizontalCropLines;
-          std::vector<PDFLine> verticalCropLines;
+          std::pmr::vector<PDFLine> horizontalCropLines(&scratch);
+          std::pmr::vector<PDFLine> verticalCropLines(&scratch);
 
           const double cropMarkMaxLength = 30.0;
           const double cropMarkMinLength = 10.0;
@@ -2549,7 +3696,7 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
             const double gridTolerance = 3.0;
 
             // Step 1: Group horizontal lines by Y coordinate
-            std::map<double, std::vector<int>> hLinesByY;
+            std::pmr::map<double, std::pmr::vector<int>> hLinesByY(&scratch);
             for (size_t i = 0; i < horizontalCropLines.size(); i++) {
               double y =
                   (horizontalCropLines[i].y1 + horizontalCropLines[i].y2) / 2.0;
@@ -2568,13 +3715,13 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
 
             // Step 2: Identify bleed-mark Y-bands (groups with >4 lines)
             const int maxGroupSize = 4;
-            std::set<int> hLinesToRemove;
+            std::pmr::set<int> hLinesToRemove(&scratch);
             // Collect the Y-band ranges from bleed-mark rows
             struct YBand {
               double minY, maxY;
               double minX = 0, maxX = 0; // interior X range of bleed marks
             };
-            std::vector<YBand> bleedBands;
+            std::pmr::vector<YBand> bleedBands(&scratch);
 
             for (const auto &[y, indices] : hLinesByY) {
               if (static_cast<int>(indices.size()) > maxGroupSize) {
@@ -2635,11 +3782,11 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
                 bleedBands.back().minX = leftEdge;
                 bleedBands.back().maxX = rightEdge;
 
-                std::cerr << "DEBUG: Bleed mark Y-band: " << bandMinY << " to "
+                OCR_DEBUG << "Bleed mark Y-band: " << bandMinY << " to "
                           << bandMaxY << ", X interior: " << leftEdge << " to "
                           << rightEdge << " (" << indices.size()
                           << " horizontal lines, " << hLinesToRemove.size()
-                          << " marked)" << std::endl;
+                          << " marked)";
               }
             }
 
@@ -2651,7 +3798,7 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
                         [](const YBand &a, const YBand &b) {
                           return a.minY < b.minY;
                         });
-              std::vector<YBand> merged;
+              std::pmr::vector<YBand> merged(&scratch);
               merged.push_back(bleedBands[0]);
               for (size_t i = 1; i < bleedBands.size(); i++) {
                 // Merge if gap between bands is less than box height
@@ -2672,13 +3819,13 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
             }
 
             for (const auto &band : bleedBands) {
-              std::cerr << "DEBUG: Merged bleed Y-band: Y=" << band.minY
+              OCR_DEBUG << "Merged bleed Y-band: Y=" << band.minY
                         << " to " << band.maxY << ", X interior=" << band.minX
-                        << " to " << band.maxX << std::endl;
+                        << " to " << band.maxX;
             }
 
             // Step 3: Remove vertical lines within bleed-mark Y-bands
-            std::set<int> vLinesToRemove;
+            std::pmr::set<int> vLinesToRemove(&scratch);
             for (size_t i = 0; i < verticalCropLines.size(); i++) {
               double vMinY =
                   std::min(verticalCropLines[i].y1, verticalCropLines[i].y2);
@@ -2701,7 +3848,8 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
 
             // Step 4: Apply filtering
             if (!hLinesToRemove.empty() || !vLinesToRemove.empty()) {
-              std::vector<PDFLine> filteredH, filteredV;
+              std::pmr::vector<PDFLine> filteredH(&scratch);
+              std::pmr::vector<PDFLine> filteredV(&scratch);
               for (size_t i = 0; i < horizontalCropLines.size(); i++) {
                 if (hLinesToRemove.find(static_cast<int>(i)) ==
                     hLinesToRemove.end()) {
@@ -2715,18 +3863,18 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
                 }
               }
 
-              std::cerr << "DEBUG: Filtered " << hLinesToRemove.size()
+              OCR_DEBUG << "Filtered " << hLinesToRemove.size()
                         << " horizontal and " << vLinesToRemove.size()
-                        << " vertical bleed mark lines" << std::endl;
+                        << " vertical bleed mark lines";
 
               horizontalCropLines = std::move(filteredH);
               verticalCropLines = std::move(filteredV);
             }
           }
 
-          std::cerr << "DEBUG: Found " << horizontalCropLines.size()
+          OCR_DEBUG << "Found " << horizontalCropLines.size()
                     << " horizontal crop mark lines, "
-                    << verticalCropLines.size() << " vertical" << std::endl;
+                    << verticalCropLines.size() << " vertical";
 
           // Find intersection points
           const double intersectionTolerance = 5.0;
@@ -2753,15 +3901,15 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
             }
           }
 
-          std::cerr << "DEBUG: Found " << cropMarkCorners.size()
-                    << " crop mark intersection points" << std::endl;
+          OCR_DEBUG << "Found " << cropMarkCorners.size()
+                    << " crop mark intersection points";
 
           // Calculate interior box from crop mark corners
           if (cropMarkCorners.size() >= 4) {
             // Cluster nearby corners together (many duplicates from multiple
             // line widths)
             const double clusterTolerance = 5.0;
-            std::vector<std::pair<double, double>> uniqueCorners;
+            std::pmr::vector<std::pair<double, double>> uniqueCorners(&scratch);
 
             for (const auto &corner : cropMarkCorners) {
               bool foundCluster = false;
@@ -2783,14 +3931,14 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
               }
             }
 
-            std::cerr << "DEBUG: Clustered " << cropMarkCorners.size()
+            OCR_DEBUG << "Clustered " << cropMarkCorners.size()
                       << " corners to " << uniqueCorners.size()
-                      << " unique corners" << std::endl;
+                      << " unique corners";
 
             // Find the 4 crop mark corners by grouping by X and Y coordinates
             // The 4 actual crop marks will share 2 X values and 2 Y values
-            std::map<double, int> xCounts;
-            std::map<double, int> yCounts;
+            std::pmr::map<double, int> xCounts(&scratch);
+            std::pmr::map<double, int> yCounts(&scratch);
 
             const double coordTolerance = 10.0;
 
@@ -2824,24 +3972,24 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
             }
 
             // Find the 2 X values with most corners
-            std::vector<std::pair<double, int>> xList(xCounts.begin(),
-                                                      xCounts.end());
+            std::pmr::vector<std::pair<double, int>> xList(
+                xCounts.begin(), xCounts.end(), &scratch);
             std::sort(xList.begin(), xList.end(),
                       [](const auto &a, const auto &b) {
                         return a.second > b.second;
                       });
 
             // Find the 2 Y values with most corners
-            std::vector<std::pair<double, int>> yList(yCounts.begin(),
-                                                      yCounts.end());
+            std::pmr::vector<std::pair<double, int>> yList(
+                yCounts.begin(), yCounts.end(), &scratch);
             std::sort(yList.begin(), yList.end(),
                       [](const auto &a, const auto &b) {
                         return a.second > b.second;
                       });
 
-            std::cerr << "DEBUG: Found " << xCounts.size()
+            OCR_DEBUG << "Found " << xCounts.size()
                       << " unique X coordinates, " << yCounts.size()
-                      << " unique Y coordinates" << std::endl;
+                      << " unique Y coordinates";
 
             if (xList.size() >= 2 && yList.size() >= 2) {
               double leftX = std::min(xList[0].first, xList[1].first);
@@ -2854,12 +4002,12 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
               double minY = bottomY;
               double maxY = topY;
 
-              std::cerr << "DEBUG: Most common coords - X: " << xList[0].first
+              OCR_DEBUG << "Most common coords - X: " << xList[0].first
                         << " (n=" << xList[0].second << "), " << xList[1].first
                         << " (n=" << xList[1].second
                         << "); Y: " << yList[0].first
                         << " (n=" << yList[0].second << "), " << yList[1].first
-                        << " (n=" << yList[1].second << ")" << std::endl;
+                        << " (n=" << yList[1].second << ")";
 
               result.linesBoundingBoxX = minX;
               result.linesBoundingBoxY = minY;
@@ -2867,12 +4015,11 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
               result.linesBoundingBoxHeight = maxY - minY;
               result.hasCropMarks = true;
 
-              std::cerr << "DEBUG: Crop box from crop marks: (" << minX << ", "
-                        << minY << ") to (" << maxX << ", " << maxY << ")"
-                        << std::endl;
-              std::cerr << "DEBUG: Bounding rectangle size (crop marks): "
+              OCR_DEBUG << "Crop box from crop marks: (" << minX << ", "
+                        << minY << ") to (" << maxX << ", " << maxY << ")";
+              OCR_DEBUG << "Bounding rectangle size (crop marks): "
                         << result.linesBoundingBoxWidth << " x "
-                        << result.linesBoundingBoxHeight << " pt" << std::endl;
+                        << result.linesBoundingBoxHeight << " pt";
             } else {
               // Fallback to original bounding box
               result.linesBoundingBoxX = lineResult.boundingBoxX;
@@ -2880,33 +4027,32 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
               result.linesBoundingBoxWidth = lineResult.boundingBoxWidth;
               result.linesBoundingBoxHeight = lineResult.boundingBoxHeight;
 
-              std::cerr << "DEBUG: Not enough crop marks found ("
+              OCR_DEBUG << "Not enough crop marks found ("
                         << cropMarkCorners.size()
-                        << "), using line bounding box" << std::endl;
-              std::cerr
-                  << "DEBUG: Bounding rectangle size (largest rect/lines): "
+                        << "), using line bounding box";
+              OCR_DEBUG
+                  << "Bounding rectangle size (largest rect/lines): "
                   << result.linesBoundingBoxWidth << " x "
-                  << result.linesBoundingBoxHeight << " pt" << std::endl;
+                  << result.linesBoundingBoxHeight << " pt";
             }
           }
         } // end else (no TrimBox â€” use crop mark detection)
       }
     } catch (const std::exception &e) {
-      std::cerr << "DEBUG: Line extraction threw exception: " << e.what()
-                << std::endl;
+      OCR_DEBUG << "Line extraction threw exception: " << e.what();
     }
+    linesStage.stop();
 
     // Get page count by loading the PDF once more (or we could track it
     // from earlier)
-    std::cerr << "DEBUG: Getting page count..." << std::endl;
+    OCR_DEBUG << "Getting page count...";
     try {
       std::unique_ptr<poppler::document> doc(
           poppler::document::load_from_file(pdfPath));
-      std::cerr << "DEBUG: PDF loaded for page count" << std::endl;
+      OCR_DEBUG << "PDF loaded for page count";
       if (doc) {
         result.pageCount = doc->pages();
-        std::cerr << "DEBUG: Page count retrieved: " << result.pageCount
-                  << std::endl;
+        OCR_DEBUG << "Page count retrieved: " << result.pageCount;
 
         // Get page dimensions from first page
         std::unique_ptr<poppler::page> page(doc->create_page(0));
@@ -2927,10 +4073,10 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
           result.pageWidth = swapped ? pageRect.height() : pageRect.width();
           result.pageHeight = swapped ? pageRect.width() : pageRect.height();
 
-          std::cerr << "DEBUG: Page crop box: origin(" << pageRect.x() << ", "
+          OCR_DEBUG << "Page crop box: origin(" << pageRect.x() << ", "
                     << pageRect.y() << ") size(" << result.pageWidth << " x "
                     << result.pageHeight << ") points"
-                    << " rotation=" << pageRotation << std::endl;
+                    << " rotation=" << pageRotation;
 
           // Check for TrimBox â€” if the PDF has one that's smaller than the
           // MediaBox/CropBox, it defines the intended content area precisely
@@ -2947,21 +4093,19 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
                 trimRect.height() < mediaRect.height() - trimTolerance));
 
           if (hasTrimBox) {
-            std::cerr << "DEBUG: TrimBox found: origin(" << trimRect.x() << ", "
+            OCR_DEBUG << "TrimBox found: origin(" << trimRect.x() << ", "
                       << trimRect.y() << ") size(" << trimRect.width() << " x "
-                      << trimRect.height() << ") points" << std::endl;
+                      << trimRect.height() << ") points";
             // TrimBox is logged but NOT used as content area â€”
             // crop mark detection is more reliable for these PDFs.
           } else {
-            std::cerr << "DEBUG: No meaningful TrimBox found, will use crop "
-                         "mark detection"
-                      << std::endl;
+            OCR_DEBUG << "No meaningful TrimBox found, will use crop "
+                         "mark detection";
           }
         }
       }
     } catch (const std::exception &e) {
-      std::cerr << "DEBUG: Exception getting page count: " << e.what()
-                << std::endl;
+      OCR_DEBUG << "Exception getting page count: " << e.what();
       result.pageCount = 1; // Default to 1 if we can't get the count
     }
 
@@ -2973,8 +4117,9 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
     // We rasterize the page at low DPI, mask out areas covered by known
     // text/rectangle/line elements, and treat remaining non-white blobs of
     // significant size as vector-drawn image regions.
-    if (result.pageWidth > 0 && result.pageHeight > 0) {
-      std::cerr << "DEBUG: Scanning for vector graphic regions..." << std::endl;
+    if (!contentRectOnly && result.pageWidth > 0 && result.pageHeight > 0) {
+      OCR_DEBUG << "Scanning for vector graphic regions...";
+      ProfileRecorder::Stage stage("vectorGraphics");
       try {
         std::unique_ptr<poppler::document> vgDoc(
             poppler::document::load_from_file(pdfPath));
@@ -2989,21 +4134,17 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
                                        true);
             vgRenderer.set_image_format(poppler::image::format_argb32);
             poppler::image vgPopplerImg =
-                vgRenderer.render_page(vgPage.get(), vgDpi, vgDpi);
+                timedRenderPage(vgRenderer, vgPage.get(), vgDpi);
 
             if (vgPopplerImg.is_valid()) {
               int vgW = vgPopplerImg.width();
               int vgH = vgPopplerImg.height();
 
-              cv::Mat vgMat(vgH, vgW, CV_8UC4,
-                            const_cast<char *>(vgPopplerImg.const_data()),
-                            vgPopplerImg.bytes_per_row());
-              cv::Mat vgBGR;
-              cv::cvtColor(vgMat, vgBGR, cv::COLOR_BGRA2BGR);
+              cv::Mat vgMat = popplerImageView(vgPopplerImg);
 
               // Threshold to find non-white pixels
               cv::Mat vgGray, vgNonWhite;
-              cv::cvtColor(vgBGR, vgGray, cv::COLOR_BGR2GRAY);
+              cv::cvtColor(vgMat, vgGray, cv::COLOR_BGRA2GRAY);
               cv::threshold(vgGray, vgNonWhite, 240, 255,
                             cv::THRESH_BINARY_INV);
 
@@ -3131,8 +4272,9 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
                 int safeCW = std::min(vgW - safeCX, cw);
                 int safeCH = std::min(vgH - safeCY, ch);
                 if (safeCW > 0 && safeCH > 0)
-                  vgEmbImg.image =
-                      vgBGR(cv::Rect(safeCX, safeCY, safeCW, safeCH)).clone();
+                  cv::cvtColor(
+                      vgMat(cv::Rect(safeCX, safeCY, safeCW, safeCH)),
+                      vgEmbImg.image, cv::COLOR_BGRA2BGR);
                 vgEmbImg.pageNumber = 1;
                 vgEmbImg.imageIndex = vecIdx;
                 vgEmbImg.width = safeCW;
@@ -3144,10 +4286,9 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
                 vgEmbImg.rotationAngle = 0.0;
                 vgEmbImg.type = "vector_graphic";
 
-                std::cerr << "DEBUG: Vector graphic at PDF (" << pdfX << ", "
+                OCR_DEBUG << "Vector graphic at PDF (" << pdfX << ", "
                           << pdfY << ") size " << pdfW << "x" << pdfH
-                          << " pts, " << safeCW << "x" << safeCH << " px"
-                          << std::endl;
+                          << " pts, " << safeCW << "x" << safeCH << " px";
 
                 // Save to output directory if one was specified
                 if (!imageOutputDir.empty() && !vgEmbImg.image.empty()) {
@@ -3156,9 +4297,9 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
                       (outDir / (pdfStemVG + "_vecgfx_" +
                                  std::to_string(vecIdx + 1) + ".png"))
                           .string();
-                  if (cv::imwrite(fn, vgEmbImg.image))
-                    std::cerr << "DEBUG: Saved vector graphic " << (vecIdx + 1)
-                              << " to: " << fn << std::endl;
+                  if (writeReturnedImage(fn, vgEmbImg.image))
+                    OCR_DEBUG << "Saved vector graphic " << (vecIdx + 1)
+                              << " to: " << fn;
                 }
 
                 result.images.push_back(std::move(vgEmbImg));
@@ -3166,14 +4307,13 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
               }
 
               result.imageCount = static_cast<int>(result.images.size());
-              std::cerr << "DEBUG: Total images after vector graphic scan: "
-                        << result.imageCount << std::endl;
+              OCR_DEBUG << "Total images after vector graphic scan: "
+                        << result.imageCount;
             }
           }
         }
       } catch (const std::exception &e) {
-        std::cerr << "DEBUG: Vector graphic detection error: " << e.what()
-                  << std::endl;
+        OCR_DEBUG << "Vector graphic detection error: " << e.what();
       }
     }
 
@@ -3191,16 +4331,16 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
           ocrStem[1] == '1';
 
       if (doImageOCR && !result.images.empty()) {
-        std::cerr << "DEBUG: Running OCR on " << result.images.size()
-                  << " image(s) (L1 PDF rule)" << std::endl;
+        OCR_DEBUG << "Running OCR on " << result.images.size()
+                  << " image(s) (L1 PDF rule)";
+        ProfileRecorder::Stage stage("l1ImageOcr");
 
         // Initialise a single Tesseract instance for all images.
         tesseract::TessBaseAPI *tess = new tesseract::TessBaseAPI();
         bool tessOk = (tess->Init("C:/tessdata/tessdata", "eng") == 0 ||
                        tess->Init(NULL, "eng") == 0);
         if (!tessOk) {
-          std::cerr << "DEBUG: Could not initialise Tesseract for image OCR"
-                    << std::endl;
+          OCR_DEBUG << "Could not initialise Tesseract for image OCR";
         } else {
           tess->SetPageSegMode(tesseract::PSM_AUTO);
 
@@ -3230,7 +4370,7 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
 
             tess->SetImage(gray.data, gray.cols, gray.rows, 1,
                            static_cast<int>(gray.step));
-            tess->Recognize(0);
+            timedRecognize(*tess);
 
             // Iterate over words.
             tesseract::ResultIterator *ri = tess->GetIterator();
@@ -3244,7 +4384,7 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
               // Top-left origin, PDF points:
               double x, y, w, h;
             };
-            std::vector<OcrWordPt> goodWords;
+            std::pmr::vector<OcrWordPt> goodWords(&scratch);
 
             do {
               const char *wordRaw = ri->GetUTF8Text(tesseract::RIL_WORD);
@@ -3270,10 +4410,9 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
                 wp.w = (wx2 - wx1) * scaleX;
                 wp.h = (wy2 - wy1) * scaleY;
                 goodWords.push_back(wp);
-                std::cerr << "DEBUG: OCR word \"" << wp.text
+                OCR_DEBUG << "OCR word \"" << wp.text
                           << "\" conf=" << conf << " at PDF (" << wp.x << ","
-                          << wp.y << ") " << wp.w << "x" << wp.h << " pt"
-                          << std::endl;
+                          << wp.y << ") " << wp.w << "x" << wp.h << " pt";
               }
             } while (ri->Next(tesseract::RIL_WORD));
             delete ri;
@@ -3288,7 +4427,8 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
                         return a.y < b.y;
                       });
 
-            std::vector<std::vector<size_t>> lines; // groups of word indices
+            // groups of word indices
+            std::pmr::vector<std::pmr::vector<size_t>> lines(&scratch);
             for (size_t wi = 0; wi < goodWords.size(); wi++) {
               bool placed = false;
               for (auto &line : lines) {
@@ -3301,7 +4441,7 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
                 }
               }
               if (!placed)
-                lines.push_back({wi});
+                lines.emplace_back(1, wi);
             }
 
             // Build one TextRegion per line.
@@ -3310,7 +4450,8 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
                 continue;
 
               // Sort words left-to-right within the line.
-              std::vector<size_t> sorted = line;
+              std::pmr::vector<size_t> sorted(line.begin(), line.end(),
+                                              &scratch);
               std::sort(sorted.begin(), sorted.end(), [&](size_t a, size_t b) {
                 return goodWords[a].x < goodWords[b].x;
               });
@@ -3352,11 +4493,11 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
               tr.level = 2; // line level
               tr.orientation = TextOrientation::Horizontal;
 
-              std::cerr << "DEBUG: OCR line \"" << lineText
+              OCR_DEBUG << "OCR line \"" << lineText
                         << "\" conf=" << avgConf << " bbox=("
                         << tr.boundingBox.x << "," << tr.boundingBox.y << ","
                         << tr.boundingBox.width << "x" << tr.boundingBox.height
-                        << ") pt" << std::endl;
+                        << ") pt";
 
               result.textLines.push_back(std::move(tr));
               result.textLineCount = static_cast<int>(result.textLines.size());
@@ -3371,13 +4512,14 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
     // --- end OCR on images -----------------------------------------------
 
     result.success = true;
-    std::cerr << "DEBUG: All extractions completed successfully" << std::endl;
+    OCR_DEBUG << "All extractions completed successfully";
 
     // Optionally write a cropped copy of the PDF containing only the
     // calculated content rectangle (LAF1: bbox of detected rectangles;
     // LAF2: crop-mark bbox).  Mirrors the bounds-mode dispatch used by
     // createRelativeMap so behaviour stays consistent.
     if (renderContentRectPdf) {
+      ProfileRecorder::Stage stage("contentRect");
       auto startsWithCI = [](const std::string &s, const char *prefix) {
         size_t plen = std::strlen(prefix);
         if (s.size() < plen) return false;
@@ -3444,9 +4586,14 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
       bool haveBounds = computeContentRect(result, stem, cMinX, cMinY,
                                            cMaxX, cMaxY);
       if (!haveBounds) {
-        std::cerr << "DEBUG: renderContentRectPdf skipped — no bounds "
-                     "available for " << stem << std::endl;
+        OCR_DEBUG << "renderContentRectPdf skipped — no bounds "
+                     "available for " << stem;
       } else {
+        // Remember our own rect so that when the pair is processed next it
+        // does not have to re-extract this file.
+        storeContentRect(pdfPath, minRectSize, minLineLength, cMinX, cMinY,
+                         cMaxX, cMaxY);
+
         // If a paired LAF PDF was supplied, compute its content rect
         // too and expand this PDF's content rect vertically so both
         // cropped outputs share the taller height.  The expansion is
@@ -3455,40 +4602,63 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
         if (!pairPdfPath.empty()) {
           std::string pairStem =
               std::filesystem::path(pairPdfPath).filename().string();
-          // Recursive call without renderContentRectPdf to avoid
-          // infinite loops.
-          PDFElements pairElems =
-              extractPDFElements(pairPdfPath, minRectSize, minLineLength,
-                                 "", false, "");
-          if (pairElems.success) {
-            double pMinX = 0, pMinY = 0, pMaxX = 0, pMaxY = 0;
-            if (computeContentRect(pairElems, pairStem,
-                                   pMinX, pMinY, pMaxX, pMaxY)) {
-              double selfH = cMaxY - cMinY;
-              double pairH = pMaxY - pMinY;
-              if (pairH > selfH) {
-                double centreY = (cMinY + cMaxY) / 2.0;
-                cMinY = centreY - pairH / 2.0;
-                cMaxY = centreY + pairH / 2.0;
-                std::cerr << "DEBUG: Expanded content rect height from "
-                          << selfH << " to " << pairH
-                          << " pt to match pair " << pairStem << std::endl;
-              }
-            }
+          double pMinX = 0, pMinY = 0, pMaxX = 0, pMaxY = 0;
+          bool havePair = lookupContentRect(pairPdfPath, minRectSize,
+                                            minLineLength, pMinX, pMinY,
+                                            pMaxX, pMaxY);
+          if (havePair) {
+            OCR_DEBUG << "Using cached content rect for pair "
+                      << pairStem;
           } else {
-            std::cerr << "WARNING: pair PDF extraction failed: "
-                      << pairElems.errorMessage << std::endl;
+            // Content-rect-only pass (rectangles, lines and crop marks; no
+            // text, images, DataMatrix or OCR).  renderContentRectPdf is
+            // off so this cannot recurse.
+            PDFElements pairElems = extractPDFElementsImpl(
+                pairPdfPath, minRectSize, minLineLength, "", false, "", true);
+            havePair = pairElems.success &&
+                       computeContentRect(pairElems, pairStem, pMinX, pMinY,
+                                          pMaxX, pMaxY);
+            // An L1 without rectangles falls back to its image bounds,
+            // which the fast pass does not extract.
+            if (!havePair && pairElems.success &&
+                startsWithCI(pairStem, "l1")) {
+              pairElems = extractPDFElementsImpl(pairPdfPath, minRectSize,
+                                                 minLineLength, "", false, "",
+                                                 false);
+              havePair = pairElems.success &&
+                         computeContentRect(pairElems, pairStem, pMinX,
+                                            pMinY, pMaxX, pMaxY);
+            }
+            if (!pairElems.success) {
+              OCR_WARN << "pair PDF extraction failed: "
+                       << pairElems.errorMessage;
+            } else if (havePair) {
+              storeContentRect(pairPdfPath, minRectSize, minLineLength, pMinX,
+                               pMinY, pMaxX, pMaxY);
+            }
+          }
+          if (havePair) {
+            double selfH = cMaxY - cMinY;
+            double pairH = pMaxY - pMinY;
+            if (pairH > selfH) {
+              double centreY = (cMinY + cMaxY) / 2.0;
+              cMinY = centreY - pairH / 2.0;
+              cMaxY = centreY + pairH / 2.0;
+              OCR_DEBUG << "Expanded content rect height from "
+                        << selfH << " to " << pairH
+                        << " pt to match pair " << pairStem;
+            }
           }
         }
 
         std::string outPath, errMsg;
         if (writeContentRectPDF(pdfPath, cMinX, cMinY, cMaxX, cMaxY,
-                                outPath, errMsg)) {
-          std::cerr << "DEBUG: Wrote cropped content PDF: " << outPath
-                    << std::endl;
+                                m_config.incrementalContentPdf,
+                                m_config.contentPreviewFromOpenDoc, outPath,
+                                errMsg)) {
+          OCR_DEBUG << "Wrote cropped content PDF: " << outPath;
         } else {
-          std::cerr << "WARNING: writeContentRectPDF failed: " << errMsg
-                    << std::endl;
+          OCR_WARN << "writeContentRectPDF failed: " << errMsg;
         }
       }
     }
@@ -3496,7 +4666,7 @@ OCRAnalysis::extractPDFElements(const std::string &pdfPath, double minRectSize,
   } catch (const std::exception &e) {
     result.errorMessage =
         std::string("PDF element extraction failed: ") + e.what();
-    std::cerr << "DEBUG: Top-level exception: " << e.what() << std::endl;
+    OCR_DEBUG << "Top-level exception: " << e.what();
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
@@ -3518,22 +4688,22 @@ int OCRAnalysis::writeAllImages(const std::string &pdfPath,
     std::string pdfStem = pdfFilePath.stem().string();
 
     // Load PDF using low-level Poppler API
-    GlobalParamsIniter globalParamsInit(nullptr);
+    GlobalParamsIniter globalParamsInit(popplerErrorToLog);
     auto fileName = std::make_unique<GooString>(pdfPath);
     std::unique_ptr<PDFDoc> doc(new PDFDoc(std::move(fileName)));
 
     if (!doc->isOk()) {
-      std::cerr << "ERROR: Failed to load PDF file: " << pdfPath << std::endl;
+      OCR_ERROR << "Failed to load PDF file: " << pdfPath;
       return -1;
     }
 
     int pageCount = doc->getNumPages();
     if (pageCount < 1) {
-      std::cerr << "ERROR: PDF has no pages" << std::endl;
+      OCR_ERROR << "PDF has no pages";
       return -1;
     }
 
-    std::cerr << "DEBUG: PDF has " << pageCount << " page(s)" << std::endl;
+    OCR_DEBUG << "PDF has " << pageCount << " page(s)";
 
     int totalSaved = 0;
 
@@ -3543,17 +4713,17 @@ int OCRAnalysis::writeAllImages(const std::string &pdfPath,
       outputDev.setDoc(doc.get());
       outputDev.setPageNumber(pageNum);
 
-      doc->displayPage(&outputDev, pageNum, 72.0, 72.0, 0, true, false, false);
+      timedDisplayPage(*doc, &outputDev, pageNum, 72.0, 0, true, false, false);
 
       auto images = std::move(outputDev.getImages());
-      std::cerr << "DEBUG: Page " << pageNum << ": found " << images.size()
-                << " embedded image(s)" << std::endl;
+      OCR_DEBUG << "Page " << pageNum << ": found " << images.size()
+                << " embedded image(s)";
 
       for (size_t i = 0; i < images.size(); i++) {
         const auto &img = images[i];
         if (img.image.empty()) {
-          std::cerr << "DEBUG: Page " << pageNum << " image " << (i + 1)
-                    << ": empty, skipping" << std::endl;
+          OCR_DEBUG << "Page " << pageNum << " image " << (i + 1)
+                    << ": empty, skipping";
           continue;
         }
 
@@ -3562,22 +4732,22 @@ int OCRAnalysis::writeAllImages(const std::string &pdfPath,
                        std::to_string(i + 1) + ".png"))
                 .string();
 
-        if (cv::imwrite(filename, img.image)) {
-          std::cout << "Saved: " << filename << " (" << img.image.cols << "x"
+        if (writeImage(filename, img.image)) {
+          OCR_DEBUG << "Saved: " << filename << " (" << img.image.cols << "x"
                     << img.image.rows << ", " << img.image.channels()
-                    << " channels)" << std::endl;
+                    << " channels)";
           totalSaved++;
         } else {
-          std::cerr << "ERROR: Failed to save: " << filename << std::endl;
+          OCR_ERROR << "Failed to save: " << filename;
         }
       }
     }
 
-    std::cout << "Total images saved: " << totalSaved << std::endl;
+    OCR_INFO << "Total images saved: " << totalSaved;
     return totalSaved;
 
   } catch (const std::exception &e) {
-    std::cerr << "ERROR: writeAllImages failed: " << e.what() << std::endl;
+    OCR_ERROR << "writeAllImages failed: " << e.what();
     return -1;
   }
 }
@@ -3631,7 +4801,7 @@ std::vector<TextRegion> OCRAnalysis::detectTextRegions(const cv::Mat &image) {
   setImage(workingImage);
 
   // Must call Recognize before GetIterator
-  m_tesseract->Recognize(nullptr);
+  timedRecognize(*m_tesseract);
 
   // Structure to hold region info including Tesseract orientation for later
   // processing
@@ -3758,7 +4928,7 @@ std::vector<TextRegion> OCRAnalysis::detectTextRegions(const cv::Mat &image) {
 
         // Perform OCR on the rotated region
         setImage(borderedRegion);
-        m_tesseract->Recognize(nullptr);
+        timedRecognize(*m_tesseract);
 
         char *rotatedText = m_tesseract->GetUTF8Text();
         if (rotatedText != nullptr && *rotatedText != '\0') {
@@ -3814,7 +4984,7 @@ std::vector<TextRegion> OCRAnalysis::identifyTextRegions(const cv::Mat &image) {
     }
 
     setImage(rotatedImage);
-    m_tesseract->Recognize(nullptr);
+    timedRecognize(*m_tesseract);
 
     tesseract::ResultIterator *ri = m_tesseract->GetIterator();
     if (ri == nullptr) {
@@ -4166,12 +5336,62 @@ void OCRAnalysis::setConfig(const OCRConfig &config) {
     m_tesseract->End();
     m_initialized = false;
   }
+  // Recreate the image writer with the new thread count / compression level
+  // on next use (the old one finishes its queue first).
+  if (m_imageWriter) {
+    waitForImageWrites();
+    m_imageWriter.reset();
+    m_imageWriteFailures = 0;
+  }
+}
+
+bool OCRAnalysis::writeImage(const std::string &path, const cv::Mat &image) {
+  if (!m_imageWriter)
+    m_imageWriter = std::make_unique<ImageWriter>(
+        std::max(0, m_config.imageWriterThreads), 16, m_config.pngCompression);
+  std::future<bool> done = m_imageWriter->write(path, image);
+  if (m_imageWriter->threadCount() == 0)
+    return done.get();
+  return true;
+}
+
+bool OCRAnalysis::writeReturnedImage(const std::string &path,
+                                     const cv::Mat &image) {
+  // In background mode the queued Mat shares pixels with the one returned,
+  // so queue a copy the caller cannot reach.
+  return writeImage(path,
+                    m_config.imageWriterThreads > 0 ? image.clone() : image);
+}
+
+size_t OCRAnalysis::waitForImageWrites() {
+  if (!m_imageWriter)
+    return 0;
+  m_imageWriter->wait();
+  size_t failed = m_imageWriter->failedCount() - m_imageWriteFailures;
+  m_imageWriteFailures = m_imageWriter->failedCount();
+  return failed;
 }
 
 std::string OCRAnalysis::getTesseractVersion() {
   return tesseract::TessBaseAPI::Version();
 }
 
+std::string OCRAnalysis::getLibraryVersion() {
+#ifdef OCR_ANALYSIS_VERSION
+  return OCR_ANALYSIS_VERSION;
+#else
+  return "unknown";
+#endif
+}
+
+int OCRAnalysis::getDetectionRevision() {
+  // 1: vector DataMatrix codes found from clusters of page marks (the
+  //    full-page scan only on rotated pages or on request); label crop
+  //    searched on a downscale, edges refined at full resolution ignoring
+  //    specks.  Add a line and bump for every change to what is found.
+  return 1;
+}
+
 std::vector<std::string> OCRAnalysis::getAvailableLanguages() const {
   std::vector<std::string> languages;
 
@@ -4205,11 +5425,64 @@ cv::Mat OCRAnalysis::preprocessImage(const cv::Mat &image) {
   return processed;
 }
 
-// static 
+namespace {
+
+// Fixed-point BGR → grey weights used by cv::cvtColor for CV_8U
+// (R 0.299, G 0.587, B 0.114 in Q14), so the fused kernel below matches
+// COLOR_BGR2GRAY bit for bit.
+constexpr int kGrayB = 1868, kGrayG = 9617, kGrayR = 4899;
+constexpr int kGrayShift = 14;
+constexpr int kGrayRound = 1 << (kGrayShift - 1);
+
+/// Row @p y of @p src as greyscale into @p dst (CV_8U input, 1, 3 or 4
+/// channels; the alpha channel is ignored).
+void cleanupGrayRow(const cv::Mat &src, int y, uchar *dst) {
+  const uchar *s = src.ptr<uchar>(y);
+  const int n = src.cols;
+  switch (src.channels()) {
+  case 1:
+    std::memcpy(dst, s, n);
+    break;
+  case 3:
+    for (int i = 0; i < n; ++i, s += 3)
+      dst[i] = static_cast<uchar>(
+          (s[0] * kGrayB + s[1] * kGrayG + s[2] * kGrayR + kGrayRound) >>
+          kGrayShift);
+    break;
+  default:
+    for (int i = 0; i < n; ++i, s += 4)
+      dst[i] = static_cast<uchar>(
+          (s[0] * kGrayB + s[1] * kGrayG + s[2] * kGrayR + kGrayRound) >>
+          kGrayShift);
+    break;
+  }
+}
+
+} // namespace
+
+// static
 cv::Mat OCRAnalysis::cleanupForOCR(const cv::Mat &input,
                                     CleanupDiagnostics *diag) {
-  if (input.empty())
-    return {};
+  cv::Mat output;
+  CleanupBuffers buffers;
+  cleanupForOCR(input, output, buffers, diag);
+  return output;
+}
+
+// static
+void OCRAnalysis::cleanupForOCR(const cv::Mat &image, cv::Mat &output,
+                                CleanupBuffers &buffers,
+                                CleanupDiagnostics *diag) {
+  if (image.empty()) {
+    output.release();
+    return;
+  }
+
+  cv::Mat input = image;
+  if (input.depth() != CV_8U)
+    image.convertTo(input, CV_8U);
+  if (input.channels() == 2)
+    cv::extractChannel(input.clone(), input, 0);
 
   // ── Step 1: separate colour from transparency ─────────────────────────────
   // For RGBA images the root cause of "bleed-through" is that compositing a
@@ -4222,33 +5495,63 @@ cv::Mat OCRAnalysis::cleanupForOCR(const cv::Mat &input,
   // For the colour channels we convert to greyscale WITHOUT compositing so
   // the actual ink darkness is preserved at its true value, not diluted by
   // the blend with white.
-
-  cv::Mat gray;
-  cv::Mat opaqueMask; // non-empty only for RGBA input
-
-  if (input.channels() == 4) {
-    std::vector<cv::Mat> ch;
-    cv::split(input, ch); // B, G, R, A  (all CV_8U)
-
-    // Opaque mask: alpha > 200 → 255 (include), ≤ 200 → 0 (force white).
-    cv::threshold(ch[3], opaqueMask, 200, 255, cv::THRESH_BINARY);
-
-    // Greyscale from the colour channels only (no alpha blending).
-    cv::Mat bgr;
-    cv::merge(std::vector<cv::Mat>{ch[0], ch[1], ch[2]}, bgr);
-    cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
-
-  } else if (input.channels() == 3) {
-    cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
-  } else {
-    gray = input.clone();
-  }
-
+  //
   // ── Step 2: gentle noise reduction ───────────────────────────────────────
-  cv::GaussianBlur(gray, gray, cv::Size(3, 3), 0);
+  // A 3×3 Gaussian ([1 2 1] ⊗ [1 2 1] / 16, reflect-101 borders, the same
+  // kernel cv::GaussianBlur uses for Size(3, 3) with sigma 0).
+  //
+  // Steps 1 and 2 and the masked histogram of Step 3 run as one sweep over
+  // the input: greyscale rows go into a three-row ring, each blurred row is
+  // written to buffers.blurred and counted into the histogram as soon as the
+  // row below it is available.  Alpha is read straight from the input, so no
+  // mask image is built.
+  const int rows = input.rows, cols = input.cols;
+  const bool hasAlpha = input.channels() == 4;
+
+  buffers.ring.create(3, cols, CV_8UC1);
+  buffers.columnSum.create(1, cols + 2, CV_16UC1);
+  buffers.blurred.create(rows, cols, CV_8UC1);
+
+  // Four interleaved sub-histograms avoid a store-to-load stall when
+  // neighbouring pixels fall into the same bin.
+  std::vector<int> counts(4 * 256, 0);
+
+  auto ringRow = [&](int y) { return buffers.ring.ptr<uchar>(y % 3); };
+  cleanupGrayRow(input, 0, ringRow(0));
+  if (rows > 1)
+    cleanupGrayRow(input, 1, ringRow(1));
+
+  for (int y = 0; y < rows; ++y) {
+    if (y + 1 < rows && y + 1 >= 2)
+      cleanupGrayRow(input, y + 1, ringRow(y + 1));
+
+    // Reflect-101 row neighbours (a single row is its own neighbour).
+    const int yAbove = y > 0 ? y - 1 : std::min(1, rows - 1);
+    const int yBelow = y + 1 < rows ? y + 1 : std::max(0, rows - 2);
+    const uchar *a = ringRow(yAbove);
+    const uchar *b = ringRow(y);
+    const uchar *c = ringRow(yBelow);
+
+    // Vertical [1 2 1], stored with one reflected column either side.
+    ushort *v = buffers.columnSum.ptr<ushort>() + 1;
+    for (int i = 0; i < cols; ++i)
+      v[i] = static_cast<ushort>(a[i] + 2 * b[i] + c[i]);
+    v[-1] = v[cols > 1 ? 1 : 0];
+    v[cols] = v[cols > 1 ? cols - 2 : 0];
+
+    // Horizontal [1 2 1], round, and count opaque pixels.
+    uchar *out = buffers.blurred.ptr<uchar>(y);
+    const uchar *alpha = hasAlpha ? input.ptr<uchar>(y) + 3 : nullptr;
+    for (int i = 0; i < cols; ++i) {
+      uchar g = static_cast<uchar>((v[i - 1] + 2 * v[i] + v[i + 1] + 8) >> 4);
+      out[i] = g;
+      if (!alpha || alpha[4 * i] > 200)
+        counts[(i & 3) * 256 + g]++;
+    }
+  }
 
   // ── Step 3: find the optimal threshold from the histogram ─────────────────
-  // We compute the histogram only over the opaque pixels (via opaqueMask for
+  // We compute the histogram only over the opaque pixels (alpha > 200 for
   // RGBA, or the whole image for other formats).  This means the semi-
   // transparent edges that caused the 57 % bleed-through are excluded from
   // the analysis entirely.  The remaining opaque pixels form a naturally
@@ -4266,13 +5569,11 @@ cv::Mat OCRAnalysis::cleanupForOCR(const cv::Mat &input,
   //   f) Apply a global binary threshold at that valley value.
   //      Pixels at or above the valley → white; below → black ink.
 
-  cv::Mat hist;
-  const int   histSize  = 256;
-  const float range[]   = {0.0f, 256.0f};
-  const float *histRange = range;
-  cv::calcHist(&gray, 1, nullptr,
-               opaqueMask.empty() ? cv::Mat() : opaqueMask,
-               hist, 1, &histSize, &histRange, true, false);
+  // (a) The histogram was gathered during the sweep above.
+  cv::Mat hist(256, 1, CV_32FC1);
+  for (int bin = 0; bin < 256; ++bin)
+    hist.at<float>(bin) = static_cast<float>(
+        counts[bin] + counts[256 + bin] + counts[512 + bin] + counts[768 + bin]);
 
   // (b) Smooth the 256×1 histogram column with a vertical Gaussian.
   cv::GaussianBlur(hist, hist, cv::Size(1, 11), 0);
@@ -4342,14 +5643,23 @@ cv::Mat OCRAnalysis::cleanupForOCR(const cv::Mat &input,
   int threshBin = nextValleyBin;
 
   // (g) Global binary threshold: pixels at or below threshBin → black ink.
-  cv::Mat binary;
-  cv::threshold(gray, binary, threshBin, 255, cv::THRESH_BINARY);
-
   // ── Step 4: force semi-transparent pixels to white ────────────────────────
   // Any pixel that failed the alpha gate in Step 1 is set to white (255)
-  // regardless of what the grey-level threshold decided.
-  if (!opaqueMask.empty())
-    binary.setTo(255, ~opaqueMask);
+  // regardless of what the grey-level threshold decided.  Both happen in a
+  // single second sweep over the blurred image.
+  output.create(rows, cols, CV_8UC1);
+  for (int y = 0; y < rows; ++y) {
+    const uchar *g = buffers.blurred.ptr<uchar>(y);
+    uchar *out = output.ptr<uchar>(y);
+    if (hasAlpha) {
+      const uchar *alpha = input.ptr<uchar>(y) + 3;
+      for (int i = 0; i < cols; ++i)
+        out[i] = (g[i] > threshBin || alpha[4 * i] <= 200) ? 255 : 0;
+    } else {
+      for (int i = 0; i < cols; ++i)
+        out[i] = g[i] > threshBin ? 255 : 0;
+    }
+  }
 
   // ── Step 5: optional diagnostics ──────────────────────────────────────────
   if (diag) {
@@ -4420,37 +5730,49 @@ cv::Mat OCRAnalysis::cleanupForOCR(const cv::Mat &input,
 
     diag->histImage = histImg;
   }
-
-  return binary;
 }
 
-// static
-cv::Mat OCRAnalysis::cropToLabel(const cv::Mat &image,
-                                  int  darkThresh,
-                                  int  diffThresh,
-                                  bool tightLabel) {
-  if (image.empty()) return {};
+namespace {
 
-  // ── Grayscale conversion ──────────────────────────────────────────────────
-  // For RGBA images: extract an opaque-pixel mask (alpha > 200) so that
-  // transparent background pixels — which may have white RGB values — are
-  // never mistaken for backing paper or label in either threshold step.
-  cv::Mat gray;
-  cv::Mat opaqueMask; // empty for non-RGBA input
+// Working resolution for cropToLabelRect: larger photos are located on a
+// power-of-two downscale no bigger than this, then refined at full size.
+constexpr double kCropPyramidMaxPixels = 2.0e6;
+
+/// Greyscale copy of @p image.  For RGBA input @p opaqueMask receives
+/// alpha > 200 and transparent pixels are zeroed in @p gray so they never
+/// pass a brightness threshold; otherwise @p opaqueMask is left empty.
+void labelGray(const cv::Mat &image, cv::Mat &gray, cv::Mat &opaqueMask) {
   if (image.channels() == 1) {
     gray = image;
   } else if (image.channels() == 3) {
     cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
   } else { // 4-channel RGBA
-    std::vector<cv::Mat> ch;
-    cv::split(image, ch);
-    cv::threshold(ch[3], opaqueMask, 200, 255, cv::THRESH_BINARY);
-    cv::Mat bgr;
-    cv::merge(std::vector<cv::Mat>{ch[0], ch[1], ch[2]}, bgr);
-    cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
-    // Zero out transparent pixels so they don't pass either threshold.
+    cv::extractChannel(image, opaqueMask, 3);
+    cv::threshold(opaqueMask, opaqueMask, 200, 255, cv::THRESH_BINARY);
+    cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY);
     gray.setTo(0, ~opaqueMask);
   }
+}
+
+/// Result of the backing-paper / label search on one pyramid level.
+struct LabelRects {
+  cv::Rect paper;        ///< Backing paper (empty = nothing found)
+  cv::Rect label;        ///< Label, relative to paper (empty = use paper)
+  int otsuThresh = 0;    ///< Paper/label split used for the label mask
+  int dominantGrey = 128;
+  int tabDevThresh = 0;
+  bool tabExtended = false; ///< Top edge came from the grey-tab search
+};
+
+/// The cropToLabel algorithm on a greyscale image.  Morphology kernels are
+/// divided by @p scale so a downscaled image behaves like the full one.
+LabelRects findLabelRects(const cv::Mat &gray, int darkThresh, int diffThresh,
+                          bool tightLabel, int scale) {
+  LabelRects out;
+  auto kernel = [scale](int size) {
+    int k = std::max(3, size / scale) | 1;
+    return cv::getStructuringElement(cv::MORPH_RECT, cv::Size(k, k));
+  };
 
   // ── Step 1: find backing paper by removing the very dark background ───────
   // Pixels below darkThresh are background; everything else is backing paper
@@ -4459,15 +5781,13 @@ cv::Mat OCRAnalysis::cropToLabel(const cv::Mat &image,
   // connected component.
   cv::Mat paperMask;
   cv::threshold(gray, paperMask, darkThresh, 255, cv::THRESH_BINARY);
-
-  cv::Mat k1 = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(31, 31));
-  cv::morphologyEx(paperMask, paperMask, cv::MORPH_CLOSE, k1);
+  cv::morphologyEx(paperMask, paperMask, cv::MORPH_CLOSE, kernel(31));
 
   cv::Mat labels, stats, centroids;
   int nLabels = cv::connectedComponentsWithStats(
       paperMask, labels, stats, centroids, 8, CV_32S);
 
-  if (nLabels <= 1) return {}; // nothing but background
+  if (nLabels <= 1) return out; // nothing but background
 
   // Pick the largest non-background component.
   int bestLabel = 1;
@@ -4481,11 +5801,10 @@ cv::Mat OCRAnalysis::cropToLabel(const cv::Mat &image,
                      stats.at<int>(bestLabel, cv::CC_STAT_TOP),
                      stats.at<int>(bestLabel, cv::CC_STAT_WIDTH),
                      stats.at<int>(bestLabel, cv::CC_STAT_HEIGHT));
-  paperRect &= cv::Rect(0, 0, image.cols, image.rows);
-  if (paperRect.empty()) return {};
-
-  if (!tightLabel)
-    return image(paperRect).clone();
+  paperRect &= cv::Rect(0, 0, gray.cols, gray.rows);
+  out.paper = paperRect;
+  if (paperRect.empty() || !tightLabel)
+    return out;
 
   // ── Step 2: find the label as the region that differs from the backing ──────
   // The backing paper has a dominant (most common) grey intensity.  The label
@@ -4538,20 +5857,20 @@ cv::Mat OCRAnalysis::cropToLabel(const cv::Mat &image,
       dominantGrey     = b;
     }
   }
+  out.otsuThresh = otsuThresh;
+  out.dominantGrey = dominantGrey;
 
   // The label is the class on the LIGHTER side of the Otsu threshold.
   cv::Mat labelMask;
   cv::threshold(paperGray, labelMask, otsuThresh, 255, cv::THRESH_BINARY);
   labelMask.setTo(0, ~nonZeroMask); // exclude transparent pixels
-
-  cv::Mat k2 = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(21, 21));
-  cv::morphologyEx(labelMask, labelMask, cv::MORPH_CLOSE, k2);
+  cv::morphologyEx(labelMask, labelMask, cv::MORPH_CLOSE, kernel(21));
 
   cv::Mat labels2, stats2, centroids2;
   int nLabels2 = cv::connectedComponentsWithStats(
       labelMask, labels2, stats2, centroids2, 8, CV_32S);
 
-  if (nLabels2 <= 1) return image(paperRect).clone();
+  if (nLabels2 <= 1) return out;
 
   // Minimum area: 1 % of the backing-paper area.  This filters out small
   // artefacts (clip fixtures, shadows, staple holes) that deviate from the
@@ -4571,7 +5890,7 @@ cv::Mat OCRAnalysis::cropToLabel(const cv::Mat &image,
   }
 
   labelRect &= cv::Rect(0, 0, paperRect.width, paperRect.height);
-  if (labelRect.empty()) return image(paperRect).clone();
+  if (labelRect.empty()) return out;
 
   // ── Step 2b: extend the bounding box upward to capture any grey tab/flap ──
   // The Otsu pass above captures only the white (above-threshold) label body.
@@ -4581,6 +5900,7 @@ cv::Mat OCRAnalysis::cropToLabel(const cv::Mat &image,
   // backing grey by more than diffThresh/2.  The search is intentionally
   // restricted to this strip so that the deviation scan cannot pick up noise
   // scattered across the full backing paper area.
+  out.tabDevThresh = std::max(8, diffThresh / 2);
   if (labelRect.y > 0) {
     // Constrain the strip horizontally to the existing label bounds.  The tab
     // lies above the label and should be no wider than it; scanning the full
@@ -4589,15 +5909,12 @@ cv::Mat OCRAnalysis::cropToLabel(const cv::Mat &image,
     cv::Mat stripGray = paperGray(stripROI);
     cv::Mat stripNZ   = nonZeroMask(stripROI);
 
-    const int tabDevThresh = std::max(8, diffThresh / 2);
     cv::Mat stripDev;
     cv::absdiff(stripGray,
                 cv::Scalar(static_cast<uchar>(dominantGrey)), stripDev);
-    cv::threshold(stripDev, stripDev, tabDevThresh, 255, cv::THRESH_BINARY);
+    cv::threshold(stripDev, stripDev, out.tabDevThresh, 255, cv::THRESH_BINARY);
     stripDev.setTo(0, ~stripNZ);
-
-    cv::Mat kTab = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(21, 21));
-    cv::morphologyEx(stripDev, stripDev, cv::MORPH_CLOSE, kTab);
+    cv::morphologyEx(stripDev, stripDev, cv::MORPH_CLOSE, kernel(21));
 
     cv::Mat sLabels, sStats, sCentroids;
     int nS = cv::connectedComponentsWithStats(
@@ -4606,6 +5923,7 @@ cv::Mat OCRAnalysis::cropToLabel(const cv::Mat &image,
     // Use a lower area threshold than the main label (0.1 % of paper area)
     // because the tab may cover less area than the full label body.
     const int minTabArea = std::max(1, paperRect.area() / 1000);
+    const int topBefore = labelRect.y;
     for (int i = 1; i < nS; ++i) {
       if (sStats.at<int>(i, cv::CC_STAT_AREA) < minTabArea) continue;
       // Component coords are relative to stripROI; offset x back to paperGray.
@@ -4616,9 +5934,209 @@ cv::Mat OCRAnalysis::cropToLabel(const cv::Mat &image,
       labelRect = labelRect | r;
     }
     labelRect &= cv::Rect(0, 0, paperRect.width, paperRect.height);
+    out.tabExtended = labelRect.y < topBefore;
+  }
+
+  out.label = labelRect;
+  return out;
+}
+
+/// Which side of a refinement band faces the inside of the rectangle.
+enum class BandInner { Top, Bottom, Left, Right };
+
+/// Keep only the parts of @p mask that are connected to its @p inner side.
+/// This is the component test of the single-level search, applied to one
+/// edge band: pixels that join the body of the region survive, isolated
+/// specks outside it do not.
+cv::Mat connectedToInnerSide(const cv::Mat &mask, BandInner inner) {
+  cv::Mat labels;
+  int n = cv::connectedComponents(mask, labels, 8, CV_32S);
+  std::vector<uchar> keep(n, 0);
+  auto mark = [&](int r, int c) {
+    int l = labels.at<int>(r, c);
+    if (l > 0) keep[l] = 255;
+  };
+  switch (inner) {
+  case BandInner::Top:
+  case BandInner::Bottom: {
+    int r = inner == BandInner::Top ? 0 : mask.rows - 1;
+    for (int c = 0; c < mask.cols; ++c) mark(r, c);
+    break;
+  }
+  case BandInner::Left:
+  case BandInner::Right: {
+    int c = inner == BandInner::Left ? 0 : mask.cols - 1;
+    for (int r = 0; r < mask.rows; ++r) mark(r, c);
+    break;
+  }
+  }
+  cv::Mat out(mask.size(), CV_8U);
+  for (int r = 0; r < mask.rows; ++r) {
+    const int *l = labels.ptr<int>(r);
+    uchar *o = out.ptr<uchar>(r);
+    for (int c = 0; c < mask.cols; ++c) o[c] = keep[l[c]];
+  }
+  return out;
+}
+
+/// Snap each edge of @p coarse (full-resolution coordinates, upscaled from
+/// a pyramid level) to the outermost row / column within @p margin pixels
+/// that contains a pixel of the region.  Only the four boundary bands are
+/// converted and tested; edges with no hit keep their coarse position.
+/// @p mask maps a full-resolution ROI of the photo to a CV_8U 0/255 mask;
+/// each band mask is closed with a @p closeSize square, as the single-level
+/// search does, and only components reaching the band's inner side count,
+/// so a bright speck just outside the region cannot move an edge outward.
+cv::Rect refineRectEdges(const cv::Mat &image, cv::Rect coarse, int margin,
+                         const std::function<cv::Mat(const cv::Mat &)> &mask,
+                         int closeSize, bool refineTop = true) {
+  const cv::Rect bounds(0, 0, image.cols, image.rows);
+  coarse &= bounds;
+  if (coarse.empty())
+    return coarse;
+
+  int x0 = coarse.x, y0 = coarse.y, x1 = coarse.br().x, y1 = coarse.br().y;
+  // Bands span the coarse extent along the edge, widened by the margin.
+  cv::Rect hSpan(x0 - margin, 0, coarse.width + 2 * margin, 0);
+  cv::Rect vSpan(0, y0 - margin, 0, coarse.height + 2 * margin);
+  const cv::Mat closeKernel = cv::getStructuringElement(
+      cv::MORPH_RECT, cv::Size(closeSize, closeSize));
+
+  auto bandMask = [&](const cv::Rect &band, BandInner inner) {
+    cv::Mat m = mask(image(band));
+    cv::morphologyEx(m, m, cv::MORPH_CLOSE, closeKernel);
+    return connectedToInnerSide(m, inner);
+  };
+  auto rowsWithHits = [&](cv::Rect band, BandInner inner,
+                          std::vector<int> &hits) {
+    band &= bounds;
+    hits.clear();
+    if (band.empty())
+      return;
+    cv::Mat rowMax;
+    cv::reduce(bandMask(band, inner), rowMax, 1, cv::REDUCE_MAX);
+    for (int r = 0; r < rowMax.rows; ++r)
+      if (rowMax.at<uchar>(r))
+        hits.push_back(band.y + r);
+  };
+  auto colsWithHits = [&](cv::Rect band, BandInner inner,
+                          std::vector<int> &hits) {
+    band &= bounds;
+    hits.clear();
+    if (band.empty())
+      return;
+    cv::Mat colMax;
+    cv::reduce(bandMask(band, inner), colMax, 0, cv::REDUCE_MAX);
+    for (int c = 0; c < colMax.cols; ++c)
+      if (colMax.at<uchar>(c))
+        hits.push_back(band.x + c);
+  };
+
+  // The inner side of each band is the one that lies inside the coarse
+  // rectangle: the top band's bottom row, the left band's right column...
+  std::vector<int> hits;
+  int nx0 = x0, ny0 = y0, nx1 = x1, ny1 = y1;
+  if (refineTop) {
+    rowsWithHits({hSpan.x, y0 - margin, hSpan.width, 2 * margin},
+                 BandInner::Bottom, hits);
+    if (!hits.empty()) ny0 = hits.front();
   }
+  rowsWithHits({hSpan.x, y1 - margin, hSpan.width, 2 * margin},
+               BandInner::Top, hits);
+  if (!hits.empty()) ny1 = hits.back() + 1;
+  colsWithHits({x0 - margin, vSpan.y, 2 * margin, vSpan.height},
+               BandInner::Right, hits);
+  if (!hits.empty()) nx0 = hits.front();
+  colsWithHits({x1 - margin, vSpan.y, 2 * margin, vSpan.height},
+               BandInner::Left, hits);
+  if (!hits.empty()) nx1 = hits.back() + 1;
+
+  return cv::Rect(nx0, ny0, nx1 - nx0, ny1 - ny0) & bounds;
+}
+
+} // namespace
+
+// static
+cv::Rect OCRAnalysis::cropToLabelRect(const cv::Mat &image,
+                                      int  darkThresh,
+                                      int  diffThresh,
+                                      bool tightLabel,
+                                      bool fullResolution) {
+  if (image.empty()) return {};
+
+  // Pick the pyramid level: the largest power-of-two downscale (up to 1/8)
+  // that keeps the working image under kCropPyramidMaxPixels.
+  int scale = 1;
+  while (!fullResolution && scale < 8 &&
+         static_cast<double>(image.total()) / (scale * scale) >
+             kCropPyramidMaxPixels)
+    scale *= 2;
+
+  // ── Grayscale conversion ──────────────────────────────────────────────────
+  // For RGBA images: extract an opaque-pixel mask (alpha > 200) so that
+  // transparent background pixels — which may have white RGB values — are
+  // never mistaken for backing paper or label in either threshold step.
+  // Downscaling happens on the colour image (INTER_AREA), so the full-size
+  // greyscale image is never built.
+  cv::Mat small = image;
+  if (scale > 1)
+    cv::resize(image, small,
+               cv::Size(std::max(1, image.cols / scale),
+                        std::max(1, image.rows / scale)),
+               0, 0, cv::INTER_AREA);
+  cv::Mat gray, opaqueMask;
+  labelGray(small, gray, opaqueMask);
+
+  LabelRects found =
+      findLabelRects(gray, darkThresh, diffThresh, tightLabel, scale);
+  if (found.paper.empty()) return {};
+  if (scale == 1)
+    return found.label.empty() ? found.paper : found.label + found.paper.tl();
+
+  // ── Full-resolution refinement ────────────────────────────────────────────
+  // The pyramid rectangles are accurate to a few pyramid pixels; re-threshold
+  // only narrow bands around each edge at full size to recover exact edges.
+  auto up = [scale](const cv::Rect &r) {
+    return cv::Rect(r.x * scale, r.y * scale, r.width * scale,
+                    r.height * scale);
+  };
+  const int margin = 2 * scale;
+  auto thresholdMask = [&](int thresh) {
+    return [&, thresh](const cv::Mat &roi) {
+      cv::Mat g, opaque, m;
+      labelGray(roi, g, opaque);
+      cv::threshold(g, m, thresh, 255, cv::THRESH_BINARY);
+      return m;
+    };
+  };
 
-  return image(paperRect)(labelRect).clone();
+  cv::Rect paper =
+      refineRectEdges(image, up(found.paper), margin, thresholdMask(darkThresh),
+                      31);
+  if (found.label.empty())
+    return paper;
+
+  // The label edges are searched inside the refined paper only.  A top edge
+  // that came from the grey-tab search is kept at pyramid accuracy, since
+  // the tab is defined by deviation from the backing grey rather than by
+  // the label threshold.
+  cv::Mat paperImg = image(paper);
+  cv::Rect label = refineRectEdges(
+      paperImg, up(found.label + found.paper.tl()) - paper.tl(), margin,
+      thresholdMask(found.otsuThresh), 21, !found.tabExtended);
+  if (label.empty())
+    return paper;
+  return label + paper.tl();
+}
+
+// static
+cv::Mat OCRAnalysis::cropToLabel(const cv::Mat &image,
+                                  int  darkThresh,
+                                  int  diffThresh,
+                                  bool tightLabel) {
+  cv::Rect r = cropToLabelRect(image, darkThresh, diffThresh, tightLabel);
+  if (r.empty()) return {};
+  return image(r).clone();
 }
 
 void OCRAnalysis::setImage(const cv::Mat &image) {
@@ -4665,7 +6183,7 @@ int OCRAnalysis::findBestRotation(const cv::Mat &image) {
     }
 
     setImage(testImage);
-    m_tesseract->Recognize(nullptr);
+    timedRecognize(*m_tesseract);
 
     // Calculate average confidence for this rotation
     double totalConfidence = 0.0;
@@ -4709,7 +6227,8 @@ int OCRAnalysis::findBestRotation(const cv::Mat &image) {
 OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
     const PDFElements &elements, const std::string &pdfPath, double dpi,
     const std::string &outputDir, RenderBoundsMode boundsMode,
-    const std::string &markToFile) {
+    const std::string &markToFile, bool deferWrite) {
+  TraceSpan span("renderElementsToPNG", "ocr", pdfPath);
 
   PNGRenderResult result;
 
@@ -4735,8 +6254,7 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
 
       if (largestRect == nullptr) {
         // No rectangles found - try to use largest image instead
-        std::cerr << "DEBUG: No rectangles found, checking for images..."
-                  << std::endl;
+        OCR_DEBUG << "No rectangles found, checking for images...";
 
         if (!elements.images.empty()) {
           // Find the largest image by area
@@ -4757,9 +6275,9 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
             maxX = largestImage->x + largestImage->displayWidth;
             maxY = largestImage->y + largestImage->displayHeight;
 
-            std::cerr << "DEBUG: Using largest image bounds: (" << minX << ", "
+            OCR_DEBUG << "Using largest image bounds: (" << minX << ", "
                       << minY << ") to (" << maxX << ", " << maxY << ")"
-                      << " (area: " << largestImageArea << ")" << std::endl;
+                      << " (area: " << largestImageArea << ")";
           } else {
             result.errorMessage = "Could not find valid rectangle or image";
             return result;
@@ -4783,24 +6301,24 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
         maxX = largestRect->x + largestRect->width;
         maxY = elements.pageHeight - rectTopLeftY; // Convert to bottom-left
 
-        std::cerr << "DEBUG: Found " << elements.rectangles.size()
-                  << " rectangle(s)" << std::endl;
+        OCR_DEBUG << "Found " << elements.rectangles.size()
+                  << " rectangle(s)";
         for (size_t i = 0; i < elements.rectangles.size(); i++) {
           const auto &rect = elements.rectangles[i];
           double area = rect.width * rect.height;
-          std::cerr << "  Rectangle " << i << ": (" << rect.x << ", " << rect.y
+          OCR_DEBUG << "  Rectangle " << i << ": (" << rect.x << ", " << rect.y
                     << ") size: " << rect.width << "x" << rect.height
-                    << " area: " << area << std::endl;
+                    << " area: " << area;
         }
 
-        std::cerr << "DEBUG: Rectangle top-left coords: (" << largestRect->x
+        OCR_DEBUG << "Rectangle top-left coords: (" << largestRect->x
                   << ", " << largestRect->y << ") to ("
                   << largestRect->x + largestRect->width << ", "
-                  << largestRect->y + largestRect->height << ")" << std::endl;
-        std::cerr << "DEBUG: Converted to bottom-left coords (no expansion): ("
+                  << largestRect->y + largestRect->height << ")";
+        OCR_DEBUG << "Converted to bottom-left coords (no expansion): ("
                   << minX << ", " << minY << ") to (" << maxX << ", " << maxY
                   << ")"
-                  << " (area: " << largestArea << ")" << std::endl;
+                  << " (area: " << largestArea << ")";
       }
 
     } else if (elements.linesBoundingBoxWidth > 0 &&
@@ -4811,10 +6329,9 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
       maxX = elements.linesBoundingBoxX + elements.linesBoundingBoxWidth;
       maxY = elements.linesBoundingBoxY + elements.linesBoundingBoxHeight;
 
-      std::cerr
-          << "DEBUG: Using linesBoundingBox (crop marks) as content area: ("
-          << minX << ", " << minY << ") to (" << maxX << ", " << maxY << ")"
-          << std::endl;
+      OCR_DEBUG
+          << "Using linesBoundingBox (crop marks) as content area: ("
+          << minX << ", " << minY << ") to (" << maxX << ", " << maxY << ")";
     } else {
       // Fall back to calculating bounding box from all elements
       minX = std::numeric_limits<double>::max();
@@ -4884,9 +6401,8 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
         maxY = std::max(maxY, lineMaxY);
       }
 
-      std::cerr << "DEBUG: Calculated bounding box from elements: (" << minX
-                << ", " << minY << ") to (" << maxX << ", " << maxY << ")"
-                << std::endl;
+      OCR_DEBUG << "Calculated bounding box from elements: (" << minX
+                << ", " << minY << ") to (" << maxX << ", " << maxY << ")";
     }
 
     // If no elements found, use page dimensions with origin at (0,0)
@@ -4903,15 +6419,14 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
     maxX = std::min(elements.pageX + elements.pageWidth, maxX);
     maxY = std::min(elements.pageY + elements.pageHeight, maxY);
 
-    std::cerr << "DEBUG: After clamping - minX=" << minX << ", maxX=" << maxX
-              << ", minY=" << minY << ", maxY=" << maxY << std::endl;
-    std::cerr << "DEBUG: pageWidth=" << elements.pageWidth
-              << ", pageHeight=" << elements.pageHeight << std::endl;
+    OCR_DEBUG << "After clamping - minX=" << minX << ", maxX=" << maxX
+              << ", minY=" << minY << ", maxY=" << maxY;
+    OCR_DEBUG << "pageWidth=" << elements.pageWidth
+              << ", pageHeight=" << elements.pageHeight;
 
     if (maxX <= minX || maxY <= minY) {
-      std::cerr << "DEBUG: Bounding box invalid after clamping, falling back "
-                   "to full page dimensions"
-                << std::endl;
+      OCR_DEBUG << "Bounding box invalid after clamping, falling back "
+                   "to full page dimensions";
       minX = elements.pageX;
       minY = elements.pageY;
       maxX = elements.pageX + elements.pageWidth;
@@ -4976,11 +6491,10 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
     maxX = cropBoxMaxX;
     maxY = cropBoxMaxY;
 
-    std::cerr << "DEBUG: Final content area: (" << minX << ", " << minY
+    OCR_DEBUG << "Final content area: (" << minX << ", " << minY
               << ") to (" << maxX << ", " << maxY << ")"
               << (elements.hasCropMarks ? " [from crop marks]"
-                                        : " [from largest rect/elements]")
-              << std::endl;
+                                        : " [from largest rect/elements]");
 
     // Perform OCR on embedded images ONLY if crop marks were NOT detected.
     // When crop marks are present, images are treated as purely visual
@@ -4988,20 +6502,19 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
     std::vector<TextRegion> ocrTextLines;
     if (elements.hasCropMarks) {
       if (!elements.images.empty()) {
-        std::cerr << "DEBUG: Crop marks detected â€” skipping OCR on "
+        OCR_DEBUG << "Crop marks detected â€” skipping OCR on "
                   << elements.images.size()
-                  << " embedded image(s); will render as-is" << std::endl;
+                  << " embedded image(s); will render as-is";
       }
     } else if (!elements.images.empty()) {
-      std::cerr << "DEBUG: Performing OCR on " << elements.images.size()
-                << " embedded image(s)..." << std::endl;
+      OCR_DEBUG << "Performing OCR on " << elements.images.size()
+                << " embedded image(s)...";
 
       // Initialize OCR engine if not already initialized
       if (!m_initialized) {
-        std::cerr << "DEBUG: Initializing OCR engine..." << std::endl;
+        OCR_DEBUG << "Initializing OCR engine...";
         if (!initialize()) {
-          std::cerr << "DEBUG: Failed to initialize OCR engine, skipping OCR"
-                    << std::endl;
+          OCR_DEBUG << "Failed to initialize OCR engine, skipping OCR";
         }
       }
 
@@ -5013,20 +6526,18 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
           }
 
           // Perform OCR on the image
-          std::cerr << "DEBUG: Performing OCR on image " << pdfImage.image.cols
-                    << "x" << pdfImage.image.rows << " pixels..." << std::endl;
+          OCR_DEBUG << "Performing OCR on image " << pdfImage.image.cols
+                    << "x" << pdfImage.image.rows << " pixels...";
           OCRResult ocrResult = analyzeImage(pdfImage.image);
 
           if (!ocrResult.success) {
-            std::cerr << "DEBUG: OCR failed: " << ocrResult.errorMessage
-                      << std::endl;
+            OCR_DEBUG << "OCR failed: " << ocrResult.errorMessage;
           } else if (ocrResult.regions.empty()) {
-            std::cerr << "DEBUG: OCR succeeded but found no text regions"
-                      << std::endl;
+            OCR_DEBUG << "OCR succeeded but found no text regions";
           } else {
-            std::cerr << "DEBUG: OCR found " << ocrResult.regions.size()
+            OCR_DEBUG << "OCR found " << ocrResult.regions.size()
                       << " text regions in image at (" << pdfImage.x << ", "
-                      << pdfImage.y << ")" << std::endl;
+                      << pdfImage.y << ")";
 
             // Convert OCR results to PDF coordinates
             // OCR coordinates are in pixels relative to the image
@@ -5059,8 +6570,8 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
         }
 
         if (!ocrTextLines.empty()) {
-          std::cerr << "DEBUG: Total OCR text regions extracted: "
-                    << ocrTextLines.size() << std::endl;
+          OCR_DEBUG << "Total OCR text regions extracted: "
+                    << ocrTextLines.size();
         }
       } // end if (m_initialized)
     } // end if (!elements.images.empty())
@@ -5095,10 +6606,9 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
       elem.relativeHeight = dm.height;         // height in PDF pts
       result.elements.push_back(elem);
 
-      std::cerr << "DEBUG: Using pre-detected DataMatrix \""
+      OCR_DEBUG << "Using pre-detected DataMatrix \""
                 << dm.text.substr(0, 30) << "\" at PDF (" << dm.x << ", "
-                << dm.y << ") size " << dm.width << "x" << dm.height
-                << std::endl;
+                << dm.y << ") size " << dm.width << "x" << dm.height;
     }
 
     // Remove OCR text lines that overlap with DataMatrix zones
@@ -5122,9 +6632,8 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
           ocrTextLines.end());
       auto removed = before - ocrTextLines.size();
       if (removed > 0) {
-        std::cerr << "DEBUG: Removed " << removed
-                  << " OCR text line(s) overlapping DataMatrix zone(s)"
-                  << std::endl;
+        OCR_DEBUG << "Removed " << removed
+                  << " OCR text line(s) overlapping DataMatrix zone(s)";
       }
     }
 
@@ -5178,12 +6687,12 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
     std::string outputPath = outputDir + "/" + baseName + "_rendered.png";
     result.outputPath = outputPath;
 
-    std::cerr << "Rendering to PNG: " << outputPath << std::endl;
-    std::cerr << "  DPI: " << dpi << ", Scale: " << scale << std::endl;
-    std::cerr << "  Page dimensions: " << pageWidthPt << " x " << pageHeightPt
-              << " pt" << std::endl;
-    std::cerr << "  Image size: " << imageWidth << "x" << imageHeight
-              << " pixels" << std::endl;
+    OCR_DEBUG << "Rendering to PNG: " << outputPath;
+    OCR_DEBUG << "  DPI: " << dpi << ", Scale: " << scale;
+    OCR_DEBUG << "  Page dimensions: " << pageWidthPt << " x " << pageHeightPt
+              << " pt";
+    OCR_DEBUG << "  Image size: " << imageWidth << "x" << imageHeight
+              << " pixels";
 
 #ifdef HAVE_CAIRO
 
@@ -5193,12 +6702,11 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
     // crop box.  This captures EVERYTHING â€” vector graphics, images,
     // text â€” without relying on element-by-element reconstruction.
     if (elements.hasCropMarks) {
-      std::cerr << "DEBUG: Using SplashOutputDev full-page rasterization "
-                   "(crop marks mode)"
-                << std::endl;
+      OCR_DEBUG << "Using SplashOutputDev full-page rasterization "
+                   "(crop marks mode)";
 
       try {
-        GlobalParamsIniter globalParamsInit(nullptr);
+        GlobalParamsIniter globalParamsInit(popplerErrorToLog);
 
         auto fileName = std::make_unique<GooString>(pdfPath);
         std::unique_ptr<PDFDoc> doc(new PDFDoc(std::move(fileName)));
@@ -5208,44 +6716,7 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
           return result;
         }
 
-        // Create a SplashOutputDev that renders to RGB
-        SplashColor paperColor;
-        paperColor[0] = 255;
-        paperColor[1] = 255;
-        paperColor[2] = 255;
-        SplashOutputDev splashOut(splashModeRGB8, 4, false, paperColor);
-        splashOut.startDoc(doc.get());
-
-        // Render page 1 at the requested DPI
-        doc->displayPage(&splashOut, 1, dpi, dpi, 0, true, false, false);
-
-        SplashBitmap *bitmap = splashOut.getBitmap();
-        if (!bitmap) {
-          result.errorMessage = "SplashOutputDev returned null bitmap";
-          return result;
-        }
-
-        int bmpW = bitmap->getWidth();
-        int bmpH = bitmap->getHeight();
-        int bmpRowSize = bitmap->getRowSize();
-
-        std::cerr << "DEBUG: Full page raster: " << bmpW << "x" << bmpH
-                  << " pixels (row size " << bmpRowSize << ")" << std::endl;
-
-        // Convert SplashBitmap (RGB) â†’ OpenCV Mat (BGR)
-        cv::Mat fullPage(bmpH, bmpW, CV_8UC3);
-        unsigned char *splashData = bitmap->getDataPtr();
-        for (int row = 0; row < bmpH; row++) {
-          const unsigned char *src = splashData + row * bmpRowSize;
-          unsigned char *dst = fullPage.ptr<unsigned char>(row);
-          for (int col = 0; col < bmpW; col++) {
-            dst[col * 3 + 0] = src[col * 3 + 2]; // B
-            dst[col * 3 + 1] = src[col * 3 + 1]; // G
-            dst[col * 3 + 2] = src[col * 3 + 0]; // R
-          }
-        }
-
-        // Crop to the crop box.
+        // Crop box in output pixels.
         // minX/minY/maxX/maxY are in PDF points (origin top-left in
         // Poppler's coordinate system when upsideDown() is true, which
         // SplashOutputDev defaults to).
@@ -5254,31 +6725,70 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
         // extraction already converts to top-left.  However, the crop
         // box values we have (minX, minY) are in the original PDF
         // coordinate system (bottom-left origin), so we need to convert Y.
-        double fullPageHeightPt = elements.pageY + elements.pageHeight;
         int cropX = static_cast<int>((minX - elements.pageX) * scale);
         int cropY = static_cast<int>((minY - elements.pageY) * scale);
         int cropW = static_cast<int>((maxX - minX) * scale);
         int cropH = static_cast<int>((maxY - minY) * scale);
 
-        // Clamp to bitmap bounds
+        // Clamp to the size the full-page bitmap would have.  This matches
+        // SplashOutputDev::startPage, which rounds the rotated MediaBox
+        // size at the render DPI.
+        int pageRotate = doc->getPageRotate(1);
+        double mediaW = doc->getPageMediaWidth(1);
+        double mediaH = doc->getPageMediaHeight(1);
+        if (pageRotate == 90 || pageRotate == 270)
+          std::swap(mediaW, mediaH);
+        int bmpW = std::max(1, static_cast<int>(mediaW * dpi / 72.0 + 0.5));
+        int bmpH = std::max(1, static_cast<int>(mediaH * dpi / 72.0 + 0.5));
         cropX = std::max(0, std::min(cropX, bmpW - 1));
         cropY = std::max(0, std::min(cropY, bmpH - 1));
         cropW = std::min(cropW, bmpW - cropX);
         cropH = std::min(cropH, bmpH - cropY);
 
-        std::cerr << "DEBUG: Crop region: x=" << cropX << ", y=" << cropY
-                  << ", w=" << cropW << ", h=" << cropH << std::endl;
+        OCR_DEBUG << "Crop region: x=" << cropX << ", y=" << cropY
+                  << ", w=" << cropW << ", h=" << cropH << " of " << bmpW
+                  << "x" << bmpH << " page";
+        if (cropW <= 0 || cropH <= 0)
+          throw std::runtime_error("empty crop region");
+
+        // Render only the crop rectangle.  displayPageSlice shrinks the page
+        // box to the slice, so the Splash bitmap is exactly cropW x cropH and
+        // the bleed margin is never rasterised.
+        SplashColor paperColor;
+        paperColor[0] = 255;
+        paperColor[1] = 255;
+        paperColor[2] = 255;
+        SplashOutputDev splashOut(splashModeBGR8, 4, false, paperColor);
+        splashOut.startDoc(doc.get());
+
+        timedDisplayPageSlice(*doc, &splashOut, 1, dpi, 0, true, false, false,
+                              cropX, cropY, cropW, cropH);
+
+        SplashBitmap *bitmap = splashOut.getBitmap();
+        if (!bitmap) {
+          result.errorMessage = "SplashOutputDev returned null bitmap";
+          return result;
+        }
+
+        OCR_DEBUG << "Crop-box raster: " << bitmap->getWidth() << "x"
+                  << bitmap->getHeight() << " pixels (row size "
+                  << bitmap->getRowSize() << ")";
 
-        cv::Mat cropped =
-            fullPage(cv::Rect(cropX, cropY, cropW, cropH)).clone();
+        // Splash renders BGR8 directly, so the bitmap is used in place as
+        // the output image.  It lives as long as splashOut, which outlasts
+        // every use of `cropped` below.
+        cv::Mat cropped = splashBitmapView(bitmap);
 
-        // Write PNG
-        cv::imwrite(outputPath, cropped);
+        // Write PNG, or hand the pixels back for the caller to write once.
+        // The bitmap dies with splashOut, so the returned image is a copy.
+        if (deferWrite)
+          result.image = cropped.clone();
+        else
+          writeImage(outputPath, cropped);
 
-        std::cerr << "PNG rendered successfully (rasterised): " << outputPath
-                  << std::endl;
-        std::cerr << "  Final image: " << cropped.cols << "x" << cropped.rows
-                  << " pixels" << std::endl;
+        OCR_DEBUG << "PNG rendered successfully (rasterised): " << outputPath;
+        OCR_DEBUG << "  Final image: " << cropped.cols << "x" << cropped.rows
+                  << " pixels";
 
         // Update result dimensions
         result.imageWidth = cropped.cols;
@@ -5317,9 +6827,8 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
               std::string imgSavePath =
                   outputDir + "/" + baseName + "_rendered_image_" +
                   std::to_string(++savedImageCount) + ".png";
-              cv::imwrite(imgSavePath, imgCrop);
-              std::cerr << "DEBUG: Saved rendered image crop: " << imgSavePath
-                        << std::endl;
+              writeReturnedImage(imgSavePath, imgCrop);
+              OCR_DEBUG << "Saved rendered image crop: " << imgSavePath;
             }
           } else {
             imgCrop = img.image.clone();
@@ -5380,24 +6889,28 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
         {
           cv::Mat annotated = drawElementBoxes(cropped, result.elements);
           std::string annotPath = outputDir + "/" + baseName + "_annotated.png";
-          cv::imwrite(annotPath, annotated);
-          std::cerr << "DEBUG: Saved annotated image: " << annotPath
-                    << std::endl;
+          writeImage(annotPath, annotated);
+          OCR_DEBUG << "Saved annotated image: " << annotPath;
         }
         result.success = true;
         return result;
 
       } catch (const std::exception &e) {
-        std::cerr << "WARNING: SplashOutputDev rasterisation failed ("
-                  << e.what() << "), falling back to Cairo" << std::endl;
+        OCR_WARN << "SplashOutputDev rasterisation failed ("
+                 << e.what() << "), falling back to Cairo";
         // Fall through to Cairo element-by-element rendering
       }
     }
     // ---- End SplashOutputDev path ---------------------------------
 
-    // Create Cairo image surface
-    cairo_surface_t *surface = cairo_image_surface_create(
-        CAIRO_FORMAT_ARGB32, imageWidth, imageHeight);
+    // Create Cairo image surface over a Mat we own, so the rendered pixels
+    // can be used as a cv::Mat (BGRA) without copying them out of Cairo.
+    cv::Mat canvas(imageHeight, imageWidth, CV_8UC4);
+    cairo_surface_t *surface =
+        cairoSurfaceForMat(canvas, CAIRO_FORMAT_ARGB32);
+    if (!surface)
+      surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, imageWidth,
+                                           imageHeight);
 
     if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
       result.errorMessage = "Failed to create Cairo image surface";
@@ -5530,16 +7043,15 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
         double imgRight = std::min(img.x + img.displayWidth, maxX);
         double imgBottom = std::min(img.y + img.displayHeight, maxY);
 
-        std::cerr << "DEBUG: Image at (" << img.x << ", " << img.y
+        OCR_DEBUG << "Image at (" << img.x << ", " << img.y
                   << "), size: " << img.displayWidth << " x "
                   << img.displayHeight << ", clipped bounds: (" << imgLeft
                   << ", " << imgTop << ") to (" << imgRight << ", " << imgBottom
-                  << ")" << std::endl;
+                  << ")";
 
         // Skip if image is completely outside content area
         if (imgLeft >= imgRight || imgTop >= imgBottom) {
-          std::cerr << "DEBUG: Skipping image - outside content area"
-                    << std::endl;
+          OCR_DEBUG << "Skipping image - outside content area";
           continue;
         }
 
@@ -5576,38 +7088,27 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
             cairo_scale(cr, scaleX, scaleY);
           }
 
-          // Convert BGR to RGB
-          cv::Mat rgbImage;
+          // Convert to BGRA, which is Cairo's RGB24 byte order on
+          // little-endian, and hand the buffer to Cairo without copying.
+          cv::Mat bgraImage;
           if (img.image.channels() == 1) {
-            cv::cvtColor(img.image, rgbImage, cv::COLOR_GRAY2RGB);
+            cv::cvtColor(img.image, bgraImage, cv::COLOR_GRAY2BGRA);
           } else if (img.image.channels() == 3) {
-            cv::cvtColor(img.image, rgbImage, cv::COLOR_BGR2RGB);
+            cv::cvtColor(img.image, bgraImage, cv::COLOR_BGR2BGRA);
           } else if (img.image.channels() == 4) {
-            cv::cvtColor(img.image, rgbImage, cv::COLOR_BGRA2RGB);
+            bgraImage = img.image.isContinuous() ? img.image
+                                                 : img.image.clone();
           } else {
             cairo_restore(cr);
             continue;
           }
 
-          // Create Cairo surface from RGB image
-          cairo_surface_t *imgSurface = cairo_image_surface_create(
-              CAIRO_FORMAT_RGB24, rgbImage.cols, rgbImage.rows);
-          unsigned char *data = cairo_image_surface_get_data(imgSurface);
-          int stride = cairo_image_surface_get_stride(imgSurface);
-
-          // Copy pixel data (Cairo uses BGRA on little-endian)
-          for (int row = 0; row < rgbImage.rows; row++) {
-            for (int col = 0; col < rgbImage.cols; col++) {
-              cv::Vec3b pixel = rgbImage.at<cv::Vec3b>(row, col);
-              int offset = row * stride + col * 4;
-              data[offset + 0] = pixel[2]; // B
-              data[offset + 1] = pixel[1]; // G
-              data[offset + 2] = pixel[0]; // R
-              data[offset + 3] = 255;      // A
-            }
+          cairo_surface_t *imgSurface =
+              cairoSurfaceForMat(bgraImage, CAIRO_FORMAT_RGB24);
+          if (!imgSurface) {
+            cairo_restore(cr);
+            continue;
           }
-
-          cairo_surface_mark_dirty(imgSurface);
           cairo_set_source_surface(cr, imgSurface, 0, 0);
           cairo_paint(cr);
           cairo_surface_destroy(imgSurface);
@@ -5648,11 +7149,11 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
       // Skip text outside the content area (strict containment)
       if (pdfTextLeft < minX || pdfTextRight > maxX || pdfTextBottom < minY ||
           pdfTextTop > maxY) {
-        std::cerr << "DEBUG: Filtering out text \"" << text.text.substr(0, 20)
+        OCR_DEBUG << "Filtering out text \"" << text.text.substr(0, 20)
                   << "\" pdfBox=(" << pdfTextLeft << "," << pdfTextBottom
                   << ") to (" << pdfTextRight << "," << pdfTextTop
                   << "), bounds: (" << minX << "," << minY << ") to (" << maxX
-                  << "," << maxY << ")" << std::endl;
+                  << "," << maxY << ")";
         continue;
       }
 
@@ -5660,13 +7161,13 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
       // Cairo y of text baseline = distance from content top to text bottom
       double y = pageHeightPt - (pdfTextBottom - minY) + margin;
 
-      std::cerr << "DEBUG: Rendering text at (" << x << ", " << y
+      OCR_DEBUG << "Rendering text at (" << x << ", " << y
                 << "), original PDF pos: (" << text.boundingBox.x << ", "
                 << text.boundingBox.y
                 << "), bbox width: " << text.boundingBox.width << ", text: \""
                 << text.text.substr(0, 20) << "\", font: " << text.fontName
                 << " " << text.fontSize << "pt" << (text.isBold ? " bold" : "")
-                << (text.isItalic ? " italic" : "") << std::endl;
+                << (text.isItalic ? " italic" : "");
 
       // Set font based on text region properties
       std::string fontFamily = text.fontName.empty() ? "Sans" : text.fontName;
@@ -5730,9 +7231,8 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
       // bottom-left origin.
       double y = text.boundingBox.y - minY + margin;
 
-      std::cerr << "DEBUG: Rendering OCR text at (" << x << ", " << y
-                << "), text: \"" << text.text.substr(0, 20) << "\""
-                << std::endl;
+      OCR_DEBUG << "Rendering OCR text at (" << x << ", " << y
+                << "), text: \"" << text.text.substr(0, 20) << "\"";
 
       // Use default font for OCR text
       std::string fontFamily = "Sans";
@@ -5766,14 +7266,26 @@ OCRAnalysis::PNGRenderResult OCRAnalysis::renderElementsToPNG(
       result.elements.push_back(elem);
     }
 
-    // Write to PNG
-    cairo_surface_write_to_png(surface, outputPath.c_str());
+    // Write to PNG, or hand the pixels back for the caller to write once
+    if (deferWrite) {
+      cairo_surface_flush(surface);
+      cv::Mat bgra(imageHeight, imageWidth, CV_8UC4,
+                   cairo_image_surface_get_data(surface),
+                   cairo_image_surface_get_stride(surface));
+      cv::cvtColor(bgra, result.image, cv::COLOR_BGRA2BGR);
+    } else if (canvas.data == cairo_image_surface_get_data(surface)) {
+      // The canvas Mat owns the surface pixels, so it can be queued as-is.
+      cairo_surface_flush(surface);
+      writeImage(outputPath, canvas);
+    } else {
+      cairo_surface_write_to_png(surface, outputPath.c_str());
+    }
 
     cairo_destroy(cr);
     cairo_surface_destroy(surface);
 
-    std::cerr << "PNG rendered successfully: " << outputPath << std::endl;
-    std::cerr << "  Total elements: " << result.elements.size() << std::endl;
+    OCR_DEBUG << "PNG rendered successfully: " << outputPath;
+    OCR_DEBUG << "  Total elements: " << result.elements.size();
 
     // Marking is now handled by the separate alignAndMarkElements() function
     // which provides OCR-aligned bounding boxes
@@ -5851,8 +7363,7 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
     // Load the original image for OCR analysis and marking
     cv::Mat originalImage = cv::imread(originalImagePath, cv::IMREAD_COLOR);
     if (originalImage.empty()) {
-      std::cerr << "ERROR: Could not load original image: " << originalImagePath
-                << std::endl;
+      OCR_ERROR << "Could not load original image: " << originalImagePath;
       return false;
     }
 
@@ -5866,14 +7377,13 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
     }
 
     if (!firstTextElement) {
-      std::cerr << "ERROR: No text elements found in render result"
-                << std::endl;
+      OCR_ERROR << "No text elements found in render result";
       return false;
     }
 
-    std::cerr << "First text element: \"" << firstTextElement->text
+    OCR_DEBUG << "First text element: \"" << firstTextElement->text
               << "\" at rel(" << firstTextElement->relativeX << ", "
-              << firstTextElement->relativeY << ")" << std::endl;
+              << firstTextElement->relativeY << ")";
 
     // Calculate scale factors if images have different dimensions
     double scaleX =
@@ -5881,11 +7391,11 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
     double scaleY =
         static_cast<double>(originalImage.rows) / renderResult.imageHeight;
 
-    std::cerr << "Image dimensions - Rendered: " << renderResult.imageWidth
+    OCR_DEBUG << "Image dimensions - Rendered: " << renderResult.imageWidth
               << "x" << renderResult.imageHeight
               << ", Original: " << originalImage.cols << "x"
-              << originalImage.rows << std::endl;
-    std::cerr << "Scale factors: X=" << scaleX << ", Y=" << scaleY << std::endl;
+              << originalImage.rows;
+    OCR_DEBUG << "Scale factors: X=" << scaleX << ", Y=" << scaleY;
 
     // Use Tesseract OCR on the original image in WORD mode
     tesseract::TessBaseAPI *ocr = new tesseract::TessBaseAPI();
@@ -5893,8 +7403,8 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
     // default
     if (ocr->Init("C:/tessdata/tessdata", "eng") != 0 &&
         ocr->Init(NULL, "eng") != 0) {
-      std::cerr << "ERROR: Could not initialize Tesseract" << std::endl;
-      std::cerr << "Tried paths: C:/tessdata/tessdata and default" << std::endl;
+      OCR_ERROR << "Could not initialize Tesseract";
+      OCR_ERROR << "Tried paths: C:/tessdata/tessdata and default";
       delete ocr;
       return false;
     }
@@ -5906,7 +7416,7 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
                                                       // individual words
 
     // Get word-level bounding boxes from OCR and store them
-    ocr->Recognize(0);
+    timedRecognize(*ocr);
     tesseract::ResultIterator *ri = ocr->GetIterator();
 
     // Store all OCR word boxes with their text
@@ -5944,13 +7454,11 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
     delete ocr;
 
     if (ocrBoxes.empty()) {
-      std::cerr << "WARNING: Could not find any OCR words in the original image"
-                << std::endl;
-      std::cerr << "Creating marked image without alignment adjustment"
-                << std::endl;
+      OCR_WARN << "Could not find any OCR words in the original image";
+      OCR_DEBUG << "Creating marked image without alignment adjustment";
     } else {
-      std::cerr << "Found " << ocrBoxes.size()
-                << " OCR word boxes for alignment" << std::endl;
+      OCR_DEBUG << "Found " << ocrBoxes.size()
+                << " OCR word boxes for alignment";
     }
 
     // Store per-element alignment data
@@ -5961,8 +7469,8 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
     std::map<size_t, ElementAlignment> elementAlignments; // Index -> alignment
 
     if (!ocrBoxes.empty()) {
-      std::cerr << "Performing per-element OCR alignment for "
-                << renderResult.elements.size() << " elements" << std::endl;
+      OCR_DEBUG << "Performing per-element OCR alignment for "
+                << renderResult.elements.size() << " elements";
 
       // For each text element, search for it individually
       for (size_t elemIdx = 0; elemIdx < renderResult.elements.size();
@@ -5977,9 +7485,9 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
         size_t underscoreCount =
             std::count(elem.text.begin(), elem.text.end(), '_');
         if (underscoreCount > elem.text.length() / 2) {
-          std::cerr << "Skipping element " << elemIdx
+          OCR_DEBUG << "Skipping element " << elemIdx
                     << " (mostly underscores): \"" << elem.text.substr(0, 20)
-                    << "\"" << std::endl;
+                    << "\"";
           continue;
         }
 
@@ -6029,7 +7537,7 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
 
         roiOcr->SetImage(roi.data, roi.cols, roi.rows, 3, roi.step);
         roiOcr->SetPageSegMode(tesseract::PSM_SINGLE_BLOCK);
-        roiOcr->Recognize(0);
+        timedRecognize(*roiOcr);
 
         // Clean element text for matching
         std::string elemText = elem.text;
@@ -6123,17 +7631,17 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
         if (foundMatch) {
           elementAlignments[elemIdx] = {bestOffsetX, bestOffsetY, bestOcrWidth,
                                         bestOcrHeight, true};
-          std::cerr << "Element " << elemIdx << " \"" << elem.text.substr(0, 20)
+          OCR_DEBUG << "Element " << elemIdx << " \"" << elem.text.substr(0, 20)
                     << "\": offset (" << bestOffsetX << ", " << bestOffsetY
                     << "), OCR size: " << bestOcrWidth << "x" << bestOcrHeight
-                    << ", distance: " << bestDistance << std::endl;
+                    << ", distance: " << bestDistance;
         } else {
           elementAlignments[elemIdx] = {0, 0, -1, -1, false};
         }
       }
 
       // Fill in missing alignments by interpolating from nearby elements
-      std::cerr << "Filling in missing alignments..." << std::endl;
+      OCR_DEBUG << "Filling in missing alignments...";
       for (size_t elemIdx = 0; elemIdx < renderResult.elements.size();
            elemIdx++) {
         const auto &elem = renderResult.elements[elemIdx];
@@ -6183,16 +7691,16 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
           // Copy both X and Y offsets from nearest neighbor
           elementAlignments[elemIdx] = {nearestAlignment.offsetX,
                                         nearestAlignment.offsetY, -1, -1, true};
-          std::cerr << "Element " << elemIdx << " \"" << elem.text.substr(0, 20)
+          OCR_DEBUG << "Element " << elemIdx << " \"" << elem.text.substr(0, 20)
                     << "\": using offset from element " << nearestIdx << " ("
                     << nearestAlignment.offsetX << ", "
-                    << nearestAlignment.offsetY << ")" << std::endl;
+                    << nearestAlignment.offsetY << ")";
         }
       }
     }
 
     // Detect and resolve overlaps
-    std::cerr << "Checking for overlapping boxes..." << std::endl;
+    OCR_DEBUG << "Checking for overlapping boxes...";
 
     // Build list of boxes with their element info
     struct BoxInfo {
@@ -6256,8 +7764,7 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
 
     // Group boxes by fontSize and calculate uniform heights
     std::map<double, int> fontSizeToUniformHeight;
-    std::cerr << "Calculating uniform heights for each fontSize group..."
-              << std::endl;
+    OCR_DEBUG << "Calculating uniform heights for each fontSize group...";
 
     // First pass: find maximum height needed for each fontSize
     for (const auto &box : boxes) {
@@ -6275,10 +7782,10 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
     const int VERTICAL_PADDING = 4; // pixels of padding above and below
     for (auto &pair : fontSizeToUniformHeight) {
       pair.second += VERTICAL_PADDING * 2;
-      std::cerr << "  fontSize " << pair.first
+      OCR_DEBUG << "  fontSize " << pair.first
                 << "pt: uniform height = " << pair.second
                 << " pixels (includes " << (VERTICAL_PADDING * 2)
-                << "px padding)" << std::endl;
+                << "px padding)";
     }
 
     // Second pass: apply uniform heights and center vertically
@@ -6291,16 +7798,15 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
       box.y -= heightDiff / 2;
       box.height = uniformHeight;
 
-      std::cerr << "Element " << box.elemIdx << " \"" << box.text.substr(0, 20)
+      OCR_DEBUG << "Element " << box.elemIdx << " \"" << box.text.substr(0, 20)
                 << "\": fontSize=" << box.fontSize << "pt, adjusted height "
                 << oldHeight << " â†’ " << uniformHeight << ", y offset "
-                << (heightDiff / 2) << std::endl;
+                << (heightDiff / 2);
     }
 
     // Check for vertical overlaps and adjust Y positions (preserve uniform
     // heights)
-    std::cerr << "Resolving overlaps while preserving uniform heights..."
-              << std::endl;
+    OCR_DEBUG << "Resolving overlaps while preserving uniform heights...";
     for (size_t i = 0; i < boxes.size(); i++) {
       for (size_t j = i + 1; j < boxes.size(); j++) {
         auto &box1 = boxes[i];
@@ -6319,31 +7825,30 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
             std::min(box1Bottom, box2Bottom) - std::max(box1.y, box2.y);
 
         if (vOverlap > 0) {
-          std::cerr << "Overlap detected between element " << box1.elemIdx
-                    << " and " << box2.elemIdx << " (" << vOverlap << " pixels)"
-                    << std::endl;
+          OCR_DEBUG << "Overlap detected between element " << box1.elemIdx
+                    << " and " << box2.elemIdx << " (" << vOverlap << " pixels)";
 
           // Adjust Y position of lower box to avoid overlap (preserve
           // height!)
           if (box1.y < box2.y) {
             int newBox2Y = box1Bottom;
             box2.y = newBox2Y;
-            std::cerr << "  Moved element " << box2.elemIdx
+            OCR_DEBUG << "  Moved element " << box2.elemIdx
                       << " down to Y=" << newBox2Y << " (height preserved at "
-                      << box2.height << ")" << std::endl;
+                      << box2.height << ")";
           } else {
             int newBox1Y = box2Bottom;
             box1.y = newBox1Y;
-            std::cerr << "  Moved element " << box1.elemIdx
+            OCR_DEBUG << "  Moved element " << box1.elemIdx
                       << " down to Y=" << newBox1Y << " (height preserved at "
-                      << box1.height << ")" << std::endl;
+                      << box1.height << ")";
           }
         }
       }
     }
 
     // Expand boxes horizontally to maximize width without overlapping
-    std::cerr << "Expanding boxes horizontally..." << std::endl;
+    OCR_DEBUG << "Expanding boxes horizontally...";
     for (auto &box : boxes) {
       // Find the maximum width we can expand to
       int maxExpandLeft = box.x; // Can expand to left edge of image
@@ -6390,19 +7895,18 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
         int oldWidth = box.width;
         box.x -= expandLeft;
         box.width += expandLeft + expandRight;
-        std::cerr << "Element " << box.elemIdx << ": expanded width "
+        OCR_DEBUG << "Element " << box.elemIdx << ": expanded width "
                   << oldWidth << " â†’ " << box.width << " (left+" << expandLeft
-                  << ", right+" << expandRight << ")" << std::endl;
+                  << ", right+" << expandRight << ")";
       }
     }
 
     // Verify each box still contains correct text using OCR
-    std::cerr << "Verifying boxes with OCR..." << std::endl;
+    OCR_DEBUG << "Verifying boxes with OCR...";
     tesseract::TessBaseAPI *verifyOcr = new tesseract::TessBaseAPI();
     if (verifyOcr->Init("C:/tessdata/tessdata", "eng") != 0 &&
         verifyOcr->Init(NULL, "eng") != 0) {
-      std::cerr << "WARNING: Could not initialize OCR for verification"
-                << std::endl;
+      OCR_WARN << "Could not initialize OCR for verification";
     } else {
       for (auto &box : boxes) {
         // Extract ROI
@@ -6473,11 +7977,10 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
               (similarity >= 0.7); // 70% similarity threshold
           box.matches = matches; // remember for colour selection later
 
-          std::cerr << "Element " << box.elemIdx << " \"" << box.text
+          OCR_DEBUG << "Element " << box.elemIdx << " \"" << box.text
                     << "\": OCR=\"" << detectedText
                     << "\" similarity=" << std::fixed << std::setprecision(2)
-                    << similarity << " " << (matches ? "âœ“" : "âœ—")
-                    << std::endl;
+                    << similarity << " " << (matches ? "âœ“" : "âœ—");
 
           delete[] ocrText;
 
@@ -6487,9 +7990,9 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
           int expectedHeight = static_cast<int>(fontSizePixels * 1.2);
 
           if (box.height > expectedHeight * 1.5 && expectedText.length() <= 5) {
-            std::cerr << "  Box too tall (" << box.height << " vs expected "
+            OCR_DEBUG << "  Box too tall (" << box.height << " vs expected "
                       << expectedHeight << " from " << box.fontSize
-                      << "pt font), attempting to shrink..." << std::endl;
+                      << "pt font), attempting to shrink...";
 
             // Try shrinking from bottom
             int originalHeight = box.height;
@@ -6531,8 +8034,8 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
                 if (testMatches && testSim >= similarity) {
                   box.height = testHeight;
                   similarity = testSim;
-                  std::cerr << "  Shrunk to height " << testHeight
-                            << ", similarity=" << testSim << std::endl;
+                  OCR_DEBUG << "  Shrunk to height " << testHeight
+                            << ", similarity=" << testSim;
                   break;
                 }
 
@@ -6570,19 +8073,18 @@ bool OCRAnalysis::alignAndMarkElements(const std::string &renderedImagePath,
       }
     }
 
-    std::cerr << "Drew " << drawnCount << " non-overlapping boxes" << std::endl;
+    OCR_DEBUG << "Drew " << drawnCount << " non-overlapping boxes";
 
     // Save the marked image
     if (cv::imwrite(outputPath, markedImage)) {
-      std::cerr << "Aligned marked image saved: " << outputPath << std::endl;
+      OCR_DEBUG << "Aligned marked image saved: " << outputPath;
       return true;
     } else {
-      std::cerr << "ERROR: Failed to save aligned marked image: " << outputPath
-                << std::endl;
+      OCR_ERROR << "Failed to save aligned marked image: " << outputPath;
       return false;
     }
   } catch (const std::exception &e) {
-    std::cerr << "ERROR in alignAndMarkElements: " << e.what() << std::endl;
+    OCR_DEBUG << "ERROR in alignAndMarkElements: " << e.what();
     return false;
   }
 }
@@ -6743,19 +8245,18 @@ OCRAnalysis::stripBleedMarks(const std::string &pdfPath) {
       }
     }
 
-    std::cerr << "DEBUG: Removed " << rectanglesToRemove.size()
+    OCR_DEBUG << "Removed " << rectanglesToRemove.size()
               << " bleed mark rectangles and " << linesToRemove.size()
-              << " associated lines" << std::endl;
-    std::cerr << "DEBUG: Remaining: " << filteredRectangles.size()
-              << " rectangles, " << filteredLines.size() << " lines"
-              << std::endl;
+              << " associated lines";
+    OCR_DEBUG << "Remaining: " << filteredRectangles.size()
+              << " rectangles, " << filteredLines.size() << " lines";
 
     // Show first few remaining lines for debugging
-    std::cerr << "DEBUG: First 10 remaining lines:" << std::endl;
+    OCR_DEBUG << "First 10 remaining lines:";
     for (size_t i = 0; i < std::min(size_t(10), filteredLines.size()); i++) {
       const auto &line = filteredLines[i];
-      std::cerr << "  Line " << i << ": (" << line.x1 << "," << line.y1
-                << ") to (" << line.x2 << "," << line.y2 << ")" << std::endl;
+      OCR_DEBUG << "  Line " << i << ": (" << line.x1 << "," << line.y1
+                << ") to (" << line.x2 << "," << line.y2 << ")";
     }
 
     // STEP 2: Detect crop marks from remaining lines
@@ -6927,11 +8428,11 @@ OCRAnalysis::stripBleedMarks(const std::string &pdfPath) {
       return result;
     }
 
-    std::cerr << "DEBUG: Found " << cropMarks.size()
-              << " crop marks:" << std::endl;
+    OCR_DEBUG << "Found " << cropMarks.size()
+              << " crop marks:";
     for (size_t i = 0; i < cropMarks.size(); i++) {
-      std::cerr << "  Crop mark " << i << ": (" << cropMarks[i].cropX << ", "
-                << cropMarks[i].cropY << ")" << std::endl;
+      OCR_DEBUG << "  Crop mark " << i << ": (" << cropMarks[i].cropX << ", "
+                << cropMarks[i].cropY << ")";
     }
 
     // Select the 4 corner-most crop marks
@@ -0,0 +1,137 @@
+#include "StageProfile.hpp"
+
+#include <ctime>
+#include <tesseract/baseapi.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace ocr {
+
+namespace {
+
+thread_local ProfileRecorder *t_current = nullptr;
+
+} // namespace
+
+double processCpuMs() {
+#ifdef _WIN32
+  FILETIME created, exited, kernel, user;
+  if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+    return 0;
+  auto ticks = [](const FILETIME &t) {
+    return (static_cast<std::uint64_t>(t.dwHighDateTime) << 32) |
+           t.dwLowDateTime;
+  };
+  return (ticks(kernel) + ticks(user)) / 10000.0; // 100 ns units
+#else
+  timespec ts;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0)
+    return 0;
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1.0e6;
+#endif
+}
+
+double threadCpuMs() {
+#ifdef _WIN32
+  FILETIME created, exited, kernel, user;
+  if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user))
+    return 0;
+  auto ticks = [](const FILETIME &t) {
+    return (static_cast<std::uint64_t>(t.dwHighDateTime) << 32) |
+           t.dwLowDateTime;
+  };
+  return (ticks(kernel) + ticks(user)) / 10000.0; // 100 ns units
+#else
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    return 0;
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1.0e6;
+#endif
+}
+
+int timedRecognize(tesseract::TessBaseAPI &api) {
+  int status;
+  {
+    TraceSpan span("TessBaseAPI::Recognize", "tesseract");
+    status = api.Recognize(nullptr);
+  }
+  ProfileRecorder::countRecognize();
+  return status;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// StageProfile
+// ─────────────────────────────────────────────────────────────────────────────
+
+const StageTiming *StageProfile::find(std::string_view name) const {
+  for (const auto &s : stages)
+    if (s.name == name)
+      return &s;
+  return nullptr;
+}
+
+void StageProfile::merge(const StageProfile &child, std::string_view prefix) {
+  displayPageCalls += child.displayPageCalls;
+  recognizeCalls += child.recognizeCalls;
+  pixelsRendered += child.pixelsRendered;
+  for (const auto &s : child.stages) {
+    StageTiming t = s;
+    t.name = std::string(prefix) + "/" + s.name;
+    stages.push_back(std::move(t));
+  }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// ProfileRecorder
+// ─────────────────────────────────────────────────────────────────────────────
+
+ProfileRecorder::ProfileRecorder(StageProfile &profile)
+    : m_profile(profile), m_previous(t_current) {
+  t_current = this;
+}
+
+ProfileRecorder::~ProfileRecorder() { t_current = m_previous; }
+
+// static
+ProfileRecorder *ProfileRecorder::current() { return t_current; }
+
+// static
+void ProfileRecorder::countDisplayPage(std::uint64_t pixels) {
+  if (t_current) {
+    ++t_current->m_profile.displayPageCalls;
+    t_current->m_profile.pixelsRendered += pixels;
+  }
+}
+
+// static
+void ProfileRecorder::countRecognize() {
+  if (t_current)
+    ++t_current->m_profile.recognizeCalls;
+}
+
+ProfileRecorder::Stage::Stage(const char *name)
+    : m_recorder(t_current), m_name(name), m_span(name, "stage") {
+  if (m_recorder) {
+    m_wallStart = std::chrono::steady_clock::now();
+    m_cpuStartMs = threadCpuMs();
+  }
+}
+
+void ProfileRecorder::Stage::stop() {
+  m_span.end();
+  if (!m_recorder)
+    return;
+  StageTiming t;
+  t.name = m_name;
+  t.wallMs = std::chrono::duration<double, std::milli>(
+                 std::chrono::steady_clock::now() - m_wallStart)
+                 .count();
+  t.cpuMs = threadCpuMs() - m_cpuStartMs;
+  m_recorder->m_profile.stages.push_back(std::move(t));
+  m_recorder = nullptr;
+}
+
+} // namespace ocr
@@ -0,0 +1,137 @@
+#include "Trace.hpp"
+#include "JsonString.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ocr {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct TraceEvent {
+  const char *name;
+  const char *category;
+  std::string detail;
+  std::int64_t beginUs; ///< Relative to the trace epoch
+  std::int64_t durationUs;
+};
+
+/// Events recorded by one thread.  The mutex is only contended while
+/// writeJson() or start() walks the buffers.
+struct ThreadBuffer {
+  std::uint32_t tid = 0;
+  std::mutex mutex;
+  std::vector<TraceEvent> events;
+};
+
+// Buffers outlive their threads so events of finished workers are written.
+std::mutex g_registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> g_buffers;
+std::atomic<Clock::rep> g_epoch{Clock::now().time_since_epoch().count()};
+
+ThreadBuffer &threadBuffer() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+    auto b = std::make_shared<ThreadBuffer>();
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    b->tid = static_cast<std::uint32_t>(g_buffers.size() + 1);
+    g_buffers.push_back(b);
+    return b;
+  }();
+  return *buffer;
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::s_enabled{false};
+
+// static
+void Tracer::start() {
+  std::lock_guard<std::mutex> lock(g_registryMutex);
+  for (auto &b : g_buffers) {
+    std::lock_guard<std::mutex> bufferLock(b->mutex);
+    b->events.clear();
+  }
+  g_epoch.store(Clock::now().time_since_epoch().count(),
+                std::memory_order_relaxed);
+  s_enabled.store(true, std::memory_order_relaxed);
+}
+
+// static
+void Tracer::stop() { s_enabled.store(false, std::memory_order_relaxed); }
+
+// static
+void Tracer::record(const char *name, const char *category,
+                    std::string &&detail, Clock::time_point begin,
+                    Clock::time_point end) {
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  Clock::time_point epoch{
+      Clock::duration(g_epoch.load(std::memory_order_relaxed))};
+  ThreadBuffer &b = threadBuffer();
+  std::lock_guard<std::mutex> lock(b.mutex);
+  b.events.push_back(
+      {name, category, std::move(detail),
+       duration_cast<microseconds>(begin - epoch).count(),
+       duration_cast<microseconds>(end - begin).count()});
+}
+
+// static
+size_t Tracer::eventCount() {
+  std::lock_guard<std::mutex> lock(g_registryMutex);
+  size_t n = 0;
+  for (auto &b : g_buffers) {
+    std::lock_guard<std::mutex> bufferLock(b->mutex);
+    n += b->events.size();
+  }
+  return n;
+}
+
+// static
+bool Tracer::writeJson(const std::string &path) {
+  std::ofstream out(path, std::ios::binary);
+  if (!out)
+    return false;
+
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  std::string line;
+  std::lock_guard<std::mutex> lock(g_registryMutex);
+  for (auto &b : g_buffers) {
+    std::lock_guard<std::mutex> bufferLock(b->mutex);
+    if (b->events.empty())
+      continue;
+
+    line = first ? "\n" : ",\n";
+    first = false;
+    line += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" +
+            std::to_string(b->tid) + ",\"args\":{\"name\":\"thread " +
+            std::to_string(b->tid) + "\"}}";
+    out << line;
+
+    for (const auto &e : b->events) {
+      line = ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(b->tid) +
+             ",\"ts\":" + std::to_string(e.beginUs) +
+             ",\"dur\":" + std::to_string(e.durationUs) + ",\"name\":";
+      appendJsonString(line, e.name);
+      line += ",\"cat\":";
+      appendJsonString(line, e.category);
+      if (!e.detail.empty()) {
+        line += ",\"args\":{\"detail\":";
+        appendJsonString(line, e.detail.c_str());
+        line += "}";
+      }
+      line += "}";
+      out << line;
+    }
+    b->events.clear();
+  }
+  out << "\n]}\n";
+  return static_cast<bool>(out);
+}
+
+} // namespace ocr
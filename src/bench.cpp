@@ -0,0 +1,516 @@
+// bench: repeatable timings of the library's main entry points over the
+// PDFs and photos checked into the repository.
+//
+// Each case does its preparation (loading images, extracting the PDF a
+// render or map needs, ...) once, runs one untimed warm-up, and then
+// repeats the measured call until --min-time has elapsed.  That is done
+// --repetitions times and the per-call wall and process CPU times are
+// summarised.  Results are written as JSON, one benchmark per line, so two
+// runs can be diffed directly or compared with --baseline.
+//
+// Cases (the corpus directory defaults to the source tree):
+//
+//   extractTextFromPDF/<pdf>           Word level
+//   extractPDFElements/<pdf>
+//   renderElementsToPNG/<pdf>/dpi:<N>  72, 150 and 300 dpi, no PNG encode
+//   createRelativeMap/<pdf>            against images/<pdf>_rendered.png
+//   checkImage/<pdf>                   same photo, map built in setup
+//   cleanupForOCR/<image>              every image in images/ and render/
+//   cropToLabel/<image>
+
+#include "JsonString.hpp"
+#include "Log.hpp"
+#include "OCRAnalysis.hpp"
+#include "StageProfile.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef OCR_BENCH_CORPUS_DIR
+#define OCR_BENCH_CORPUS_DIR "."
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The PDFs in the repository root, in the order they are benchmarked.
+const char *const kCorpusPdfs[] = {"L20033877", "L10045085", "uuu", "zzz",
+                                   "kkkk"};
+const double kRenderDpis[] = {72.0, 150.0, 300.0};
+
+struct BenchCase {
+  std::string name;
+  /// Runs once before timing; returns an error message to skip the case.
+  std::function<std::string()> setup;
+  /// Runs untimed before every measured call (e.g. to restore an input the
+  /// call modifies).  Optional.
+  std::function<void()> reset;
+  /// The measured call; returns an error message on failure.
+  std::function<std::string()> run;
+};
+
+struct BenchResult {
+  std::string name;
+  std::string error;
+  int repetitions = 0;
+  long iterations = 0; ///< Measured calls over all repetitions
+  // Per-call times, one sample per repetition, in milliseconds.
+  std::vector<double> wallMs;
+  std::vector<double> cpuMs;
+};
+
+struct Options {
+  fs::path corpus = OCR_BENCH_CORPUS_DIR;
+  std::string filter;
+  double minTime = 0.5; ///< Seconds of measured calls per repetition
+  int repetitions = 5;
+  long maxIterations = 1000;
+  int threads = -1; ///< cv::setNumThreads value; -1 leaves OpenCV's default
+  std::string outPath;
+  std::string baselinePath;
+  bool list = false;
+};
+
+using ocr::jsonString;
+
+double median(std::vector<double> v) {
+  if (v.empty())
+    return 0;
+  std::sort(v.begin(), v.end());
+  size_t n = v.size();
+  return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+double mean(const std::vector<double> &v) {
+  if (v.empty())
+    return 0;
+  double sum = 0;
+  for (double x : v)
+    sum += x;
+  return sum / v.size();
+}
+
+double stddev(const std::vector<double> &v) {
+  if (v.size() < 2)
+    return 0;
+  double m = mean(v), sq = 0;
+  for (double x : v)
+    sq += (x - m) * (x - m);
+  return std::sqrt(sq / (v.size() - 1));
+}
+
+std::vector<fs::path> imagesIn(const fs::path &dir) {
+  std::vector<fs::path> out;
+  std::error_code ec;
+  for (const auto &entry : fs::directory_iterator(dir, ec)) {
+    std::string ext = entry.path().extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (entry.is_regular_file() &&
+        (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp"))
+      out.push_back(entry.path());
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+std::string formatDouble(double v) {
+  std::ostringstream out;
+  out.precision(6);
+  out << v;
+  return out.str();
+}
+
+// ── Cases ───────────────────────────────────────────────────────────────────
+
+// State shared by the cases of one PDF; built by the first setup that needs
+// it so that filtering down to one case does not pay for the others.
+struct PdfFixture {
+  fs::path pdf;
+  fs::path photoPath;
+  ocr::OCRAnalysis::PDFElements elements;
+  bool extracted = false;
+  cv::Mat photo;
+  ocr::OCRAnalysis::RelativeMapResult map;
+
+  std::string extract(ocr::OCRAnalysis &analyzer) {
+    if (!extracted) {
+      elements = analyzer.extractPDFElements(pdf.string());
+      extracted = true;
+    }
+    return elements.success ? "" : "extractPDFElements: " +
+                                       elements.errorMessage;
+  }
+
+  std::string loadPhoto() {
+    if (photo.empty())
+      photo = cv::imread(photoPath.string());
+    return photo.empty() ? "cannot load " + photoPath.string() : "";
+  }
+};
+
+void addPdfCases(std::vector<BenchCase> &cases, ocr::OCRAnalysis &analyzer,
+                 const fs::path &corpus, const fs::path &scratchDir) {
+  for (const char *stem : kCorpusPdfs) {
+    auto fx = std::make_shared<PdfFixture>();
+    fx->pdf = corpus / (std::string(stem) + ".pdf");
+    fx->photoPath = corpus / "images" / (std::string(stem) + "_rendered.png");
+    if (!fs::exists(fx->pdf))
+      continue;
+    std::string pdf = fx->pdf.string();
+
+    cases.push_back({"extractTextFromPDF/" + std::string(stem), nullptr,
+                     nullptr, [&analyzer, pdf] {
+                       auto r = analyzer.extractTextFromPDF(pdf);
+                       return r.success ? std::string() : r.errorMessage;
+                     }});
+
+    cases.push_back({"extractPDFElements/" + std::string(stem), nullptr,
+                     nullptr, [&analyzer, pdf] {
+                       auto r = analyzer.extractPDFElements(pdf);
+                       return r.success ? std::string() : r.errorMessage;
+                     }});
+
+    // The bounds mode pdfcheck uses for this file: crop marks for L2,
+    // the largest rectangle otherwise.
+    const bool l2 = (stem[0] == 'L' || stem[0] == 'l') && stem[1] == '2';
+    const auto boundsMode =
+        l2 ? ocr::OCRAnalysis::RenderBoundsMode::USE_CROP_MARKS
+           : ocr::OCRAnalysis::RenderBoundsMode::USE_LARGEST_RECTANGLE;
+    for (double dpi : kRenderDpis) {
+      cases.push_back(
+          {"renderElementsToPNG/" + std::string(stem) +
+               "/dpi:" + std::to_string(static_cast<int>(dpi)),
+           [&analyzer, fx] { return fx->extract(analyzer); }, nullptr,
+           [&analyzer, fx, pdf, dpi, scratchDir, boundsMode] {
+             auto r = analyzer.renderElementsToPNG(
+                 fx->elements, pdf, dpi, scratchDir.string(), boundsMode, "",
+                 true);
+             return r.success ? std::string() : r.errorMessage;
+           }});
+    }
+
+    if (!fs::exists(fx->photoPath))
+      continue;
+
+    cases.push_back(
+        {"createRelativeMap/" + std::string(stem),
+         [&analyzer, fx] {
+           std::string err = fx->extract(analyzer);
+           return err.empty() ? fx->loadPhoto() : err;
+         },
+         nullptr,
+         [&analyzer, fx, pdf] {
+           auto r = analyzer.createRelativeMap(
+               fx->elements, fx->photo, fx->photoPath.string(), false, pdf);
+           return r.success ? std::string() : r.errorMessage;
+         }});
+
+    // checkImage draws on the photo it is given, so each call gets a fresh
+    // copy, made outside the timed region.
+    auto working = std::make_shared<cv::Mat>();
+    cases.push_back(
+        {"checkImage/" + std::string(stem),
+         [&analyzer, fx, pdf] {
+           std::string err = fx->extract(analyzer);
+           if (err.empty())
+             err = fx->loadPhoto();
+           if (!err.empty())
+             return err;
+           fx->map = analyzer.createRelativeMap(
+               fx->elements, fx->photo, fx->photoPath.string(), false, pdf);
+           if (!fx->map.success)
+             return "createRelativeMap: " + fx->map.errorMessage;
+           return fx->map.hasCropRect ? std::string()
+                                      : std::string("photo not registered");
+         },
+         [fx, working] { fx->photo.copyTo(*working); },
+         [&analyzer, fx, working] {
+           // A mismatch is a valid outcome here; only the time matters.
+           analyzer.checkImage(fx->map, *working, {});
+           return std::string();
+         }});
+  }
+}
+
+void addImageCases(std::vector<BenchCase> &cases, const fs::path &corpus) {
+  std::vector<fs::path> paths = imagesIn(corpus / "images");
+  for (const auto &p : imagesIn(corpus / "render"))
+    paths.push_back(p);
+
+  for (const auto &path : paths) {
+    std::string label =
+        path.parent_path().filename().string() + "/" + path.stem().string();
+    auto image = std::make_shared<cv::Mat>();
+    auto load = [image, path] {
+      if (image->empty())
+        *image = cv::imread(path.string(), cv::IMREAD_UNCHANGED);
+      return image->empty() ? "cannot load " + path.string() : std::string();
+    };
+
+    auto buffers = std::make_shared<ocr::OCRAnalysis::CleanupBuffers>();
+    auto output = std::make_shared<cv::Mat>();
+    cases.push_back({"cleanupForOCR/" + label, load, nullptr,
+                     [image, buffers, output] {
+                       ocr::OCRAnalysis::cleanupForOCR(*image, *output,
+                                                       *buffers);
+                       return std::string();
+                     }});
+
+    cases.push_back({"cropToLabel/" + label, load, nullptr, [image] {
+                       cv::Mat crop = ocr::OCRAnalysis::cropToLabel(*image);
+                       (void)crop;
+                       return std::string();
+                     }});
+  }
+}
+
+// ── Measurement ─────────────────────────────────────────────────────────────
+
+BenchResult measure(BenchCase &c, const Options &opt) {
+  BenchResult result;
+  result.name = c.name;
+  try {
+    if (c.setup)
+      result.error = c.setup();
+    if (result.error.empty()) {
+      if (c.reset)
+        c.reset();
+      result.error = c.run(); // warm-up: caches, lazy engines, page faults
+    }
+    if (!result.error.empty())
+      return result;
+
+    for (int rep = 0; rep < opt.repetitions; ++rep) {
+      double wall = 0, cpu = 0;
+      long n = 0;
+      while (n < opt.maxIterations && (n == 0 || wall < opt.minTime * 1000)) {
+        if (c.reset)
+          c.reset();
+        double cpu0 = ocr::processCpuMs();
+        auto t0 = Clock::now();
+        std::string err = c.run();
+        wall += std::chrono::duration<double, std::milli>(Clock::now() - t0)
+                    .count();
+        cpu += ocr::processCpuMs() - cpu0;
+        ++n;
+        if (!err.empty()) {
+          result.error = err;
+          return result;
+        }
+      }
+      result.wallMs.push_back(wall / n);
+      result.cpuMs.push_back(cpu / n);
+      result.iterations += n;
+      ++result.repetitions;
+    }
+  } catch (const std::exception &e) {
+    result.error = e.what();
+  }
+  return result;
+}
+
+std::string resultRecord(const BenchResult &r) {
+  std::ostringstream out;
+  out << "{\"name\":" << jsonString(r.name);
+  if (!r.error.empty()) {
+    out << ",\"error\":" << jsonString(r.error) << "}";
+    return out.str();
+  }
+  out << ",\"repetitions\":" << r.repetitions
+      << ",\"iterations\":" << r.iterations
+      << ",\"real_time_ms\":{\"median\":" << formatDouble(median(r.wallMs))
+      << ",\"mean\":" << formatDouble(mean(r.wallMs))
+      << ",\"min\":"
+      << formatDouble(*std::min_element(r.wallMs.begin(), r.wallMs.end()))
+      << ",\"stddev\":" << formatDouble(stddev(r.wallMs))
+      << "},\"cpu_time_ms\":{\"median\":" << formatDouble(median(r.cpuMs))
+      << ",\"mean\":" << formatDouble(mean(r.cpuMs)) << "}}";
+  return out.str();
+}
+
+std::string contextRecord(const Options &opt) {
+  std::time_t now = std::time(nullptr);
+  char date[32];
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+  std::ostringstream out;
+  out << "{\"date\":" << jsonString(date)
+      << ",\"library_version\":"
+      << jsonString(ocr::OCRAnalysis::getLibraryVersion())
+#ifdef NDEBUG
+      << ",\"build_type\":\"release\""
+#else
+      << ",\"build_type\":\"debug\""
+#endif
+      << ",\"num_cpus\":" << std::thread::hardware_concurrency()
+      << ",\"opencv_threads\":" << cv::getNumThreads()
+      << ",\"min_time_s\":" << opt.minTime
+      << ",\"repetitions\":" << opt.repetitions
+      << ",\"corpus\":" << jsonString(opt.corpus.string()) << "}";
+  return out.str();
+}
+
+// Median wall time per benchmark name from a file written by this tool.
+// Only the fields this tool writes are understood, one benchmark per line.
+std::map<std::string, double> readBaseline(const std::string &path) {
+  std::map<std::string, double> out;
+  std::ifstream in(path);
+  std::string line;
+  const std::string nameKey = "{\"name\":\"";
+  const std::string medianKey = "\"real_time_ms\":{\"median\":";
+  while (std::getline(in, line)) {
+    auto n = line.find(nameKey);
+    auto m = line.find(medianKey);
+    if (n == std::string::npos || m == std::string::npos)
+      continue;
+    n += nameKey.size();
+    auto end = line.find('"', n);
+    if (end == std::string::npos)
+      continue;
+    out[line.substr(n, end - n)] =
+        std::atof(line.c_str() + m + medianKey.size());
+  }
+  return out;
+}
+
+void printUsage(const char *argv0) {
+  std::cerr
+      << "Usage: " << argv0 << " [options]\n"
+      << "\n"
+      << "  --corpus DIR       Directory holding the PDFs, images/ and\n"
+      << "                     render/ (default: the source tree)\n"
+      << "  --filter TEXT      Only run cases whose name contains TEXT\n"
+      << "  --min-time SEC     Measured time per repetition (default 0.5)\n"
+      << "  --repetitions N    Repetitions per case (default 5)\n"
+      << "  --max-iterations N Cap on calls per repetition (default 1000)\n"
+      << "  --threads N        OpenCV worker threads (default: OpenCV's)\n"
+      << "  --out FILE         Write JSON results to FILE (default: stdout)\n"
+      << "  --baseline FILE    Compare medians with an earlier --out file\n"
+      << "  --list             List case names and exit\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  Options opt;
+  for (int a = 1; a < argc; ++a) {
+    std::string arg = argv[a];
+    bool hasValue = a + 1 < argc;
+    if (arg == "--corpus" && hasValue) {
+      opt.corpus = argv[++a];
+    } else if (arg == "--filter" && hasValue) {
+      opt.filter = argv[++a];
+    } else if (arg == "--min-time" && hasValue) {
+      opt.minTime = std::atof(argv[++a]);
+    } else if (arg == "--repetitions" && hasValue) {
+      opt.repetitions = std::max(1, std::atoi(argv[++a]));
+    } else if (arg == "--max-iterations" && hasValue) {
+      opt.maxIterations = std::max(1L, std::atol(argv[++a]));
+    } else if (arg == "--threads" && hasValue) {
+      opt.threads = std::atoi(argv[++a]);
+    } else if (arg == "--out" && hasValue) {
+      opt.outPath = argv[++a];
+    } else if (arg == "--baseline" && hasValue) {
+      opt.baselinePath = argv[++a];
+    } else if (arg == "--list") {
+      opt.list = true;
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  // Library diagnostics would only add noise (and time) to the numbers.
+  if (ocr::Log::level() < ocr::LogLevel::Warning)
+    ocr::Log::setLevel(ocr::LogLevel::Warning);
+  if (opt.threads >= 0)
+    cv::setNumThreads(opt.threads);
+
+  // A directory of our own, since it is removed on the way out and other
+  // runs may be going at the same time.
+  fs::path scratchDir;
+  std::random_device random;
+  do {
+    scratchDir = fs::temp_directory_path() /
+                 ("ocr_bench_" + std::to_string(random()));
+  } while (!fs::create_directory(scratchDir));
+
+  ocr::OCRConfig config;
+  ocr::OCRAnalysis analyzer(config);
+  std::vector<BenchCase> cases;
+  addPdfCases(cases, analyzer, opt.corpus, scratchDir);
+  addImageCases(cases, opt.corpus);
+  if (!opt.filter.empty())
+    std::erase_if(cases, [&](const BenchCase &c) {
+      return c.name.find(opt.filter) == std::string::npos;
+    });
+
+  if (opt.list) {
+    for (const auto &c : cases)
+      std::cout << c.name << "\n";
+    return 0;
+  }
+  if (cases.empty()) {
+    std::cerr << "No benchmark cases found under " << opt.corpus << std::endl;
+    return 1;
+  }
+
+  std::ofstream file;
+  if (!opt.outPath.empty()) {
+    file.open(opt.outPath);
+    if (!file) {
+      std::cerr << "Error: cannot write " << opt.outPath << std::endl;
+      return 1;
+    }
+  }
+  std::ostream &out = opt.outPath.empty() ? std::cout : file;
+
+  std::map<std::string, double> baseline;
+  if (!opt.baselinePath.empty())
+    baseline = readBaseline(opt.baselinePath);
+
+  out << "{\"context\":" << contextRecord(opt) << ",\n\"benchmarks\":[\n";
+  bool failed = false;
+  for (size_t i = 0; i < cases.size(); ++i) {
+    BenchResult r = measure(cases[i], opt);
+    out << resultRecord(r) << (i + 1 < cases.size() ? ",\n" : "\n");
+    out.flush();
+
+    std::cerr << r.name << ": ";
+    if (!r.error.empty()) {
+      failed = true;
+      std::cerr << "ERROR " << r.error << "\n";
+      continue;
+    }
+    double ms = median(r.wallMs);
+    std::cerr << formatDouble(ms) << " ms (cpu "
+              << formatDouble(median(r.cpuMs)) << " ms, " << r.iterations
+              << " calls)";
+    auto base = baseline.find(r.name);
+    if (base != baseline.end() && base->second > 0) {
+      double change = (ms / base->second - 1.0) * 100.0;
+      std::cerr << "  " << (change >= 0 ? "+" : "") << formatDouble(change)
+                << "% vs baseline";
+    }
+    std::cerr << "\n";
+  }
+  out << "]}\n";
+
+  std::error_code ec;
+  fs::remove_all(scratchDir, ec);
+  return failed ? 2 : 0;
+}
@@ -1,4 +1,6 @@
 #include "OCRAnalysis.hpp"
+#include "Log.hpp"
+#include "Trace.hpp"
 #include <algorithm>
 #include <cctype>
 #include <cmath>
@@ -84,7 +86,7 @@ ocrDetectWords(const cv::Mat &image, tesseract::TessBaseAPI *ocr,
   ocr->SetPageSegMode(psm);
   ocr->SetImage(image.data, image.cols, image.rows, image.channels(),
                 static_cast<int>(image.step));
-  ocr->Recognize(0);
+  timedRecognize(*ocr);
 
   tesseract::ResultIterator *ri = ocr->GetIterator();
   if (ri != nullptr) {
@@ -113,24 +115,25 @@ ocrDetectWords(const cv::Mat &image, tesseract::TessBaseAPI *ocr,
 }
 
 /**
- * @brief Convenience overload that creates its own TessBaseAPI.
- *        Used by callers outside checkImage that don't hold a shared instance.
+ * @brief English engine used for anchor OCR and element checks.
+ *
+ * Initialised on first use and kept for the lifetime of the analyzer, so
+ * repeated map / check calls on one OCRAnalysis pay the Tesseract start-up
+ * (loading the traineddata) only once.
+ *
+ * @return The engine, or nullptr if Tesseract could not be initialised
  */
-static std::vector<OcrWord> ocrDetectWords(const cv::Mat &image) {
-  std::vector<OcrWord> words;
-
-  tesseract::TessBaseAPI *ocr = new tesseract::TessBaseAPI();
-  if (ocr->Init("C:/tessdata/tessdata", "eng") != 0 &&
-      ocr->Init(NULL, "eng") != 0) {
-    std::cerr << "Warning: Could not initialize Tesseract" << std::endl;
-    delete ocr;
-    return words;
+tesseract::TessBaseAPI *OCRAnalysis::labelTesseract() {
+  if (!m_labelTesseract) {
+    auto ocr = std::make_unique<tesseract::TessBaseAPI>();
+    if (ocr->Init("C:/tessdata/tessdata", "eng") != 0 &&
+        ocr->Init(nullptr, "eng") != 0) {
+      OCR_ERROR << "Could not initialize Tesseract";
+      return nullptr;
+    }
+    m_labelTesseract = std::move(ocr);
   }
-
-  words = ocrDetectWords(image, ocr);
-  ocr->End();
-  delete ocr;
-  return words;
+  return m_labelTesseract.get();
 }
 
 /**
@@ -169,8 +172,7 @@ struct MatchedPair {
 static bool solveCropRectFromMatches(const std::vector<MatchedPair> &matches,
                                      cv::Rect &cropRect) {
   if (matches.size() < 2) {
-    std::cerr << "Need at least 2 matched text elements to solve crop rect"
-              << std::endl;
+    OCR_DEBUG << "Need at least 2 matched text elements to solve crop rect";
     return false;
   }
 
@@ -192,8 +194,7 @@ static bool solveCropRectFromMatches(const std::vector<MatchedPair> &matches,
 
   double detX = sumRelX2 * n - sumRelX * sumRelX;
   if (std::abs(detX) < 1e-10) {
-    std::cerr << "X system is singular (all matches at same relativeX?)"
-              << std::endl;
+    OCR_DEBUG << "X system is singular (all matches at same relativeX?)";
     return false;
   }
   double cropWidth = (sumRelXOcrX * n - sumRelX * sumOcrX) / detX;
@@ -201,20 +202,18 @@ static bool solveCropRectFromMatches(const std::vector<MatchedPair> &matches,
 
   double detY = sumRelY2 * n - sumRelY * sumRelY;
   if (std::abs(detY) < 1e-10) {
-    std::cerr << "Y system is singular (all matches at same relativeY?)"
-              << std::endl;
+    OCR_DEBUG << "Y system is singular (all matches at same relativeY?)";
     return false;
   }
   double cropHeight = (sumRelYOcrY * n - sumRelY * sumOcrY) / detY;
   double cropY = (sumRelY2 * sumOcrY - sumRelY * sumRelYOcrY) / detY;
 
-  std::cerr << "Solved crop rect from " << n << " matches:" << std::endl;
-  std::cerr << "  cropX=" << cropX << " cropY=" << cropY
-            << " cropWidth=" << cropWidth << " cropHeight=" << cropHeight
-            << std::endl;
+  OCR_DEBUG << "Solved crop rect from " << n << " matches:";
+  OCR_DEBUG << "  cropX=" << cropX << " cropY=" << cropY
+            << " cropWidth=" << cropWidth << " cropHeight=" << cropHeight;
 
   if (std::abs(cropWidth) < 10 || std::abs(cropHeight) < 10) {
-    std::cerr << "Solved crop dimensions too small" << std::endl;
+    OCR_DEBUG << "Solved crop dimensions too small";
     return false;
   }
 
@@ -226,10 +225,9 @@ static bool solveCropRectFromMatches(const std::vector<MatchedPair> &matches,
         std::sqrt((predX - m.ocrCentreX) * (predX - m.ocrCentreX) +
                   (predY - m.ocrCentreY) * (predY - m.ocrCentreY));
     totalResidual += residual;
-    std::cerr << "  Match residual: " << residual << " px" << std::endl;
+    OCR_DEBUG << "  Match residual: " << residual << " px";
   }
-  std::cerr << "  Average residual: " << totalResidual / n << " px"
-            << std::endl;
+  OCR_DEBUG << "  Average residual: " << totalResidual / n << " px";
 
   cropRect = cv::Rect(static_cast<int>(std::round(cropX)),
                       static_cast<int>(std::round(cropY)),
@@ -484,8 +482,8 @@ findAllMatchedPairs(const std::vector<OCRAnalysis::RelativeElement> &elements,
       }
     }
     if (bestWord) {
-      std::cerr << "  Matched \"" << elem.text << "\" [" << i << "] -> OCR \""
-                << bestWord->text << "\"  conf=" << bestWord->confidence << std::endl;
+      OCR_DEBUG << "  Matched \"" << elem.text << "\" [" << i << "] -> OCR \""
+                << bestWord->text << "\"  conf=" << bestWord->confidence;
       MatchedPair mp;
       mp.elementIdx  = i;
       mp.relCentreX  = elem.relativeX;
@@ -594,6 +592,94 @@ static int drawElements(
   return drawn;
 }
 
+// ── Prepared photo ────────────────────────────────────────────────────────────
+
+/// cv::rotate code for @p cwRotations clockwise quarter turns (-1 for none).
+static int rotateCode(int cwRotations) {
+  switch (cwRotations & 3) {
+  case 1:  return cv::ROTATE_90_CLOCKWISE;
+  case 2:  return cv::ROTATE_180;
+  case 3:  return cv::ROTATE_90_COUNTERCLOCKWISE;
+  default: return -1;
+  }
+}
+
+int OCRAnalysis::PreparedPhoto::rotationForAspect(double aspect) const {
+  if (crop.width <= 0 || crop.height <= 0)
+    return 0;
+  // A quarter turn inverts the ratio; a half turn leaves it unchanged.
+  double ar = static_cast<double>(crop.width) / crop.height;
+  return std::abs(1.0 / ar - aspect) < std::abs(ar - aspect) ? 1 : 0;
+}
+
+cv::Rect OCRAnalysis::PreparedPhoto::toSource(const cv::Rect &r) const {
+  const int cw = crop.width;
+  const int ch = crop.height;
+  cv::Rect s;
+  switch (cwRotations & 3) {
+  case 1:  s = cv::Rect(r.y, ch - r.x - r.width, r.height, r.width); break;
+  case 2:  s = cv::Rect(cw - r.x - r.width, ch - r.y - r.height,
+                        r.width, r.height);                           break;
+  case 3:  s = cv::Rect(cw - r.y - r.height, r.x, r.height, r.width); break;
+  default: s = r;                                                     break;
+  }
+  return s + crop.tl();
+}
+
+cv::Mat OCRAnalysis::PreparedPhoto::upright(const cv::Mat &source,
+                                            const cv::Rect &r,
+                                            cv::Mat &scratch) const {
+  cv::Mat view = source(toSource(r));
+  int code = rotateCode(cwRotations);
+  if (code < 0)
+    return view;
+  cv::rotate(view, scratch, code);
+  return scratch;
+}
+
+/// The whole working image of @p photo as a new buffer the caller may draw
+/// on: turned upright when needed, otherwise a copy of the backing crop.
+static cv::Mat uprightCopy(const OCRAnalysis::PreparedPhoto &photo,
+                           const cv::Mat &source) {
+  cv::Mat turned;
+  cv::Mat canvas = photo.upright(
+      source, cv::Rect(0, 0, photo.width(), photo.height()), turned);
+  return photo.cwRotations & 3 ? canvas : canvas.clone();
+}
+
+void OCRAnalysis::PreparedPhoto::makeGrey(const cv::Mat &source) {
+  cv::Mat view = source(crop);
+  cv::Mat g;
+  if (view.channels() == 4)
+    cv::cvtColor(view, g, cv::COLOR_BGRA2GRAY);
+  else if (view.channels() == 3)
+    cv::cvtColor(view, g, cv::COLOR_BGR2GRAY);
+  else
+    g = view.clone();
+
+  // Turn the single-channel copy rather than the colour crop.
+  int code = rotateCode(cwRotations);
+  if (code < 0)
+    grey = g;
+  else
+    cv::rotate(g, grey, code);
+}
+
+// static
+OCRAnalysis::PreparedPhoto OCRAnalysis::preparePhoto(const cv::Mat &image) {
+  TraceSpan span("preparePhoto");
+  PreparedPhoto photo;
+  if (image.empty())
+    return photo;
+
+  photo.crop = cropToLabelRect(image, 50, 40, /*tightLabel=*/false);
+  if (photo.crop.empty()) {
+    OCR_WARN << "cropToLabelRect found no backing paper; using full image";
+    photo.crop = cv::Rect(0, 0, image.cols, image.rows);
+  }
+  return photo;
+}
+
 // ── Main function ─────────────────────────────────────────────────────────────
 
 OCRAnalysis::RelativeMapResult
@@ -602,6 +688,18 @@ OCRAnalysis::createRelativeMap(const PDFElements &elements,
                                const std::string &imageFilePath, bool markImage,
                                const std::string &l1PdfPath, double dpi,
                                const std::string &l2PdfPath) {
+  PreparedPhoto photo;
+  return createRelativeMap(elements, image, photo, imageFilePath, markImage,
+                           l1PdfPath, dpi, l2PdfPath);
+}
+
+OCRAnalysis::RelativeMapResult
+OCRAnalysis::createRelativeMap(const PDFElements &elements,
+                               const cv::Mat &image, PreparedPhoto &photo,
+                               const std::string &imageFilePath, bool markImage,
+                               const std::string &l1PdfPath, double dpi,
+                               const std::string &l2PdfPath) {
+  TraceSpan span("createRelativeMap", "ocr", imageFilePath);
   OCRAnalysis::RelativeMapResult result;
 
   try {
@@ -639,100 +737,86 @@ OCRAnalysis::createRelativeMap(const PDFElements &elements,
     result.boundsWidth  = l1Bounds.width();
     result.boundsHeight = l1Bounds.height();
 
-    std::cerr << "L1 bounds: (" << l1Bounds.minX << ", " << l1Bounds.minY
+    OCR_DEBUG << "L1 bounds: (" << l1Bounds.minX << ", " << l1Bounds.minY
               << ") to (" << l1Bounds.maxX << ", " << l1Bounds.maxY << ")  "
-              << l1Bounds.width() << " x " << l1Bounds.height() << " pt"
-              << std::endl;
+              << l1Bounds.width() << " x " << l1Bounds.height() << " pt";
 
-    // ── Crop to backing paper and rotate to match L1 PDF aspect ratio ─────────
-    cv::Mat workImg;
+    // ── Crop to backing paper and pick the rotation matching the L1 aspect ───
+    // Only the greyscale working image used for anchor OCR is materialised;
+    // the colour photo is addressed through the prepared crop and rotation.
+    // Anchor OCR therefore reads grey pixels, not the BGR crop: Tesseract
+    // binarises the two slightly differently, so marginal words can differ.
     int cwRotations = 0;
     if (!image.empty()) {
-      cv::Mat backing = OCRAnalysis::cropToLabel(image, 50, 40, /*tightLabel=*/false);
-      if (backing.empty()) {
-        std::cerr << "Warning: cropToLabel returned empty; using full image"
-                  << std::endl;
-        backing = image.clone();
-      }
-      std::cerr << "Backing crop: " << backing.cols << "x" << backing.rows
-                << std::endl;
-
-      if (l1Bounds.width() > 0 && l1Bounds.height() > 0) {
-        double pdfAR  = l1Bounds.width() / l1Bounds.height();
-        double bestDiff = 1e9;
-        cv::Mat current = backing;
-        for (int r = 0; r < 4; ++r) {
-          double imgAR = static_cast<double>(current.cols) / current.rows;
-          double diff  = std::abs(imgAR - pdfAR);
-          if (diff < bestDiff) {
-            bestDiff   = diff;
-            cwRotations = r;
-            workImg    = current;
-          }
-          cv::Mat next;
-          cv::rotate(current, next, cv::ROTATE_90_CLOCKWISE);
-          current = next;
-        }
-      } else {
-        workImg = backing;
-      }
-      std::cerr << "Applied " << cwRotations << " CW 90° rotation(s); "
-                << "working image: " << workImg.cols << "x" << workImg.rows
-                << std::endl;
+      if (photo.crop.empty())
+        photo = preparePhoto(image);
+      OCR_DEBUG << "Backing crop: " << photo.crop.width << "x"
+                << photo.crop.height;
+
+      if (l1Bounds.width() > 0 && l1Bounds.height() > 0)
+        cwRotations =
+            photo.rotationForAspect(l1Bounds.width() / l1Bounds.height());
+      photo.cwRotations = cwRotations;
+      photo.makeGrey(image);
+      OCR_DEBUG << "Applied " << cwRotations << " CW 90° rotation(s); "
+                << "working image: " << photo.width() << "x" << photo.height();
     }
     result.cwRotations = cwRotations;
 
     addPDFElementsToMap(elements, l1Bounds, result.elements);
     const size_t l1Count = result.elements.size();
-    std::cerr << "L1 elements added: " << l1Count << std::endl;
+    OCR_DEBUG << "L1 elements added: " << l1Count;
 
     // ── L2: compute its own bounds and relative elements ──────────────────────
     BoundsResult l2Bounds;
     if (!l2PdfPath.empty()) {
-      std::cerr << "Extracting L2 elements from: " << l2PdfPath << std::endl;
+      OCR_DEBUG << "Extracting L2 elements from: " << l2PdfPath;
       OCRAnalysis l2Analyzer;
       auto l2Elements = l2Analyzer.extractPDFElements(l2PdfPath);
       if (!l2Elements.success) {
-        std::cerr << "Warning: Could not extract L2 elements: "
-                  << l2Elements.errorMessage << std::endl;
+        OCR_WARN << "Could not extract L2 elements: "
+                 << l2Elements.errorMessage;
       } else {
         // L2 PDFs always use crop marks for bounds.
         l2Bounds = computeBounds(l2Elements, RenderBoundsMode::USE_CROP_MARKS);
         if (!l2Bounds.success) {
-          std::cerr << "Warning: Could not compute L2 bounds: "
-                    << l2Bounds.errorMessage << std::endl;
+          OCR_WARN << "Could not compute L2 bounds: "
+                   << l2Bounds.errorMessage;
         } else {
-          std::cerr << "L2 bounds: (" << l2Bounds.minX << ", " << l2Bounds.minY
+          OCR_DEBUG << "L2 bounds: (" << l2Bounds.minX << ", " << l2Bounds.minY
                     << ") to (" << l2Bounds.maxX << ", " << l2Bounds.maxY
                     << ")  " << l2Bounds.width() << " x " << l2Bounds.height()
-                    << " pt" << std::endl;
+                    << " pt";
           addPDFElementsToMap(l2Elements, l2Bounds, result.elements);
-          std::cerr << "L2 elements added: "
-                    << (result.elements.size() - l1Count) << std::endl;
+          OCR_DEBUG << "L2 elements added: "
+                    << (result.elements.size() - l1Count);
         }
       }
     }
 
-    std::cerr << "Total elements: " << result.elements.size()
+    OCR_DEBUG << "Total elements: " << result.elements.size()
               << " (" << l1Count << " L1 + "
-              << (result.elements.size() - l1Count) << " L2)" << std::endl;
+              << (result.elements.size() - l1Count) << " L2)";
 
     // ── OCR + L1 crop rect ────────────────────────────────────────────────────
     // Always run OCR on the reference image so that the crop rect (pixel
     // mapping) can be stored in the result and reused by checkImage without
     // repeating anchor matching on every subsequent call.
     std::vector<OcrWord> ocrWords;
-    if (!workImg.empty()) {
-      std::cerr << "Running OCR on reference image ("
-                << workImg.cols << "x" << workImg.rows << ")..." << std::endl;
-      ocrWords = ocrDetectWords(workImg);
-      std::cerr << "Detected " << ocrWords.size() << " word(s)" << std::endl;
+    if (!image.empty()) {
+      OCR_DEBUG << "Running OCR on reference image ("
+                << photo.grey.cols << "x" << photo.grey.rows << ")...";
+      if (tesseract::TessBaseAPI *ocr = labelTesseract()) {
+        ocr->ClearAdaptiveClassifier(); // as in runOCRCheckPasses
+        ocrWords = ocrDetectWords(photo.grey, ocr);
+      }
+      OCR_DEBUG << "Detected " << ocrWords.size() << " word(s)";
 
-      std::cerr << "\n=== L1 OCR anchor matching ===" << std::endl;
+      OCR_DEBUG << "\n=== L1 OCR anchor matching ===";
       auto l1All     = findAllMatchedPairs(result.elements, 0, l1Count, ocrWords);
       auto l1Anchors = findBestMatchedPairs(l1All);
-      std::cerr << "Using " << l1Anchors.size() << " anchor pair(s) (of "
-                << l1All.size() << " total matches)" << std::endl;
+      OCR_DEBUG << "Using " << l1Anchors.size() << " anchor pair(s) (of "
+                << l1All.size() << " total matches)";
 
       cv::Rect l1CropRect;
       if (l1Anchors.size() >= 2 && solveCropRectFromMatches(l1Anchors, l1CropRect)) {
@@ -741,12 +825,12 @@ OCRAnalysis::createRelativeMap(const PDFElements &elements,
         result.cropWidth  = l1CropRect.width;
         result.cropHeight = l1CropRect.height;
         result.hasCropRect = true;
-        std::cerr << "Stored crop rect: (" << l1CropRect.x << ","
+        OCR_DEBUG << "Stored crop rect: (" << l1CropRect.x << ","
                   << l1CropRect.y << ") " << l1CropRect.width
-                  << "x" << l1CropRect.height << std::endl;
+                  << "x" << l1CropRect.height;
       } else {
-        std::cerr << "Warning: could not solve L1 crop rect ("
-                  << l1Anchors.size() << " anchor(s))" << std::endl;
+        OCR_WARN << "could not solve L1 crop rect ("
+                 << l1Anchors.size() << " anchor(s))";
 
         // If L2 elements are available, try supplementing with their anchors.
         // When L1 and L2 bounds describe the same physical label area the
@@ -754,25 +838,25 @@ OCRAnalysis::createRelativeMap(const PDFElements &elements,
         // rect from a combined L1+L2 anchor set.
         const size_t totalElems = result.elements.size();
         if (l1Count < totalElems) {
-          std::cerr << "Supplementing with L2 anchors..." << std::endl;
+          OCR_DEBUG << "Supplementing with L2 anchors...";
           auto l2Supp = findAllMatchedPairs(result.elements, l1Count, totalElems, ocrWords);
-          std::cerr << "  L2 anchor candidates: " << l2Supp.size() << std::endl;
+          OCR_DEBUG << "  L2 anchor candidates: " << l2Supp.size();
           auto combined = l1All;
           combined.insert(combined.end(), l2Supp.begin(), l2Supp.end());
           auto combinedBest = findBestMatchedPairs(combined);
-          std::cerr << "  Combined best anchors: " << combinedBest.size() << std::endl;
+          OCR_DEBUG << "  Combined best anchors: " << combinedBest.size();
           if (combinedBest.size() >= 2 && solveCropRectFromMatches(combinedBest, l1CropRect)) {
             result.cropX      = l1CropRect.x;
             result.cropY      = l1CropRect.y;
             result.cropWidth  = l1CropRect.width;
             result.cropHeight = l1CropRect.height;
             result.hasCropRect = true;
-            std::cerr << "Stored crop rect (L1+L2 combined): (" << l1CropRect.x
+            OCR_DEBUG << "Stored crop rect (L1+L2 combined): (" << l1CropRect.x
                       << "," << l1CropRect.y << ") " << l1CropRect.width
-                      << "x" << l1CropRect.height << std::endl;
+                      << "x" << l1CropRect.height;
           } else {
-            std::cerr << "Warning: could not solve crop rect even with L2 supplements ("
-                      << combinedBest.size() << " anchor(s))" << std::endl;
+            OCR_WARN << "could not solve crop rect even with L2 supplements ("
+                     << combinedBest.size() << " anchor(s))";
           }
         }
       }
@@ -790,17 +874,17 @@ OCRAnalysis::createRelativeMap(const PDFElements &elements,
       if (needsL2ReExpression) {
         cv::Rect l1CR(result.cropX, result.cropY,
                       result.cropWidth, result.cropHeight);
-        std::cerr << "\n=== L2 OCR anchor matching ===" << std::endl;
+        OCR_DEBUG << "\n=== L2 OCR anchor matching ===";
         auto l2All     = findAllMatchedPairs(result.elements, l1Count,
                                             result.elements.size(), ocrWords);
         auto l2Anchors = findBestMatchedPairs(l2All);
-        std::cerr << "Using " << l2Anchors.size() << " anchor pair(s) (of "
-                  << l2All.size() << " total matches)" << std::endl;
+        OCR_DEBUG << "Using " << l2Anchors.size() << " anchor pair(s) (of "
+                  << l2All.size() << " total matches)";
 
         cv::Rect l2CR;
         if (l2Anchors.size() >= 2 && solveCropRectFromMatches(l2Anchors, l2CR)) {
-          std::cerr << "L2 crop rect: (" << l2CR.x << "," << l2CR.y << ") "
-                    << l2CR.width << "x" << l2CR.height << std::endl;
+          OCR_DEBUG << "L2 crop rect: (" << l2CR.x << "," << l2CR.y << ") "
+                    << l2CR.width << "x" << l2CR.height;
 
           // Re-express each L2 element in L1 relative coordinates.
           for (size_t i = l1Count; i < result.elements.size(); ++i) {
@@ -814,25 +898,25 @@ OCRAnalysis::createRelativeMap(const PDFElements &elements,
             elem.relativeWidth  = pixW / l1CR.width;
             elem.relativeHeight = pixH / l1CR.height;
           }
-          std::cerr << "L2 elements re-normalised to L1 coordinate space."
-                    << std::endl;
+          OCR_DEBUG << "L2 elements re-normalised to L1 coordinate space.";
         } else {
-          std::cerr << "Warning: L2 anchor matching failed ("
-                    << l2Anchors.size() << " anchor(s)); "
-                    << "L2 elements may be misaligned in checkImage." << std::endl;
+          OCR_WARN << "L2 anchor matching failed ("
+                   << l2Anchors.size() << " anchor(s)); "
+                   << "L2 elements may be misaligned in checkImage.";
         }
       }
     }
 
     // ── marking: draw element boxes on a copy of the image ───────────────────
     if (markImage) {
-      if (workImg.empty() || !result.hasCropRect) {
-        std::cerr << "Warning: cannot mark – image empty or crop rect unavailable"
-                  << std::endl;
+      if (image.empty() || !result.hasCropRect) {
+        OCR_WARN << "cannot mark – image empty or crop rect unavailable";
       } else {
         cv::Rect l1CropRect(result.cropX, result.cropY,
                             result.cropWidth, result.cropHeight);
-        cv::Mat canvas = workImg.clone();
+        // The marked copy is saved upright, so this is one of the two places
+        // the colour crop is turned (the other is an annotated checkImage).
+        cv::Mat canvas = uprightCopy(photo, image);
         int drawn = 0;
 
         // L1
@@ -841,7 +925,7 @@ OCRAnalysis::createRelativeMap(const PDFElements &elements,
           drawn += drawElements(canvas, result.elements, 0, l1Count,
                                 l1CropRect.width, l1CropRect.height,
                                 l1CropRect.x, l1CropRect.y, l1All);
-          std::cerr << "L1: drew " << drawn << " element(s)" << std::endl;
+          OCR_DEBUG << "L1: drew " << drawn << " element(s)";
         }
 
         // L2 elements are already re-normalised to L1 coordinate space above;
@@ -856,22 +940,21 @@ OCRAnalysis::createRelativeMap(const PDFElements &elements,
                                        l1CropRect.width, l1CropRect.height,
                                        l1CropRect.x, l1CropRect.y, l2All);
             drawn += l2Drawn;
-            std::cerr << "L2: drew " << l2Drawn << " element(s)" << std::endl;
+            OCR_DEBUG << "L2: drew " << l2Drawn << " element(s)";
           }
         }
 
-        std::cerr << "Total drawn: " << drawn << " box(es) on image ("
-                  << canvas.cols << "x" << canvas.rows << ")" << std::endl;
+        OCR_DEBUG << "Total drawn: " << drawn << " box(es) on image ("
+                  << canvas.cols << "x" << canvas.rows << ")";
 
         std::filesystem::path markPath(imageFilePath);
         std::string outputPath = markPath.parent_path().string() + "/" +
                                  markPath.stem().string() + "_relmap" +
                                  markPath.extension().string();
         if (cv::imwrite(outputPath, canvas))
-          std::cerr << "Marked image saved: " << outputPath << std::endl;
+          OCR_DEBUG << "Marked image saved: " << outputPath;
         else
-          std::cerr << "ERROR: Failed to save marked image: " << outputPath
-                    << std::endl;
+          OCR_ERROR << "Failed to save marked image: " << outputPath;
       }
     }
 
@@ -924,25 +1007,36 @@ struct ElemCheck {
   cv::Rect    roi;          ///< pixel ROI in the working image
   std::string elemText;    ///< original element text (for logging / debug)
   std::string normExpected; ///< normalised expected string after placeholder sub
+  std::string expected;     ///< expected string after placeholder sub
 };
 
 /**
- * Runs Tesseract OCR on each ROI in @p checks and draws pass/fail annotations
- * onto @p image.  Returns true iff every element matched.
+ * Runs Tesseract OCR on each ROI in @p checks and, when @p canvas is
+ * non-null, draws pass/fail annotations onto it.  ROIs are in working-image
+ * coordinates and are read from the photo @p image through @p photo;
+ * @p canvas is the upright working image.  @p engine is the analyzer's
+ * initialised engine (may be null when @p checks is empty).  If @p results
+ * is non-null it receives one entry per check.  Returns true iff every
+ * element matched.
  */
-static bool runOCRCheckPasses(cv::Mat &image,
-                              const std::vector<ElemCheck> &checks)
+static bool runOCRCheckPasses(
+    const cv::Mat &image, const OCRAnalysis::PreparedPhoto &photo,
+    const std::vector<ElemCheck> &checks, tesseract::TessBaseAPI *engine,
+    std::vector<OCRAnalysis::ElementCheckResult> *results, cv::Mat *canvas)
 {
   if (checks.empty())
     return true; // nothing to verify – no Tesseract needed
 
-  tesseract::TessBaseAPI ocr;
-  if (ocr.Init("C:/tessdata/tessdata", "eng") != 0 &&
-      ocr.Init(nullptr, "eng") != 0) {
-    std::cerr << "checkImage: cannot initialise Tesseract" << std::endl;
+  if (!engine) {
+    OCR_ERROR << "checkImage: cannot initialise Tesseract";
     return false;
   }
+  tesseract::TessBaseAPI &ocr = *engine;
   ocr.SetPageSegMode(tesseract::PSM_SINGLE_BLOCK);
+  // The engine is kept for the analyzer's lifetime (and by ocr_server across
+  // requests); forget what the adaptive classifier learnt from earlier
+  // photos so a check gives the same result whatever ran before it.
+  ocr.ClearAdaptiveClassifier();
 
   bool allMatch = true;
   struct Marking { cv::Rect roi; bool match; };
@@ -953,7 +1047,7 @@ static bool runOCRCheckPasses(cv::Mat &image,
   auto ocrMat = [&](const cv::Mat &m) -> std::string {
     ocr.SetImage(m.data, m.cols, m.rows,
                  m.channels(), static_cast<int>(m.step[0]));
-    ocr.Recognize(nullptr);
+    timedRecognize(ocr);
     char *raw = ocr.GetUTF8Text();
     std::string t = raw ? raw : "";
     delete[] raw;
@@ -973,8 +1067,13 @@ static bool runOCRCheckPasses(cv::Mat &image,
     return levenshtein(normExp, got) <= maxDist;
   };
 
+  // Scratch images for the turned ROI and the cleanup retry, shared by every
+  // ROI below
+  cv::Mat roiScratch;
+  OCRAnalysis::CleanupBuffers cleanupBuffers;
+
   for (const auto &chk : checks) {
-    cv::Mat roi = image(chk.roi);
+    cv::Mat roi = photo.upright(image, chk.roi, roiScratch);
     std::string ocrTextInitial = ocrMat(roi);
     bool match = isMatch(chk.normExpected, ocrTextInitial);
 
@@ -989,8 +1088,7 @@ static bool runOCRCheckPasses(cv::Mat &image,
     std::string ocrTextCleaned;
     bool usedCleanup = false;
     if (!match) {
-      cv::Mat roiCopy = roi.clone();
-      cleanedRoi = OCRAnalysis::cleanupForOCR(roiCopy);
+      OCRAnalysis::cleanupForOCR(roi, cleanedRoi, cleanupBuffers);
       if (!cleanedRoi.empty()) {
         ocrTextCleaned = ocrMat(cleanedRoi);
         if (isMatch(chk.normExpected, ocrTextCleaned)) {
@@ -1001,10 +1099,10 @@ static bool runOCRCheckPasses(cv::Mat &image,
     }
 
     const std::string &ocrText = usedCleanup ? ocrTextCleaned : ocrTextInitial;
-    std::cerr << "checkImage: [" << chk.idx << "] \"" << chk.elemText << "\""
+    OCR_DEBUG << "checkImage: [" << chk.idx << "] \"" << chk.elemText << "\""
               << " ocr=\"" << ocrText << "\""
               << (usedCleanup ? " (cleanup)" : "")
-              << " -> " << (match ? "OK" : "FAIL") << std::endl;
+              << " -> " << (match ? "OK" : "FAIL");
 
 #ifndef NDEBUG
     if (!match) {
@@ -1044,14 +1142,17 @@ static bool runOCRCheckPasses(cv::Mat &image,
 
     markings.push_back({chk.roi, match});
     if (!match) allMatch = false;
+    if (results)
+      results->push_back(
+          {chk.idx, chk.expected, ocrText, chk.roi, usedCleanup, match});
   }
 
   // Draw annotations after all matching (deferred to avoid contaminating ROIs).
-  for (const auto &m : markings)
-    cv::rectangle(image, m.roi,
-                  m.match ? cv::Scalar(0, 255, 0) : cv::Scalar(0, 0, 255), 2);
+  if (canvas)
+    for (const auto &m : markings)
+      cv::rectangle(*canvas, m.roi,
+                    m.match ? cv::Scalar(0, 255, 0) : cv::Scalar(0, 0, 255), 2);
 
-  ocr.End();
   return allMatch;
 }
 
@@ -1061,33 +1162,35 @@ bool OCRAnalysis::checkImage(
     const RelativeMapResult &relMap, cv::Mat &image,
     const std::vector<std::pair<std::string, std::string>> &placeholders)
 {
+  if (image.empty() || !relMap.hasCropRect)
+    return false;
+  return checkImage(relMap, image, preparePhoto(image), placeholders);
+}
+
+bool OCRAnalysis::checkImage(
+    const RelativeMapResult &relMap, cv::Mat &image,
+    const PreparedPhoto &prepared,
+    const std::vector<std::pair<std::string, std::string>> &placeholders,
+    std::vector<ElementCheckResult> *results, bool annotate)
+{
+  TraceSpan span("checkImage");
+  if (results)
+    results->clear();
   using RE = RelativeElement;
 
-  if (image.empty() || !relMap.hasCropRect)
+  if (image.empty() || !relMap.hasCropRect || prepared.crop.empty())
     return false;
 
-  // ── Crop to backing paper and apply the stored CW rotation ───────────────
-  {
-    cv::Mat backing = OCRAnalysis::cropToLabel(image, 50, 40, /*tightLabel=*/false);
-    if (backing.empty()) {
-      std::cerr << "checkImage: cropToLabel returned empty; using full image"
-                << std::endl;
-      backing = image.clone();
-    }
-    for (int r = 0; r < relMap.cwRotations; ++r) {
-      cv::Mat next;
-      cv::rotate(backing, next, cv::ROTATE_90_CLOCKWISE);
-      backing = next;
-    }
-    image = backing;
-    std::cerr << "checkImage: backing crop + " << relMap.cwRotations
-              << " CW rotation(s); image now "
-              << image.cols << "x" << image.rows << std::endl;
-  }
+  // ── Working image: backing crop + the stored CW rotation ─────────────────
+  PreparedPhoto photo = prepared;
+  photo.cwRotations = relMap.cwRotations;
+  OCR_DEBUG << "checkImage: backing crop + " << photo.cwRotations
+            << " CW rotation(s); working image "
+            << photo.width() << "x" << photo.height();
 
   const cv::Rect cropRect(relMap.cropX, relMap.cropY,
                           relMap.cropWidth, relMap.cropHeight);
-  const cv::Rect imageRect(0, 0, image.cols, image.rows);
+  const cv::Rect imageRect(0, 0, photo.width(), photo.height());
   constexpr double kPadFraction     = 0.07; // fixed-label padding (all sides)
   constexpr double kPhPadFracY      = 0.15; // placeholder vertical padding
   constexpr double kPhPadFracX      = 0.04; // placeholder horizontal padding
@@ -1135,10 +1238,20 @@ bool OCRAnalysis::checkImage(
     roi &= imageRect;
     if (roi.area() == 0) continue;
 
-    checks.push_back({i, roi, elem.text, normExpected});
+    checks.push_back({i, roi, elem.text, normExpected, expected});
   }
 
-  return runOCRCheckPasses(image, checks);
+  // Marks go on an upright copy of the backing crop, which replaces @p image;
+  // the photo itself is only read.
+  cv::Mat canvas;
+  if (annotate)
+    canvas = uprightCopy(photo, image);
+  bool allMatch = runOCRCheckPasses(
+      image, photo, checks, checks.empty() ? nullptr : labelTesseract(),
+      results, annotate ? &canvas : nullptr);
+  if (annotate)
+    image = canvas;
+  return allMatch;
 }
 
 bool OCRAnalysis::checkImage(
@@ -1158,12 +1271,25 @@ OCRAnalysis::AbsoluteMapResult OCRAnalysis::createAbsoluteMap(
     const std::string &l1PdfPath,
     double dpi, const std::string &l2PdfPath)
 {
+  PreparedPhoto photo;
+  return createAbsoluteMap(elements, image, photo, imageFilePath, markImage,
+                           l1PdfPath, dpi, l2PdfPath);
+}
+
+OCRAnalysis::AbsoluteMapResult OCRAnalysis::createAbsoluteMap(
+    const PDFElements &elements, const cv::Mat &image, PreparedPhoto &photo,
+    const std::string &imageFilePath, bool markImage,
+    const std::string &l1PdfPath,
+    double dpi, const std::string &l2PdfPath)
+{
+  TraceSpan span("createAbsoluteMap", "ocr", imageFilePath);
   AbsoluteMapResult absResult;
 
   // Delegate to createRelativeMap to do all the heavy lifting (anchor OCR,
   // crop-rect solving, rotation detection, etc.).
   RelativeMapResult relResult = createRelativeMap(
-      elements, image, imageFilePath, markImage, l1PdfPath, dpi, l2PdfPath);
+      elements, image, photo, imageFilePath, markImage, l1PdfPath, dpi,
+      l2PdfPath);
 
   if (!relResult.success || !relResult.hasCropRect) {
     absResult.success      = false;
@@ -1174,18 +1300,10 @@ OCRAnalysis::AbsoluteMapResult OCRAnalysis::createAbsoluteMap(
     return absResult;
   }
 
-  // Reproduce the same working-image dimensions as checkImage would see:
-  // cropToLabel + cwRotations CW 90° rotations.
-  cv::Mat workImg = cropToLabel(image, 50, 40, /*tightLabel=*/false);
-  if (workImg.empty()) workImg = image;
-  for (int r = 0; r < relResult.cwRotations; ++r) {
-    cv::Mat next;
-    cv::rotate(workImg, next, cv::ROTATE_90_CLOCKWISE);
-    workImg = next;
-  }
-
-  absResult.imageWidth  = workImg.cols;
-  absResult.imageHeight = workImg.rows;
+  // Working-image dimensions as checkImage will see them: the prepared
+  // backing crop after cwRotations CW 90° rotations.
+  absResult.imageWidth  = photo.width();
+  absResult.imageHeight = photo.height();
   absResult.cwRotations = relResult.cwRotations;
 
   const double cw = relResult.cropWidth;
@@ -1234,27 +1352,29 @@ bool OCRAnalysis::checkImage(
 {
   if (image.empty() || !absMap.success)
     return false;
+  return checkImage(absMap, image, preparePhoto(image), placeholders);
+}
 
-  // ── Crop to backing paper and apply stored CW rotations ──────────────────
-  {
-    cv::Mat backing = OCRAnalysis::cropToLabel(image, 50, 40, /*tightLabel=*/false);
-    if (backing.empty()) {
-      std::cerr << "checkImage(abs): cropToLabel returned empty; using full image"
-                << std::endl;
-      backing = image.clone();
-    }
-    for (int r = 0; r < absMap.cwRotations; ++r) {
-      cv::Mat next;
-      cv::rotate(backing, next, cv::ROTATE_90_CLOCKWISE);
-      backing = next;
-    }
-    image = backing;
-    std::cerr << "checkImage(abs): backing crop + " << absMap.cwRotations
-              << " CW rotation(s); image now "
-              << image.cols << "x" << image.rows << std::endl;
-  }
+bool OCRAnalysis::checkImage(
+    const AbsoluteMapResult &absMap, cv::Mat &image,
+    const PreparedPhoto &prepared,
+    const std::vector<std::pair<std::string, std::string>> &placeholders,
+    std::vector<ElementCheckResult> *results, bool annotate)
+{
+  TraceSpan span("checkImage");
+  if (results)
+    results->clear();
+  if (image.empty() || !absMap.success || prepared.crop.empty())
+    return false;
 
-  const cv::Rect imageRect(0, 0, image.cols, image.rows);
+  // ── Working image: backing crop + the stored CW rotations ────────────────
+  PreparedPhoto photo = prepared;
+  photo.cwRotations = absMap.cwRotations;
+  OCR_DEBUG << "checkImage(abs): backing crop + " << photo.cwRotations
+            << " CW rotation(s); working image "
+            << photo.width() << "x" << photo.height();
+
+  const cv::Rect imageRect(0, 0, photo.width(), photo.height());
   constexpr double kPadFraction = 0.07;
   constexpr double kPhPadFracY  = 0.15;
   constexpr double kPhPadFracX  = 0.04;
@@ -1293,10 +1413,20 @@ bool OCRAnalysis::checkImage(
     roi &= imageRect;
     if (roi.area() == 0) continue;
 
-    checks.push_back({i, roi, elem.text, normExpected});
+    checks.push_back({i, roi, elem.text, normExpected, expected});
   }
 
-  return runOCRCheckPasses(image, checks);
+  // Marks go on an upright copy of the backing crop, which replaces @p image;
+  // the photo itself is only read.
+  cv::Mat canvas;
+  if (annotate)
+    canvas = uprightCopy(photo, image);
+  bool allMatch = runOCRCheckPasses(
+      image, photo, checks, checks.empty() ? nullptr : labelTesseract(),
+      results, annotate ? &canvas : nullptr);
+  if (annotate)
+    image = canvas;
+  return allMatch;
 }
 
 } // namespace ocr
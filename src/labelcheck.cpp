@@ -0,0 +1,379 @@
+// labelcheck: check a folder of label photos against one label design.
+//
+// The map is built once from the L1 (and optional L2) PDF and a reference
+// photo, then every photo flows through three stages connected by bounded
+// queues so decoding and registration of later photos overlap the OCR of
+// earlier ones:
+//
+//   decode     cv::imread
+//   register   preparePhoto (locate the backing paper)
+//   check      checkImage on -j workers, each with its own analyzer
+//
+// One NDJSON record per photo is written (in completion order) with the
+// verdict, per-element results and per-stage timings.
+
+#include "JsonString.hpp"
+#include "OCRAnalysis.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point t0) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+bool isImageFile(const fs::path &path) {
+  std::string ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+  return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" ||
+         ext == ".tif" || ext == ".tiff";
+}
+
+bool isPdfFile(const fs::path &path) {
+  std::string ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+  return ext == ".pdf";
+}
+
+using ocr::jsonString;
+
+// FIFO of at most @c capacity items.  pop() drains what is left after
+// close() and then returns std::nullopt.
+template <typename T> class StageQueue {
+public:
+  explicit StageQueue(size_t capacity) : m_capacity(capacity) {}
+
+  void push(T item) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notFull.wait(lock, [&] { return m_items.size() < m_capacity; });
+    m_items.push_back(std::move(item));
+    m_notEmpty.notify_one();
+  }
+
+  std::optional<T> pop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notEmpty.wait(lock, [&] { return m_closed || !m_items.empty(); });
+    if (m_items.empty())
+      return std::nullopt;
+    T item = std::move(m_items.front());
+    m_items.pop_front();
+    m_notFull.notify_one();
+    return item;
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = true;
+    m_notEmpty.notify_all();
+  }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_notEmpty;
+  std::condition_variable m_notFull;
+  std::deque<T> m_items;
+  size_t m_capacity;
+  bool m_closed = false;
+};
+
+struct PhotoJob {
+  fs::path path;
+  cv::Mat image;
+  ocr::OCRAnalysis::PreparedPhoto photo;
+  std::string error;
+  Clock::time_point started;
+  double decodeMs = 0;
+  double registerMs = 0;
+};
+
+// The design every photo is checked against.
+struct LabelMap {
+  bool absolute = false;
+  ocr::OCRAnalysis::RelativeMapResult relative;
+  ocr::OCRAnalysis::AbsoluteMapResult absoluteMap;
+};
+
+std::string resultRecord(
+    const PhotoJob &job, bool pass, double checkMs,
+    const std::vector<ocr::OCRAnalysis::ElementCheckResult> &elements) {
+  std::ostringstream out;
+  out << "{\"photo\":" << jsonString(job.path.string())
+      << ",\"pass\":" << (pass ? "true" : "false");
+  if (!job.error.empty())
+    out << ",\"error\":" << jsonString(job.error);
+  out << ",\"decodeMs\":" << job.decodeMs
+      << ",\"registerMs\":" << job.registerMs << ",\"checkMs\":" << checkMs
+      << ",\"totalMs\":" << msSince(job.started) << ",\"elements\":[";
+  for (size_t i = 0; i < elements.size(); ++i) {
+    const auto &e = elements[i];
+    out << (i ? "," : "") << "{\"index\":" << e.index
+        << ",\"expected\":" << jsonString(e.expected)
+        << ",\"ocr\":" << jsonString(e.ocrText)
+        << ",\"pass\":" << (e.match ? "true" : "false")
+        << ",\"cleanup\":" << (e.usedCleanup ? "true" : "false")
+        << ",\"roi\":[" << e.roi.x << "," << e.roi.y << "," << e.roi.width
+        << "," << e.roi.height << "]}";
+  }
+  out << "]}";
+  return out.str();
+}
+
+void printUsage(const char *argv0) {
+  std::cerr
+      << "Usage: " << argv0
+      << " [options] <l1_pdf> [<l2_pdf>] <photo_folder> [<token>=<value> ...]\n"
+      << "\n"
+      << "  -j N           OCR check workers (default 1, 0 = one per core)\n"
+      << "  --ref PHOTO    Reference photo used to build the map\n"
+      << "                 (default: first photo in the folder)\n"
+      << "  --absolute     Check against an absolute map instead of a\n"
+      << "                 relative one\n"
+      << "  --out FILE     Write NDJSON records to FILE (default: stdout)\n"
+      << "  --annotated DIR  Write annotated photos to DIR\n"
+      << "  --trace FILE   Write a Chrome trace of the run to FILE\n"
+      << "\n"
+      << "Exit status: 0 if every photo passes, 2 if any fails, 1 on error.\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  int jobs = 1;
+  bool absolute = false;
+  fs::path refPath, outPath, annotatedDir, tracePath, l1Path, l2Path, photoDir;
+  std::vector<std::pair<std::string, std::string>> placeholders;
+
+  for (int a = 1; a < argc; ++a) {
+    std::string arg = argv[a];
+    if (arg == "-j" && a + 1 < argc) {
+      jobs = std::atoi(argv[++a]);
+    } else if (arg == "--ref" && a + 1 < argc) {
+      refPath = argv[++a];
+    } else if (arg == "--absolute") {
+      absolute = true;
+    } else if (arg == "--out" && a + 1 < argc) {
+      outPath = argv[++a];
+    } else if (arg == "--annotated" && a + 1 < argc) {
+      annotatedDir = argv[++a];
+    } else if (arg == "--trace" && a + 1 < argc) {
+      tracePath = argv[++a];
+    } else if (arg.find('=') != std::string::npos) {
+      auto eq = arg.find('=');
+      placeholders.emplace_back(arg.substr(0, eq), arg.substr(eq + 1));
+    } else if (isPdfFile(arg)) {
+      (l1Path.empty() ? l1Path : l2Path) = arg;
+    } else if (photoDir.empty() && fs::is_directory(arg)) {
+      photoDir = arg;
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (l1Path.empty() || photoDir.empty()) {
+    printUsage(argv[0]);
+    return 1;
+  }
+  if (jobs <= 0)
+    jobs = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<fs::path> photos;
+  for (const auto &entry : fs::directory_iterator(photoDir))
+    if (entry.is_regular_file() && isImageFile(entry.path()))
+      photos.push_back(entry.path());
+  std::sort(photos.begin(), photos.end());
+  if (photos.empty()) {
+    std::cerr << "Error: no photos found in " << photoDir << std::endl;
+    return 1;
+  }
+  if (refPath.empty())
+    refPath = photos.front();
+
+  std::ofstream outFile;
+  if (!outPath.empty()) {
+    outFile.open(outPath);
+    if (!outFile) {
+      std::cerr << "Error: cannot write " << outPath << std::endl;
+      return 1;
+    }
+  }
+  std::ostream &out = outPath.empty() ? std::cout : outFile;
+  if (!annotatedDir.empty())
+    fs::create_directories(annotatedDir);
+  if (!tracePath.empty())
+    ocr::Tracer::start();
+
+  // ── Build the map once ────────────────────────────────────────────────────
+  ocr::OCRConfig config;
+  LabelMap map;
+  map.absolute = absolute;
+  {
+    auto t0 = Clock::now();
+    ocr::OCRAnalysis analyzer(config);
+    auto elements = analyzer.extractPDFElements(l1Path.string());
+    if (!elements.success) {
+      std::cerr << "Error extracting " << l1Path << ": "
+                << elements.errorMessage << std::endl;
+      return 1;
+    }
+    cv::Mat reference = cv::imread(refPath.string());
+    if (reference.empty()) {
+      std::cerr << "Error: could not load reference photo " << refPath
+                << std::endl;
+      return 1;
+    }
+    auto prepared = ocr::OCRAnalysis::preparePhoto(reference);
+    if (absolute) {
+      map.absoluteMap = analyzer.createAbsoluteMap(
+          elements, reference, prepared, refPath.string(), false,
+          l1Path.string(), 300.0, l2Path.string());
+      if (!map.absoluteMap.success) {
+        std::cerr << "Error building map: " << map.absoluteMap.errorMessage
+                  << std::endl;
+        return 1;
+      }
+    } else {
+      map.relative = analyzer.createRelativeMap(
+          elements, reference, prepared, refPath.string(), false,
+          l1Path.string(), 300.0, l2Path.string());
+      if (!map.relative.success || !map.relative.hasCropRect) {
+        std::cerr << "Error building map: "
+                  << (map.relative.success ? "reference photo not registered"
+                                           : map.relative.errorMessage)
+                  << std::endl;
+        return 1;
+      }
+    }
+    std::cerr << "Map built from " << refPath.filename().string() << " in "
+              << msSince(t0) << " ms; checking " << photos.size()
+              << " photo(s) with " << jobs << " worker(s)" << std::endl;
+  }
+
+  // Several check workers each run Tesseract; keep OpenCV's own pool from
+  // oversubscribing the cores underneath them.
+  if (jobs > 1) {
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    cv::setNumThreads(std::max(1, static_cast<int>(hw) / jobs));
+  }
+
+  // ── Pipeline ──────────────────────────────────────────────────────────────
+  // Queues hold decoded photos, so keep them short: just enough that each
+  // stage always has the next photo ready.
+  StageQueue<PhotoJob> decoded(2);
+  StageQueue<PhotoJob> registered(static_cast<size_t>(jobs) + 1);
+
+  std::mutex outMutex;
+  size_t passed = 0, failed = 0, errors = 0;
+  auto wallStart = Clock::now();
+
+  std::thread decodeStage([&] {
+    for (const auto &path : photos) {
+      PhotoJob job;
+      job.path = path;
+      job.started = Clock::now();
+      ocr::TraceSpan span("decode", "labelcheck", path.string());
+      job.image = cv::imread(path.string());
+      span.end();
+      if (job.image.empty())
+        job.error = "could not load image";
+      job.decodeMs = msSince(job.started);
+      decoded.push(std::move(job));
+    }
+    decoded.close();
+  });
+
+  std::thread registerStage([&] {
+    while (auto job = decoded.pop()) {
+      if (job->error.empty()) {
+        auto t0 = Clock::now();
+        job->photo = ocr::OCRAnalysis::preparePhoto(job->image);
+        job->registerMs = msSince(t0);
+      }
+      registered.push(std::move(*job));
+    }
+    registered.close();
+  });
+
+  auto checkStage = [&] {
+    ocr::OCRAnalysis analyzer(config);
+    std::vector<ocr::OCRAnalysis::ElementCheckResult> elements;
+    while (auto job = registered.pop()) {
+      bool pass = false;
+      double checkMs = 0;
+      elements.clear();
+      if (job->error.empty()) {
+        auto t0 = Clock::now();
+        const bool annotate = !annotatedDir.empty();
+        pass = map.absolute
+                   ? analyzer.checkImage(map.absoluteMap, job->image,
+                                         job->photo, placeholders, &elements,
+                                         annotate)
+                   : analyzer.checkImage(map.relative, job->image, job->photo,
+                                         placeholders, &elements, annotate);
+        checkMs = msSince(t0);
+        if (annotate)
+          analyzer.writeImage((annotatedDir / (job->path.stem().string() +
+                                               "_checked" +
+                                               job->path.extension().string()))
+                                  .string(),
+                              job->image);
+      }
+      std::string record = resultRecord(*job, pass, checkMs, elements);
+
+      std::lock_guard<std::mutex> lock(outMutex);
+      out << record << '\n' << std::flush;
+      if (!job->error.empty())
+        ++errors;
+      else if (pass)
+        ++passed;
+      else
+        ++failed;
+    }
+    analyzer.waitForImageWrites();
+  };
+
+  std::vector<std::thread> checkers;
+  for (int t = 0; t < jobs; ++t)
+    checkers.emplace_back(checkStage);
+
+  decodeStage.join();
+  registerStage.join();
+  for (auto &t : checkers)
+    t.join();
+
+  double wallMs = msSince(wallStart);
+  std::cerr << photos.size() << " photo(s): " << passed << " passed, "
+            << failed << " failed, " << errors << " unreadable in " << wallMs
+            << " ms (" << (photos.size() * 1000.0 / std::max(wallMs, 1.0))
+            << " photos/s)" << std::endl;
+
+  if (!tracePath.empty()) {
+    if (ocr::Tracer::writeJson(tracePath.string()))
+      std::cerr << "Trace written to " << tracePath.string() << std::endl;
+    else
+      std::cerr << "WARNING: could not write " << tracePath.string()
+                << std::endl;
+  }
+
+  if (errors > 0 && passed + failed == 0)
+    return 1;
+  return failed + errors > 0 ? 2 : 0;
+}
@@ -0,0 +1,611 @@
+// labelgen: write synthetic label PDFs (and matching photos) with a chosen
+// number of each kind of element, for measuring how extraction, rectangle
+// reconstruction and anchor matching scale with artwork density.
+//
+// The label is drawn once through Cairo onto a PDF surface and once onto an
+// image surface.  The PDF has the trim area surrounded by crop marks; the
+// photos show the trim area on grey backing paper over a dark background,
+// as cropToLabel expects, turned by --rotate degrees and with Gaussian
+// noise added.
+//
+// Element kinds:
+//
+//   text        Runs of random words, 5-10 pt
+//   rules       Horizontal and vertical stroked lines
+//   boxes       Groups of --depth nested stroked rectangles
+//   images      Small embedded raster images
+//   datamatrix  Vector DataMatrix codes, one filled rectangle per module
+//               (real symbols when ZXing is available, otherwise a
+//               DataMatrix-shaped pattern that will not decode)
+//   hidden      Text covered by an opaque white box, or drawn white on
+//               white, alternately
+//
+// A small JSON manifest with the settings and counts is written next to
+// the PDF.
+
+#include "JsonString.hpp"
+
+#include <cairo-pdf.h>
+#include <cairo.h>
+#include <opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_ZXING
+#include "C:/zxing-cpp/core/src/BarcodeFormat.h"
+#include "C:/zxing-cpp/core/src/BitMatrix.h"
+#include "C:/zxing-cpp/core/src/MultiFormatWriter.h"
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const double kMmToPt = 72.0 / 25.4;
+const double kMargin = 18.0;     ///< Page margin around the trim area (pt)
+const double kMarkGap = 3.0;     ///< Gap between trim corner and crop mark
+const double kMarkLength = 12.0; ///< Crop mark length (pt)
+const double kNestStep = 3.0;    ///< Inset between nested boxes (pt)
+
+const char *const kWords[] = {
+    "ADALIMUMAB", "solution",  "for",          "injection", "pre-filled",
+    "syringe",    "40",        "mg",           "0.4",       "mL",
+    "Lot",        "EXP",       "Store",        "in",        "a",
+    "refrigerator", "Do",      "not",          "freeze",    "Keep",
+    "out",        "of",        "reach",        "children",  "subcutaneous",
+    "use",        "only",      "Read",         "the",       "leaflet",
+    "before",     "Rx",        "Batch",        "PROTOCOL",  "Investigational"};
+
+struct Settings {
+  double widthPt = 100 * kMmToPt;
+  double heightPt = 60 * kMmToPt;
+  int text = 40;
+  int rules = 10;
+  int boxes = 5;
+  int depth = 3;
+  int images = 2;
+  int dataMatrix = 1;
+  int hidden = 4;
+  unsigned seed = 1;
+  int photos = 1;
+  double photoDpi = 300;
+  double rotate = 0;
+  double noise = 4;
+  fs::path outDir = ".";
+  std::string name = "L1synthetic";
+};
+
+struct TextRun {
+  double x, y; ///< Baseline start, trim-area coordinates (pt)
+  double size;
+  std::string text;
+};
+
+struct Rule {
+  double x1, y1, x2, y2, width;
+};
+
+struct Box {
+  double x, y, w, h;
+};
+
+struct ImageEl {
+  Box box;
+  cv::Mat pixels; ///< CV_8UC4, BGRA
+};
+
+struct DataMatrixEl {
+  Box box;
+  std::vector<std::vector<bool>> modules; ///< [row][column], true = dark
+};
+
+struct HiddenText {
+  TextRun run;
+  bool covered; ///< Covered by a white box, otherwise drawn in white
+};
+
+// Everything on the label, in trim-area coordinates with a top-left origin.
+struct Label {
+  double width = 0, height = 0;
+  std::vector<TextRun> text;
+  std::vector<Rule> rules;
+  std::vector<Box> boxes; ///< Outer box of each nested group
+  int depth = 0;
+  std::vector<ImageEl> images;
+  std::vector<DataMatrixEl> dataMatrix;
+  std::vector<HiddenText> hidden;
+};
+
+// ── Generation ──────────────────────────────────────────────────────────────
+
+std::vector<std::vector<bool>> dataMatrixModules(const std::string &content,
+                                                 std::mt19937 &rng) {
+#ifdef HAVE_ZXING
+  try {
+    ZXing::MultiFormatWriter writer(ZXing::BarcodeFormat::DataMatrix);
+    ZXing::BitMatrix m = writer.setMargin(0).encode(content, 0, 0);
+    std::vector<std::vector<bool>> modules(m.height(),
+                                           std::vector<bool>(m.width()));
+    for (int y = 0; y < m.height(); ++y)
+      for (int x = 0; x < m.width(); ++x)
+        modules[y][x] = m.get(x, y);
+    return modules;
+  } catch (const std::exception &e) {
+    std::cerr << "Warning: DataMatrix encode failed (" << e.what()
+              << "); using a pattern" << std::endl;
+  }
+#else
+  (void)content;
+#endif
+  // Finder "L" on the left and bottom, alternating timing pattern on the
+  // top and right, random data inside.
+  const int n = 16;
+  std::bernoulli_distribution dark(0.5);
+  std::vector<std::vector<bool>> modules(n, std::vector<bool>(n));
+  for (int y = 0; y < n; ++y)
+    for (int x = 0; x < n; ++x) {
+      if (x == 0 || y == n - 1)
+        modules[y][x] = true;
+      else if (y == 0)
+        modules[y][x] = x % 2 == 0;
+      else if (x == n - 1)
+        modules[y][x] = y % 2 == 1;
+      else
+        modules[y][x] = dark(rng);
+    }
+  return modules;
+}
+
+std::string randomWords(std::mt19937 &rng, int count) {
+  std::uniform_int_distribution<size_t> pick(0, std::size(kWords) - 1);
+  std::string s;
+  for (int i = 0; i < count; ++i) {
+    if (i)
+      s += ' ';
+    s += kWords[pick(rng)];
+  }
+  return s;
+}
+
+Label generate(const Settings &s) {
+  std::mt19937 rng(s.seed);
+  Label label;
+  label.width = s.widthPt;
+  label.height = s.heightPt;
+  label.depth = s.depth;
+
+  const double inset = 4.0;
+  auto uniform = [&](double lo, double hi) {
+    return std::uniform_real_distribution<double>(lo, std::max(lo, hi))(rng);
+  };
+  // A random box of the given size fully inside the inset trim area.
+  auto place = [&](double w, double h) {
+    w = std::min(w, s.widthPt - 2 * inset);
+    h = std::min(h, s.heightPt - 2 * inset);
+    return Box{uniform(inset, s.widthPt - inset - w),
+               uniform(inset, s.heightPt - inset - h), w, h};
+  };
+  auto textRun = [&] {
+    double size = uniform(5, 10);
+    std::string text =
+        randomWords(rng, std::uniform_int_distribution<int>(1, 4)(rng));
+    // Rough advance of the toy font; only used to keep runs on the label.
+    Box b = place(text.size() * size * 0.55, size);
+    return TextRun{b.x, b.y + size * 0.8, size, text};
+  };
+
+  for (int i = 0; i < s.text; ++i)
+    label.text.push_back(textRun());
+
+  for (int i = 0; i < s.rules; ++i) {
+    double width = uniform(0.3, 1.0);
+    if (i % 2 == 0) {
+      Box b = place(uniform(10, s.widthPt / 2), 0);
+      label.rules.push_back({b.x, b.y, b.x + b.w, b.y, width});
+    } else {
+      Box b = place(0, uniform(10, s.heightPt / 2));
+      label.rules.push_back({b.x, b.y, b.x, b.y + b.h, width});
+    }
+  }
+
+  for (int i = 0; i < s.boxes; ++i) {
+    double minSide = 2 * kNestStep * s.depth + 4;
+    label.boxes.push_back(place(uniform(minSide, s.widthPt / 3),
+                                uniform(minSide, s.heightPt / 3)));
+  }
+
+  cv::theRNG().state = rng();
+  for (int i = 0; i < s.images; ++i) {
+    ImageEl img;
+    img.box = place(uniform(12, 30), uniform(12, 30));
+    cv::Mat small(8, 8, CV_8UC4);
+    cv::randu(small, cv::Scalar::all(0), cv::Scalar::all(256));
+    small.forEach<cv::Vec4b>([](cv::Vec4b &p, const int *) { p[3] = 255; });
+    cv::resize(small, img.pixels, cv::Size(64, 64), 0, 0, cv::INTER_NEAREST);
+    label.images.push_back(std::move(img));
+  }
+
+  for (int i = 0; i < s.dataMatrix; ++i) {
+    DataMatrixEl dm;
+    double side = uniform(8, 14) * kMmToPt;
+    dm.box = place(side, side);
+    dm.modules = dataMatrixModules(
+        "SYNTH" + std::to_string(s.seed) + "-" + std::to_string(i), rng);
+    label.dataMatrix.push_back(std::move(dm));
+  }
+
+  for (int i = 0; i < s.hidden; ++i)
+    label.hidden.push_back({textRun(), i % 2 == 0});
+
+  return label;
+}
+
+// ── Drawing ─────────────────────────────────────────────────────────────────
+
+void drawText(cairo_t *cr, const TextRun &run) {
+  cairo_set_font_size(cr, run.size);
+  cairo_move_to(cr, run.x, run.y);
+  cairo_show_text(cr, run.text.c_str());
+}
+
+void drawImage(cairo_t *cr, const ImageEl &img) {
+  cairo_surface_t *surface = cairo_image_surface_create(
+      CAIRO_FORMAT_RGB24, img.pixels.cols, img.pixels.rows);
+  cairo_surface_flush(surface);
+  unsigned char *data = cairo_image_surface_get_data(surface);
+  int stride = cairo_image_surface_get_stride(surface);
+  // BGRA rows are Cairo's RGB24 layout on little-endian hosts.
+  for (int y = 0; y < img.pixels.rows; ++y)
+    std::copy_n(img.pixels.ptr<unsigned char>(y), img.pixels.cols * 4,
+                data + y * stride);
+  cairo_surface_mark_dirty(surface);
+
+  cairo_save(cr);
+  cairo_translate(cr, img.box.x, img.box.y);
+  cairo_scale(cr, img.box.w / img.pixels.cols, img.box.h / img.pixels.rows);
+  cairo_set_source_surface(cr, surface, 0, 0);
+  cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_NEAREST);
+  cairo_paint(cr);
+  cairo_restore(cr);
+  cairo_surface_destroy(surface);
+}
+
+void drawDataMatrix(cairo_t *cr, const DataMatrixEl &dm) {
+  int rows = static_cast<int>(dm.modules.size());
+  int cols = rows ? static_cast<int>(dm.modules[0].size()) : 0;
+  if (!rows || !cols)
+    return;
+  double mw = dm.box.w / cols, mh = dm.box.h / rows;
+  for (int y = 0; y < rows; ++y)
+    for (int x = 0; x < cols; ++x)
+      if (dm.modules[y][x])
+        cairo_rectangle(cr, dm.box.x + x * mw, dm.box.y + y * mh, mw, mh);
+  cairo_fill(cr);
+}
+
+void drawCropMarks(cairo_t *cr, double w, double h) {
+  cairo_set_line_width(cr, 0.25);
+  for (double x : {0.0, w})
+    for (double y : {0.0, h}) {
+      double dx = x == 0 ? -1 : 1, dy = y == 0 ? -1 : 1;
+      cairo_move_to(cr, x + dx * kMarkGap, y);
+      cairo_line_to(cr, x + dx * (kMarkGap + kMarkLength), y);
+      cairo_move_to(cr, x, y + dy * kMarkGap);
+      cairo_line_to(cr, x, y + dy * (kMarkGap + kMarkLength));
+    }
+  cairo_stroke(cr);
+}
+
+// Draw @p label with the trim area's top-left corner at the current origin.
+void drawLabel(cairo_t *cr, const Label &label, bool cropMarks) {
+  cairo_select_font_face(cr, "Arial", CAIRO_FONT_SLANT_NORMAL,
+                         CAIRO_FONT_WEIGHT_NORMAL);
+
+  cairo_set_source_rgb(cr, 1, 1, 1);
+  cairo_rectangle(cr, 0, 0, label.width, label.height);
+  cairo_fill(cr);
+
+  cairo_set_source_rgb(cr, 0, 0, 0);
+  if (cropMarks)
+    drawCropMarks(cr, label.width, label.height);
+
+  for (const auto &b : label.boxes) {
+    cairo_set_line_width(cr, 0.5);
+    for (int d = 0; d < label.depth; ++d) {
+      double in = kNestStep * d;
+      cairo_rectangle(cr, b.x + in, b.y + in, b.w - 2 * in, b.h - 2 * in);
+    }
+    cairo_stroke(cr);
+  }
+
+  for (const auto &r : label.rules) {
+    cairo_set_line_width(cr, r.width);
+    cairo_move_to(cr, r.x1, r.y1);
+    cairo_line_to(cr, r.x2, r.y2);
+    cairo_stroke(cr);
+  }
+
+  for (const auto &img : label.images)
+    drawImage(cr, img);
+
+  cairo_set_source_rgb(cr, 0, 0, 0);
+  for (const auto &dm : label.dataMatrix)
+    drawDataMatrix(cr, dm);
+
+  for (const auto &run : label.text)
+    drawText(cr, run);
+
+  for (const auto &h : label.hidden) {
+    if (h.covered) {
+      cairo_set_source_rgb(cr, 0, 0, 0);
+      drawText(cr, h.run);
+      cairo_text_extents_t ext;
+      cairo_text_extents(cr, h.run.text.c_str(), &ext);
+      cairo_set_source_rgb(cr, 1, 1, 1);
+      cairo_rectangle(cr, h.run.x + ext.x_bearing - 1,
+                      h.run.y + ext.y_bearing - 1, ext.width + 2,
+                      ext.height + 2);
+      cairo_fill(cr);
+    } else {
+      cairo_set_source_rgb(cr, 1, 1, 1);
+      drawText(cr, h.run);
+    }
+  }
+  cairo_set_source_rgb(cr, 0, 0, 0);
+}
+
+bool writePdf(const Label &label, const fs::path &path, std::string &error) {
+  cairo_surface_t *surface =
+      cairo_pdf_surface_create(path.string().c_str(),
+                               label.width + 2 * kMargin,
+                               label.height + 2 * kMargin);
+  cairo_t *cr = cairo_create(surface);
+  cairo_translate(cr, kMargin, kMargin);
+  drawLabel(cr, label, true);
+  cairo_show_page(cr);
+  cairo_destroy(cr);
+  cairo_surface_finish(surface);
+  cairo_status_t status = cairo_surface_status(surface);
+  cairo_surface_destroy(surface);
+  if (status != CAIRO_STATUS_SUCCESS) {
+    error = cairo_status_to_string(status);
+    return false;
+  }
+  return true;
+}
+
+// The trim area at @p dpi, BGR.
+cv::Mat renderLabel(const Label &label, double dpi) {
+  double scale = dpi / 72.0;
+  int w = static_cast<int>(std::lround(label.width * scale));
+  int h = static_cast<int>(std::lround(label.height * scale));
+  cv::Mat bgra(h, w, CV_8UC4);
+  cairo_surface_t *surface = cairo_image_surface_create_for_data(
+      bgra.data, CAIRO_FORMAT_RGB24, w, h, static_cast<int>(bgra.step));
+  cairo_t *cr = cairo_create(surface);
+  cairo_scale(cr, scale, scale);
+  drawLabel(cr, label, false);
+  cairo_destroy(cr);
+  cairo_surface_flush(surface);
+  cairo_surface_destroy(surface);
+
+  cv::Mat bgr;
+  cv::cvtColor(bgra, bgr, cv::COLOR_BGRA2BGR);
+  return bgr;
+}
+
+// Label on backing paper on a dark background, turned and noisy.
+cv::Mat makePhoto(const cv::Mat &labelImage, double degrees, double noise,
+                  std::mt19937 &rng) {
+  int padLabel = labelImage.cols / 10;
+  cv::Mat paper;
+  cv::copyMakeBorder(labelImage, paper, padLabel, padLabel, padLabel,
+                     padLabel, cv::BORDER_CONSTANT, cv::Scalar::all(165));
+  int padPaper = paper.cols / 8;
+  cv::Mat photo;
+  cv::copyMakeBorder(paper, photo, padPaper, padPaper, padPaper, padPaper,
+                     cv::BORDER_CONSTANT, cv::Scalar::all(20));
+
+  if (std::fmod(degrees, 360.0) != 0) {
+    cv::Point2f centre(photo.cols / 2.0f, photo.rows / 2.0f);
+    cv::Mat m = cv::getRotationMatrix2D(centre, -degrees, 1.0);
+    double rad = degrees * M_PI / 180.0;
+    double c = std::abs(std::cos(rad)), s = std::abs(std::sin(rad));
+    int w = static_cast<int>(std::lround(photo.cols * c + photo.rows * s));
+    int h = static_cast<int>(std::lround(photo.cols * s + photo.rows * c));
+    m.at<double>(0, 2) += (w - photo.cols) / 2.0;
+    m.at<double>(1, 2) += (h - photo.rows) / 2.0;
+    cv::Mat turned;
+    cv::warpAffine(photo, turned, m, cv::Size(w, h), cv::INTER_LINEAR,
+                   cv::BORDER_CONSTANT, cv::Scalar::all(20));
+    photo = turned;
+  }
+
+  if (noise > 0) {
+    cv::Mat n(photo.size(), CV_16SC3);
+    cv::theRNG().state = rng();
+    cv::randn(n, cv::Scalar::all(0), cv::Scalar::all(noise));
+    cv::Mat wide;
+    photo.convertTo(wide, CV_16SC3);
+    wide += n;
+    wide.convertTo(photo, CV_8UC3);
+  }
+  return photo;
+}
+
+bool writeManifest(const Settings &s, const Label &label, const fs::path &pdf,
+                   const std::vector<fs::path> &photos, const fs::path &path) {
+  std::ofstream out(path);
+  if (!out)
+    return false;
+  size_t total = label.text.size() + label.rules.size() +
+                 label.boxes.size() * label.depth + label.images.size() +
+                 label.dataMatrix.size() + label.hidden.size();
+  out << "{\n  \"pdf\": " << ocr::jsonString(pdf.filename().string())
+      << ",\n"
+      << "  \"seed\": " << s.seed << ",\n"
+      << "  \"widthPt\": " << s.widthPt << ",\n"
+      << "  \"heightPt\": " << s.heightPt << ",\n"
+      << "  \"text\": " << label.text.size() << ",\n"
+      << "  \"rules\": " << label.rules.size() << ",\n"
+      << "  \"boxes\": " << label.boxes.size() << ",\n"
+      << "  \"boxDepth\": " << label.depth << ",\n"
+      << "  \"images\": " << label.images.size() << ",\n"
+      << "  \"dataMatrix\": " << label.dataMatrix.size() << ",\n"
+      << "  \"hidden\": " << label.hidden.size() << ",\n"
+      << "  \"totalElements\": " << total << ",\n"
+      << "  \"photoDpi\": " << s.photoDpi << ",\n"
+      << "  \"rotate\": " << s.rotate << ",\n"
+      << "  \"noise\": " << s.noise << ",\n"
+      << "  \"photos\": [";
+  for (size_t i = 0; i < photos.size(); ++i)
+    out << (i ? ", " : "") << ocr::jsonString(photos[i].filename().string());
+  out << "]\n}\n";
+  out.close();
+  return !out.fail();
+}
+
+void printUsage(const char *argv0) {
+  std::cerr
+      << "Usage: " << argv0 << " [options]\n"
+      << "\n"
+      << "  --out DIR        Output directory (default: .)\n"
+      << "  --name STEM      File name stem (default: L1synthetic)\n"
+      << "  --size WxH       Trim size in mm (default: 100x60)\n"
+      << "  --text N         Text runs (default 40)\n"
+      << "  --rules N        Rules (default 10)\n"
+      << "  --boxes N        Nested box groups (default 5)\n"
+      << "  --depth N        Boxes per group (default 3)\n"
+      << "  --images N       Embedded images (default 2)\n"
+      << "  --datamatrix N   Vector DataMatrix codes (default 1)\n"
+      << "  --hidden N       Covered or invisible text runs (default 4)\n"
+      << "  --elements N     Scale all the counts above so they total about N\n"
+      << "  --seed N         Random seed (default 1)\n"
+      << "  --photos N       Photos to write (default 1, 0 = none)\n"
+      << "  --dpi N          Photo resolution (default 300)\n"
+      << "  --rotate DEG     Photo rotation, clockwise (default 0)\n"
+      << "  --noise SIGMA    Gaussian noise in grey levels (default 4)\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  Settings s;
+  long elements = 0;
+  for (int a = 1; a < argc; ++a) {
+    std::string arg = argv[a];
+    bool hasValue = a + 1 < argc;
+    auto count = [&] { return std::max(0, std::atoi(argv[++a])); };
+    if (arg == "--out" && hasValue) {
+      s.outDir = argv[++a];
+    } else if (arg == "--name" && hasValue) {
+      s.name = argv[++a];
+    } else if (arg == "--size" && hasValue) {
+      double w = 0, h = 0;
+      if (std::sscanf(argv[++a], "%lfx%lf", &w, &h) != 2 || w <= 0 || h <= 0) {
+        std::cerr << "Error: --size expects WxH in mm" << std::endl;
+        return 1;
+      }
+      s.widthPt = w * kMmToPt;
+      s.heightPt = h * kMmToPt;
+    } else if (arg == "--text" && hasValue) {
+      s.text = count();
+    } else if (arg == "--rules" && hasValue) {
+      s.rules = count();
+    } else if (arg == "--boxes" && hasValue) {
+      s.boxes = count();
+    } else if (arg == "--depth" && hasValue) {
+      s.depth = std::max(1, count());
+    } else if (arg == "--images" && hasValue) {
+      s.images = count();
+    } else if (arg == "--datamatrix" && hasValue) {
+      s.dataMatrix = count();
+    } else if (arg == "--hidden" && hasValue) {
+      s.hidden = count();
+    } else if (arg == "--elements" && hasValue) {
+      elements = count();
+    } else if (arg == "--seed" && hasValue) {
+      s.seed = static_cast<unsigned>(std::strtoul(argv[++a], nullptr, 10));
+    } else if (arg == "--photos" && hasValue) {
+      s.photos = count();
+    } else if (arg == "--dpi" && hasValue) {
+      s.photoDpi = std::max(10.0, std::atof(argv[++a]));
+    } else if (arg == "--rotate" && hasValue) {
+      s.rotate = std::atof(argv[++a]);
+    } else if (arg == "--noise" && hasValue) {
+      s.noise = std::max(0.0, std::atof(argv[++a]));
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  // Keep the mix of the per-kind counts, scaled to the requested total.
+  if (elements > 0) {
+    long current = s.text + s.rules + static_cast<long>(s.boxes) * s.depth +
+                   s.images + s.dataMatrix + s.hidden;
+    double f = current > 0 ? static_cast<double>(elements) / current : 0;
+    auto scaled = [&](int n) {
+      return static_cast<int>(std::lround(n * f));
+    };
+    s.text = scaled(s.text);
+    s.rules = scaled(s.rules);
+    s.boxes = scaled(s.boxes);
+    s.images = scaled(s.images);
+    s.dataMatrix = scaled(s.dataMatrix);
+    s.hidden = scaled(s.hidden);
+  }
+
+  try {
+    fs::create_directories(s.outDir);
+    Label label = generate(s);
+
+    fs::path pdfPath = s.outDir / (s.name + ".pdf");
+    std::string error;
+    if (!writePdf(label, pdfPath, error)) {
+      std::cerr << "Error writing " << pdfPath << ": " << error << std::endl;
+      return 1;
+    }
+    std::cout << pdfPath.string() << std::endl;
+
+    std::vector<fs::path> photoPaths;
+    if (s.photos > 0) {
+      cv::Mat rendered = renderLabel(label, s.photoDpi);
+      std::mt19937 rng(s.seed ^ 0x9e3779b9u);
+      for (int i = 0; i < s.photos; ++i) {
+        fs::path path =
+            s.outDir / (s.name + "_photo" + std::to_string(i + 1) + ".png");
+        if (!cv::imwrite(path.string(),
+                         makePhoto(rendered, s.rotate, s.noise, rng))) {
+          std::cerr << "Error writing " << path << std::endl;
+          return 1;
+        }
+        photoPaths.push_back(path);
+        std::cout << path.string() << std::endl;
+      }
+    }
+
+    fs::path manifest = s.outDir / (s.name + ".json");
+    if (!writeManifest(s, label, pdfPath, photoPaths, manifest)) {
+      std::cerr << "Error writing " << manifest << std::endl;
+      return 1;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
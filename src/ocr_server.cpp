@@ -0,0 +1,799 @@
+// ocr_server: serves extractPDFElements, createRelativeMap /
+// createAbsoluteMap and checkImage over a local socket, keeping analyzers
+// (with their Tesseract engines), extracted PDFs and built maps warm across
+// requests.
+//
+// Usage: ocr_server [--port N | --unix PATH] [-j N] [--output-dir DIR]
+//                   [--max-image-bytes N] [--pdf-cache N]
+//
+// Protocol: one request per line, fields separated by TAB.
+//
+//   ping
+//   extract  pdf=<path>
+//   map      name=<id> l1=<path> [l2=<path>] [kind=relative|absolute]
+//            (image=<path> | image-bytes=<n>)
+//   check    name=<id> (image=<path> | image-bytes=<n>)
+//            [annotated=<path>] [<token>=<value> ...]
+//   drop     name=<id>
+//
+// With image-bytes=<n>, exactly <n> bytes of an encoded image (JPEG, PNG,
+// ...) follow the request line; <n> may not exceed --max-image-bytes, and a
+// request over the limit gets an error reply and the connection is closed
+// (its bytes are not read).  Any check field that is not one of the
+// named ones is a placeholder substitution, e.g. "<MED>=ADALIMUMAB".
+//
+// annotated=<path> is relative to the server's --output-dir and may not
+// contain ".."; without --output-dir it is refused.
+//
+// Every reply is a status line ("ok" followed by key=value fields, or
+// "error" followed by a message), zero or more record lines, and a final
+// "end" line.  A check reply has one record per TEXT element checked:
+//
+//   element  <index> <pass 0|1> <cleanup 0|1> <x> <y> <w> <h>
+//            <expected> <ocr text>
+//
+// where the box is in the working image (label crop, turned upright).
+//
+// A request line may be at most 64 KiB long; a longer one gets an error
+// reply and the connection is closed.
+//
+// Each of the -j workers serves one connection until the client hangs up,
+// so at most -j clients are connected at a time.  A further connection is
+// sent "error\tserver busy ..." and closed straight away; clients should
+// connect once per worker they want and reuse the connection.
+
+#include "OCRAnalysis.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using SocketHandle = SOCKET;
+static const SocketHandle kInvalidSocket = INVALID_SOCKET;
+static void closeSocket(SocketHandle s) { closesocket(s); }
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+using SocketHandle = int;
+static const SocketHandle kInvalidSocket = -1;
+static void closeSocket(SocketHandle s) { close(s); }
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::atomic<bool> g_stop{false};
+
+void onStopSignal(int) { g_stop = true; }
+
+// ── Connection I/O ───────────────────────────────────────────────────────────
+
+// Buffered reader/writer over one accepted socket.
+class Connection {
+public:
+  explicit Connection(SocketHandle s) : m_socket(s) {}
+  ~Connection() { closeSocket(m_socket); }
+
+  Connection(const Connection &) = delete;
+  Connection &operator=(const Connection &) = delete;
+
+  static constexpr size_t kMaxLineBytes = 64 * 1024;
+
+  // Read up to the next '\n' (stripping "\r\n"); false on EOF, error or a
+  // line longer than kMaxLineBytes (see overlong()).
+  bool readLine(std::string &line) {
+    for (size_t searched = 0;;) {
+      size_t nl = m_buffer.find('\n', searched);
+      if (nl != std::string::npos) {
+        if (nl > kMaxLineBytes) {
+          m_overlong = true;
+          return false;
+        }
+        line = m_buffer.substr(0, nl);
+        m_buffer.erase(0, nl + 1);
+        if (!line.empty() && line.back() == '\r')
+          line.pop_back();
+        return true;
+      }
+      if (m_buffer.size() > kMaxLineBytes) {
+        m_overlong = true;
+        return false;
+      }
+      searched = m_buffer.size();
+      if (!fill())
+        return false;
+    }
+  }
+
+  // Whether readLine() gave up on a line over kMaxLineBytes.  The rest of
+  // the line is never read, so the connection has to be closed.
+  bool overlong() const { return m_overlong; }
+
+  bool readBytes(size_t n, std::vector<unsigned char> &out) {
+    while (m_buffer.size() < n)
+      if (!fill())
+        return false;
+    out.assign(m_buffer.begin(), m_buffer.begin() + n);
+    m_buffer.erase(0, n);
+    return true;
+  }
+
+  bool write(const std::string &data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+      int n = static_cast<int>(send(m_socket, data.data() + sent,
+                                    static_cast<int>(data.size() - sent), 0));
+      if (n <= 0)
+        return false;
+      sent += static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  // Close the connection once the current reply is sent, e.g. when the
+  // request's payload was refused and the stream cannot be resynchronised.
+  void closeAfterReply() { m_closeAfterReply = true; }
+  bool closing() const { return m_closeAfterReply; }
+
+private:
+  bool fill() {
+    char chunk[64 * 1024];
+    int n = static_cast<int>(recv(m_socket, chunk, sizeof(chunk), 0));
+    if (n <= 0)
+      return false;
+    m_buffer.append(chunk, static_cast<size_t>(n));
+    return true;
+  }
+
+  SocketHandle m_socket;
+  std::string m_buffer;
+  bool m_closeAfterReply = false;
+  bool m_overlong = false;
+};
+
+// ── Request parsing ──────────────────────────────────────────────────────────
+
+struct Request {
+  std::string command;
+  std::vector<std::pair<std::string, std::string>> fields; ///< In order
+
+  const std::string *get(const std::string &key) const {
+    for (const auto &[k, v] : fields)
+      if (k == key)
+        return &v;
+    return nullptr;
+  }
+};
+
+Request parseRequest(const std::string &line) {
+  Request req;
+  std::istringstream ss(line);
+  std::string field;
+  bool first = true;
+  while (std::getline(ss, field, '\t')) {
+    if (first) {
+      req.command = field;
+      first = false;
+      continue;
+    }
+    size_t eq = field.find('=');
+    if (eq == std::string::npos)
+      req.fields.emplace_back(field, std::string());
+    else
+      req.fields.emplace_back(field.substr(0, eq), field.substr(eq + 1));
+  }
+  return req;
+}
+
+// Tabs and newlines would break the record framing.
+std::string sanitise(std::string s) {
+  for (char &c : s)
+    if (c == '\t' || c == '\n' || c == '\r')
+      c = ' ';
+  return s;
+}
+
+// ── Shared warm state ────────────────────────────────────────────────────────
+
+// Command-line settings the request handlers need.
+struct ServerOptions {
+  fs::path outputDir; ///< Root for annotated= files (empty = refuse them)
+  size_t maxImageBytes = 64u << 20; ///< Largest image-bytes= accepted
+  size_t pdfCacheSize = 32; ///< Extracted PDFs kept before LRU eviction
+};
+
+struct CachedPdf {
+  std::uintmax_t size = 0;
+  fs::file_time_type mtime;
+  std::shared_ptr<const ocr::OCRAnalysis::PDFElements> elements;
+  std::list<std::string>::iterator lruPos; ///< Node in ServerState::m_pdfLru
+};
+
+struct StoredMap {
+  bool absolute = false;
+  ocr::OCRAnalysis::RelativeMapResult relative;
+  ocr::OCRAnalysis::AbsoluteMapResult absoluteMap;
+};
+
+// Extracted PDFs (revalidated by size and mtime, least recently used
+// dropped beyond ServerOptions::pdfCacheSize) and named maps, shared by
+// every worker.
+class ServerState {
+public:
+  explicit ServerState(ServerOptions options) : m_options(std::move(options)) {}
+
+  const ServerOptions &options() const { return m_options; }
+
+  std::shared_ptr<const ocr::OCRAnalysis::PDFElements>
+  elements(ocr::OCRAnalysis &analyzer, const std::string &path,
+           std::string &error) {
+    std::error_code ec;
+    std::uintmax_t size = fs::file_size(path, ec);
+    fs::file_time_type mtime = fs::last_write_time(path, ec);
+    if (ec) {
+      error = "cannot read " + path;
+      return nullptr;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto it = m_pdfs.find(path);
+      if (it != m_pdfs.end() && it->second.size == size &&
+          it->second.mtime == mtime) {
+        m_pdfLru.splice(m_pdfLru.begin(), m_pdfLru, it->second.lruPos);
+        return it->second.elements;
+      }
+    }
+
+    auto extracted = std::make_shared<ocr::OCRAnalysis::PDFElements>(
+        analyzer.extractPDFElements(path));
+    if (!extracted->success) {
+      error = extracted->errorMessage;
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_pdfs.find(path);
+    if (it != m_pdfs.end()) {
+      // Changed on disk, or extracted by two workers at once.
+      it->second.size = size;
+      it->second.mtime = mtime;
+      it->second.elements = extracted;
+      m_pdfLru.splice(m_pdfLru.begin(), m_pdfLru, it->second.lruPos);
+      return extracted;
+    }
+    m_pdfLru.push_front(path);
+    m_pdfs[path] = {size, mtime, extracted, m_pdfLru.begin()};
+    // Requests still holding an evicted PDF keep it alive via shared_ptr.
+    while (m_pdfs.size() > m_options.pdfCacheSize) {
+      m_pdfs.erase(m_pdfLru.back());
+      m_pdfLru.pop_back();
+    }
+    return extracted;
+  }
+
+  void putMap(const std::string &name, std::shared_ptr<const StoredMap> map) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maps[name] = std::move(map);
+  }
+
+  std::shared_ptr<const StoredMap> map(const std::string &name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_maps.find(name);
+    return it == m_maps.end() ? nullptr : it->second;
+  }
+
+  bool dropMap(const std::string &name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maps.erase(name) > 0;
+  }
+
+  // createRelativeMap / createAbsoluteMap record their result in static
+  // members, so map building is serialised across workers.
+  std::mutex buildMutex;
+
+private:
+  const ServerOptions m_options;
+  std::mutex m_mutex;
+  std::map<std::string, CachedPdf> m_pdfs;
+  std::list<std::string> m_pdfLru; ///< m_pdfs keys, most recent first
+  std::map<std::string, std::shared_ptr<const StoredMap>> m_maps;
+};
+
+// ── Request handlers ─────────────────────────────────────────────────────────
+
+std::string errorReply(const std::string &message) {
+  return "error\t" + sanitise(message) + "\nend\n";
+}
+
+// Decode the request's image from image=<path> or image-bytes=<n>, where
+// <n> is at most @p maxBytes.
+bool readImage(Connection &conn, const Request &req, size_t maxBytes,
+               cv::Mat &image, std::string &imagePath, std::string &error) {
+  if (const std::string *path = req.get("image")) {
+    imagePath = *path;
+    image = cv::imread(imagePath, cv::IMREAD_COLOR);
+    if (image.empty())
+      error = "cannot load image " + imagePath;
+    return !image.empty();
+  }
+  if (const std::string *bytes = req.get("image-bytes")) {
+    // The payload cannot be skipped safely when the count is unusable, so
+    // the connection is dropped after the error reply.
+    bool digits = !bytes->empty() && bytes->size() <= 19 &&
+                  std::all_of(bytes->begin(), bytes->end(), [](char c) {
+                    return c >= '0' && c <= '9';
+                  });
+    unsigned long long n =
+        digits ? std::strtoull(bytes->c_str(), nullptr, 10) : 0;
+    if (!digits || n > maxBytes) {
+      error = digits ? "image-bytes=" + *bytes + " exceeds the limit of " +
+                           std::to_string(maxBytes)
+                     : "image-bytes= must be a byte count";
+      conn.closeAfterReply();
+      return false;
+    }
+    std::vector<unsigned char> data;
+    if (!conn.readBytes(static_cast<size_t>(n), data)) {
+      error = "connection closed while reading image";
+      return false;
+    }
+    image = cv::imdecode(data, cv::IMREAD_COLOR);
+    if (image.empty())
+      error = "cannot decode image";
+    return !image.empty();
+  }
+  error = "missing image= or image-bytes=";
+  return false;
+}
+
+// Resolve a client-supplied output path under @p root.  Absolute paths and
+// ".." components are refused, so a client cannot write outside @p root.
+bool resolveOutputPath(const fs::path &root, const std::string &relative,
+                       fs::path &resolved, std::string &error) {
+  if (root.empty()) {
+    error = "annotated= needs the server to run with --output-dir";
+    return false;
+  }
+  fs::path rel(relative);
+  if (rel.empty() || rel.is_absolute() || rel.has_root_name() ||
+      rel.has_root_directory()) {
+    error = "annotated= must be a path relative to the output directory";
+    return false;
+  }
+  for (const auto &part : rel)
+    if (part == "..") {
+      error = "annotated= may not contain ..";
+      return false;
+    }
+  resolved = root / rel;
+  return true;
+}
+
+std::string handleExtract(ocr::OCRAnalysis &analyzer, ServerState &state,
+                          const Request &req) {
+  const std::string *pdf = req.get("pdf");
+  if (!pdf)
+    return errorReply("missing pdf=");
+  std::string error;
+  auto elements = state.elements(analyzer, *pdf, error);
+  if (!elements)
+    return errorReply(error);
+
+  std::ostringstream out;
+  out << "ok\ttexts=" << elements->textLines.size()
+      << "\thidden=" << elements->hiddenTextLines.size()
+      << "\timages=" << elements->images.size()
+      << "\trectangles=" << elements->rectangles.size()
+      << "\tdatamatrices=" << elements->dataMatrices.size()
+      << "\tpageWidth=" << elements->pageWidth
+      << "\tpageHeight=" << elements->pageHeight << "\n";
+  for (const auto &t : elements->textLines)
+    out << "text\t" << t.preciseX << "\t" << t.preciseY << "\t"
+        << t.preciseWidth << "\t" << t.preciseHeight << "\t"
+        << sanitise(t.text) << "\n";
+  for (const auto &t : elements->hiddenTextLines)
+    out << "hidden\t" << t.preciseX << "\t" << t.preciseY << "\t"
+        << t.preciseWidth << "\t" << t.preciseHeight << "\t"
+        << sanitise(t.text) << "\n";
+  for (const auto &dm : elements->dataMatrices)
+    out << "datamatrix\t" << dm.x << "\t" << dm.y << "\t" << dm.width << "\t"
+        << dm.height << "\t" << sanitise(dm.text) << "\n";
+  out << "end\n";
+  return out.str();
+}
+
+std::string handleMap(ocr::OCRAnalysis &analyzer, ServerState &state,
+                      Connection &conn, const Request &req) {
+  const std::string *name = req.get("name");
+  const std::string *l1 = req.get("l1");
+  const std::string *l2 = req.get("l2");
+  const std::string *kind = req.get("kind");
+  cv::Mat image;
+  std::string imagePath, error;
+  // Always consume the image so the connection stays in sync.
+  bool haveImage = readImage(conn, req, state.options().maxImageBytes, image,
+                             imagePath, error);
+  if (!name || !l1)
+    return errorReply("missing name= or l1=");
+  if (!haveImage)
+    return errorReply(error);
+  bool absolute = kind && *kind == "absolute";
+  if (kind && !absolute && *kind != "relative")
+    return errorReply("kind must be relative or absolute");
+
+  auto elements = state.elements(analyzer, *l1, error);
+  if (!elements)
+    return errorReply(error);
+
+  auto stored = std::make_shared<StoredMap>();
+  stored->absolute = absolute;
+  {
+    std::lock_guard<std::mutex> lock(state.buildMutex);
+    if (absolute) {
+      stored->absoluteMap = analyzer.createAbsoluteMap(
+          *elements, image, imagePath, false, *l1, 300.0, l2 ? *l2 : "");
+      if (!stored->absoluteMap.success)
+        return errorReply(stored->absoluteMap.errorMessage);
+    } else {
+      stored->relative = analyzer.createRelativeMap(
+          *elements, image, imagePath, false, *l1, 300.0, l2 ? *l2 : "");
+      if (!stored->relative.success)
+        return errorReply(stored->relative.errorMessage);
+      if (!stored->relative.hasCropRect)
+        return errorReply("could not register the reference photo");
+    }
+  }
+
+  std::ostringstream out;
+  out << "ok\tname=" << sanitise(*name)
+      << "\tkind=" << (absolute ? "absolute" : "relative");
+  if (absolute)
+    out << "\telements=" << stored->absoluteMap.elements.size()
+        << "\tcwRotations=" << stored->absoluteMap.cwRotations
+        << "\twidth=" << stored->absoluteMap.imageWidth
+        << "\theight=" << stored->absoluteMap.imageHeight;
+  else
+    out << "\telements=" << stored->relative.elements.size()
+        << "\tcwRotations=" << stored->relative.cwRotations
+        << "\tcrop=" << stored->relative.cropX << ","
+        << stored->relative.cropY << "," << stored->relative.cropWidth << ","
+        << stored->relative.cropHeight;
+  out << "\nend\n";
+  state.putMap(*name, std::move(stored));
+  return out.str();
+}
+
+std::string handleCheck(ocr::OCRAnalysis &analyzer, ServerState &state,
+                        Connection &conn, const Request &req) {
+  const std::string *name = req.get("name");
+  cv::Mat image;
+  std::string imagePath, error;
+  bool haveImage = readImage(conn, req, state.options().maxImageBytes, image,
+                             imagePath, error);
+  if (!name)
+    return errorReply("missing name=");
+  if (!haveImage)
+    return errorReply(error);
+  auto map = state.map(*name);
+  if (!map)
+    return errorReply("no map named " + *name);
+
+  fs::path annotatedPath;
+  if (const std::string *annotated = req.get("annotated")) {
+    if (!resolveOutputPath(state.options().outputDir, *annotated,
+                           annotatedPath, error))
+      return errorReply(error);
+    std::error_code ec;
+    fs::create_directories(annotatedPath.parent_path(), ec);
+  }
+
+  std::vector<std::pair<std::string, std::string>> placeholders;
+  for (const auto &[k, v] : req.fields)
+    if (k != "name" && k != "image" && k != "image-bytes" &&
+        k != "annotated")
+      placeholders.emplace_back(k, v);
+
+  auto t0 = std::chrono::steady_clock::now();
+  const bool annotate = !annotatedPath.empty();
+  auto photo = ocr::OCRAnalysis::preparePhoto(image);
+  std::vector<ocr::OCRAnalysis::ElementCheckResult> results;
+  bool pass = map->absolute
+                  ? analyzer.checkImage(map->absoluteMap, image, photo,
+                                        placeholders, &results, annotate)
+                  : analyzer.checkImage(map->relative, image, photo,
+                                        placeholders, &results, annotate);
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - t0)
+                  .count();
+
+  if (annotate && !image.empty())
+    analyzer.writeImage(annotatedPath.string(), image);
+
+  std::ostringstream out;
+  out << "ok\tpass=" << (pass ? 1 : 0) << "\tms=" << ms
+      << "\telements=" << results.size() << "\n";
+  for (const auto &e : results)
+    out << "element\t" << e.index << "\t" << (e.match ? 1 : 0) << "\t"
+        << (e.usedCleanup ? 1 : 0) << "\t" << e.roi.x << "\t" << e.roi.y
+        << "\t" << e.roi.width << "\t" << e.roi.height << "\t"
+        << sanitise(e.expected) << "\t" << sanitise(e.ocrText) << "\n";
+  out << "end\n";
+  return out.str();
+}
+
+// Serve requests on @p conn until the client disconnects.
+void serveConnection(ocr::OCRAnalysis &analyzer, ServerState &state,
+                     Connection &conn) {
+  std::string line;
+  while (!g_stop && conn.readLine(line)) {
+    if (line.empty())
+      continue;
+    Request req = parseRequest(line);
+    std::string reply;
+    try {
+      if (req.command == "ping")
+        reply = "ok\tversion=" + ocr::OCRAnalysis::getLibraryVersion() +
+                "\nend\n";
+      else if (req.command == "extract")
+        reply = handleExtract(analyzer, state, req);
+      else if (req.command == "map")
+        reply = handleMap(analyzer, state, conn, req);
+      else if (req.command == "check")
+        reply = handleCheck(analyzer, state, conn, req);
+      else if (req.command == "drop") {
+        const std::string *name = req.get("name");
+        reply = name && state.dropMap(*name) ? "ok\nend\n"
+                                             : errorReply("no such map");
+      } else
+        reply = errorReply("unknown command " + req.command);
+    } catch (const std::exception &e) {
+      reply = errorReply(e.what());
+    }
+    if (!conn.write(reply) || conn.closing())
+      return;
+  }
+  if (conn.overlong())
+    conn.write(errorReply("request line longer than " +
+                          std::to_string(Connection::kMaxLineBytes) +
+                          " bytes"));
+}
+
+// ── Listening socket ─────────────────────────────────────────────────────────
+
+SocketHandle listenTcp(int port) {
+  SocketHandle s = socket(AF_INET, SOCK_STREAM, 0);
+  if (s == kInvalidSocket)
+    return s;
+  int yes = 1;
+  setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&yes),
+             sizeof(yes));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<unsigned short>(port));
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // local clients only
+  if (bind(s, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      listen(s, 16) != 0) {
+    closeSocket(s);
+    return kInvalidSocket;
+  }
+  return s;
+}
+
+#ifndef _WIN32
+SocketHandle listenUnix(const std::string &path) {
+  SocketHandle s = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (s == kInvalidSocket)
+    return s;
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    closeSocket(s);
+    return kInvalidSocket;
+  }
+  std::strcpy(addr.sun_path, path.c_str());
+  unlink(path.c_str());
+  if (bind(s, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      listen(s, 16) != 0) {
+    closeSocket(s);
+    return kInvalidSocket;
+  }
+  return s;
+}
+#endif
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  int port = 7450;
+  std::string unixPath;
+  int jobs = 1;
+  ServerOptions options;
+  for (int a = 1; a < argc; ++a) {
+    std::string arg = argv[a];
+    if (arg == "--port" && a + 1 < argc) {
+      port = std::atoi(argv[++a]);
+    } else if (arg == "--unix" && a + 1 < argc) {
+      unixPath = argv[++a];
+    } else if (arg == "-j" && a + 1 < argc) {
+      jobs = std::max(1, std::atoi(argv[++a]));
+    } else if (arg == "--output-dir" && a + 1 < argc) {
+      options.outputDir = argv[++a];
+    } else if (arg == "--max-image-bytes" && a + 1 < argc) {
+      options.maxImageBytes = std::strtoull(argv[++a], nullptr, 10);
+    } else if (arg == "--pdf-cache" && a + 1 < argc) {
+      options.pdfCacheSize =
+          static_cast<size_t>(std::max(1, std::atoi(argv[++a])));
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--port N | --unix PATH] [-j N] [--output-dir DIR]\n"
+                << "       [--max-image-bytes N] [--pdf-cache N]\n"
+                << "  --port N    Listen on 127.0.0.1:N (default 7450)\n"
+#ifndef _WIN32
+                << "  --unix PATH Listen on a Unix domain socket instead\n"
+#endif
+                << "  -j N        Serve N connections at a time (default 1);\n"
+                << "              more are refused with a busy error\n"
+                << "  --output-dir DIR\n"
+                << "              Directory annotated= paths are relative to;\n"
+                << "              annotated= is refused without it\n"
+                << "  --max-image-bytes N\n"
+                << "              Largest image-bytes= payload accepted\n"
+                << "              (default 67108864 = 64 MiB)\n"
+                << "  --pdf-cache N\n"
+                << "              Extracted PDFs kept in memory (default 32)\n";
+      return 1;
+    }
+  }
+
+#ifdef _WIN32
+  WSADATA wsa;
+  if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+    std::cerr << "Error: WSAStartup failed" << std::endl;
+    return 1;
+  }
+#endif
+
+  SocketHandle listener = kInvalidSocket;
+#ifndef _WIN32
+  if (!unixPath.empty())
+    listener = listenUnix(unixPath);
+  else
+#endif
+    listener = listenTcp(port);
+  if (listener == kInvalidSocket) {
+    std::cerr << "Error: cannot listen on "
+              << (unixPath.empty() ? "port " + std::to_string(port) : unixPath)
+              << std::endl;
+    return 1;
+  }
+
+  std::signal(SIGINT, onStopSignal);
+  std::signal(SIGTERM, onStopSignal);
+#ifndef _WIN32
+  std::signal(SIGPIPE, SIG_IGN); // a client that hangs up must not kill us
+#endif
+
+  // Accepted connections wait here for a worker.  Each worker owns one
+  // analyzer for its whole life, so Tesseract is initialised once per worker
+  // rather than once per request.  A worker keeps its connection until the
+  // client hangs up, so connections beyond the worker count are refused
+  // rather than queued behind clients that may never leave.
+  ServerState state(options);
+  std::mutex queueMutex;
+  std::condition_variable queueReady;
+  std::deque<SocketHandle> pending;
+  std::vector<SocketHandle> serving; ///< Connections a worker is reading
+
+  auto worker = [&]() {
+    ocr::OCRConfig config;
+    ocr::OCRAnalysis analyzer(config);
+    for (;;) {
+      SocketHandle s;
+      {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueReady.wait(lock, [&] { return g_stop || !pending.empty(); });
+        if (pending.empty())
+          return;
+        s = pending.front();
+        pending.pop_front();
+        serving.push_back(s);
+      }
+      {
+        Connection conn(s);
+        serveConnection(analyzer, state, conn);
+        std::lock_guard<std::mutex> lock(queueMutex);
+        serving.erase(std::find(serving.begin(), serving.end(), s));
+      }
+      analyzer.waitForImageWrites();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < jobs; ++t)
+    workers.emplace_back(worker);
+
+  std::cout << "ocr_server " << ocr::OCRAnalysis::getLibraryVersion()
+            << " listening on "
+            << (unixPath.empty() ? "127.0.0.1:" + std::to_string(port)
+                                 : unixPath)
+            << " with " << jobs << " worker(s)" << std::endl;
+
+  while (!g_stop) {
+    // Wake up periodically so a stop signal is noticed even when no client
+    // connects (std::signal restarts a blocking accept on most platforms).
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(listener, &readable);
+    timeval timeout{0, 500 * 1000};
+    if (select(static_cast<int>(listener) + 1, &readable, nullptr, nullptr,
+               &timeout) <= 0)
+      continue;
+    SocketHandle s = accept(listener, nullptr, nullptr);
+    if (s == kInvalidSocket)
+      continue; // interrupted by a signal, or a transient failure
+    bool busy;
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      busy = serving.size() + pending.size() >= static_cast<size_t>(jobs);
+      if (!busy)
+        pending.push_back(s);
+    }
+    if (busy) {
+      Connection conn(s); // closes the socket
+      conn.write(errorReply("server busy: all " + std::to_string(jobs) +
+                            " worker(s) have a client connected"));
+      continue;
+    }
+    queueReady.notify_one();
+  }
+
+  closeSocket(listener);
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    for (SocketHandle s : pending)
+      closeSocket(s);
+    pending.clear();
+    // Unblock workers waiting on an idle client; they finish the request in
+    // hand, if any, and exit.
+    for (SocketHandle s : serving)
+#ifdef _WIN32
+      shutdown(s, SD_BOTH);
+#else
+      shutdown(s, SHUT_RDWR);
+#endif
+  }
+  queueReady.notify_all();
+  for (auto &t : workers)
+    t.join();
+#ifndef _WIN32
+  if (!unixPath.empty())
+    unlink(unixPath.c_str());
+#endif
+#ifdef _WIN32
+  WSACleanup();
+#endif
+  return 0;
+}
@@ -1,8 +1,30 @@
+#include "Log.hpp"
 #include "OCRAnalysis.hpp"
+#include "Trace.hpp"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
 
 namespace fs = std::filesystem;
 
@@ -31,6 +53,12 @@ static bool dataMatrixInBounds(const ocr::OCRAnalysis::PDFDataMatrix &dm,
   return cx >= minX && cx <= maxX && cy >= minY && cy <= maxY;
 }
 
+static bool isPdfFile(const fs::path &path) {
+  std::string ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+  return ext == ".pdf";
+}
+
 static void ensureEmptyDir(const fs::path &dir) {
   if (fs::exists(dir)) {
     for (auto &entry : fs::directory_iterator(dir))
@@ -78,243 +106,460 @@ static void annotateImage(
   }
 }
 
-int main(int argc, char *argv[]) {
-  if (argc < 2) {
-    std::cerr << "Usage: pdfcheck <folder>" << std::endl;
-    std::cerr << "  Processes all PDF files in <folder>." << std::endl;
-    std::cerr << "  Creates Processed/ and Anomalies/ subfolders." << std::endl;
-    return 1;
+// Files produced for one PDF.  The anomaly note is buffered and written by
+// writeNote(), so parallel runs can create the note files in the same order
+// as a serial run.
+struct DocRecord {
+  fs::path notePath;             ///< Empty until openNote() is called
+  std::ostringstream note;
+  std::vector<fs::path> outputs; ///< Rendered images (and the note)
+
+  std::ostream &openNote(const fs::path &path) {
+    if (notePath.empty())
+      outputs.push_back(path);
+    notePath = path;
+    return note;
   }
 
-  fs::path inputDir(argv[1]);
-  if (!fs::is_directory(inputDir)) {
-    std::cerr << "Error: \"" << inputDir.string() << "\" is not a directory."
-              << std::endl;
-    return 1;
+  void writeNote() {
+    if (notePath.empty())
+      return;
+    std::ofstream file(notePath);
+    file << note.str();
+    note.str({});
   }
+};
 
-  fs::path processedDir = inputDir / "Processed";
-  fs::path anomaliesDir = inputDir / "Anomalies";
+// While alive, library diagnostics logged on the calling thread are written
+// to @p err, formatted as the default stderr sink would print them.  Workers
+// use it so a document's messages are released together with its report.
+class ScopedLogCapture {
+public:
+  explicit ScopedLogCapture(std::ostream &err) {
+    ocr::Log::setThreadSink(
+        [&err](ocr::LogLevel level, std::string_view message) {
+          err << ocr::Log::formatLine(level, message);
+        });
+  }
+  ~ScopedLogCapture() { ocr::Log::setThreadSink({}); }
 
-  std::cout << "Input folder : " << inputDir.string() << std::endl;
-  std::cout << "Processed    : " << processedDir.string() << std::endl;
-  std::cout << "Anomalies    : " << anomaliesDir.string() << std::endl;
+  ScopedLogCapture(const ScopedLogCapture &) = delete;
+  ScopedLogCapture &operator=(const ScopedLogCapture &) = delete;
+};
 
-  ensureEmptyDir(processedDir);
-  ensureEmptyDir(anomaliesDir);
+// Check one PDF: extract, choose the ROI, render to Processed/ or Anomalies/
+// and annotate.  Progress goes to @p out / @p err; the note and the list of
+// files written go to @p record.
+static void processPdf(ocr::OCRAnalysis &analyzer, const fs::path &pdfPath,
+                       const fs::path &processedDir,
+                       const fs::path &anomaliesDir, double dpi,
+                       std::ostream &out, std::ostream &err,
+                       DocRecord &record) {
+  std::string stem = pdfPath.stem().string();
+  std::string pdfStr = pdfPath.string();
+  const fs::path notePath = anomaliesDir / (stem + "_note.txt");
+  out << "--- Processing: " << stem << " ---" << std::endl;
 
-  // Collect PDF files
-  std::vector<fs::path> pdfFiles;
-  for (auto &entry : fs::directory_iterator(inputDir)) {
-    if (!entry.is_regular_file())
-      continue;
-    std::string ext = entry.path().extension().string();
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    if (ext == ".pdf")
-      pdfFiles.push_back(entry.path());
-  }
+  // 1. Extract elements
+  ocr::OCRAnalysis::PDFElements elements =
+      analyzer.extractPDFElements(pdfStr);
 
-  if (pdfFiles.empty()) {
-    std::cout << "No PDF files found in " << inputDir.string() << std::endl;
-    return 0;
+  if (!elements.success) {
+    err << "  FAILED to extract: " << elements.errorMessage
+        << std::endl;
+    std::ostream &note = record.openNote(notePath);
+    note << "Failed to extract PDF elements: " << elements.errorMessage
+         << std::endl;
+    return;
   }
 
-  std::sort(pdfFiles.begin(), pdfFiles.end());
-  std::cout << "Found " << pdfFiles.size() << " PDF file(s)." << std::endl
-            << std::endl;
-
-  ocr::OCRAnalysis analyzer;
-  const double dpi = 300.0;
+  // Report DataMatrix barcodes
+  if (!elements.dataMatrices.empty()) {
+    out << "  DataMatrix barcodes: " << elements.dataMatrices.size()
+        << std::endl;
+    for (const auto &dm : elements.dataMatrices)
+      out << "    \"" << dm.text.substr(0, 40) << "\"" << std::endl;
+  }
 
-  for (const auto &pdfPath : pdfFiles) {
-    std::string stem = pdfPath.stem().string();
-    std::string pdfStr = pdfPath.string();
-    std::cout << "--- Processing: " << stem << " ---" << std::endl;
+  // 2. Determine bounds mode and ROI
+  bool l1 = isL1(stem);
+  bool l2 = isL2(stem);
+  ocr::OCRAnalysis::RenderBoundsMode boundsMode =
+      l2 ? ocr::OCRAnalysis::RenderBoundsMode::USE_CROP_MARKS
+         : ocr::OCRAnalysis::RenderBoundsMode::USE_LARGEST_RECTANGLE;
 
-    // 1. Extract elements
-    ocr::OCRAnalysis::PDFElements elements =
-        analyzer.extractPDFElements(pdfStr);
+  double roiMinX = 0, roiMinY = 0, roiMaxX = 0, roiMaxY = 0;
 
-    if (!elements.success) {
-      std::cerr << "  FAILED to extract: " << elements.errorMessage
-                << std::endl;
-      std::ofstream note(anomaliesDir / (stem + "_note.txt"));
-      note << "Failed to extract PDF elements: " << elements.errorMessage
-           << std::endl;
-      continue;
+  if (boundsMode ==
+      ocr::OCRAnalysis::RenderBoundsMode::USE_LARGEST_RECTANGLE) {
+    double largestArea = 0;
+    const ocr::OCRAnalysis::PDFRectangle *largestRect = nullptr;
+    for (const auto &rect : elements.rectangles) {
+      double area = rect.width * rect.height;
+      if (area > largestArea) {
+        largestArea = area;
+        largestRect = &rect;
+      }
     }
 
-    // Report DataMatrix barcodes
-    if (!elements.dataMatrices.empty()) {
-      std::cout << "  DataMatrix barcodes: " << elements.dataMatrices.size()
-                << std::endl;
-      for (const auto &dm : elements.dataMatrices)
-        std::cout << "    \"" << dm.text.substr(0, 40) << "\"" << std::endl;
-    }
-
-    // 2. Determine bounds mode and ROI
-    bool l1 = isL1(stem);
-    bool l2 = isL2(stem);
-    ocr::OCRAnalysis::RenderBoundsMode boundsMode =
-        l2 ? ocr::OCRAnalysis::RenderBoundsMode::USE_CROP_MARKS
-           : ocr::OCRAnalysis::RenderBoundsMode::USE_LARGEST_RECTANGLE;
-
-    double roiMinX = 0, roiMinY = 0, roiMaxX = 0, roiMaxY = 0;
-
-    if (boundsMode ==
-        ocr::OCRAnalysis::RenderBoundsMode::USE_LARGEST_RECTANGLE) {
-      double largestArea = 0;
-      const ocr::OCRAnalysis::PDFRectangle *largestRect = nullptr;
-      for (const auto &rect : elements.rectangles) {
-        double area = rect.width * rect.height;
-        if (area > largestArea) {
-          largestArea = area;
-          largestRect = &rect;
+    if (largestRect) {
+      double rectTopLeftY = largestRect->y;
+      double rectBottomLeftY = rectTopLeftY + largestRect->height;
+      roiMinX = largestRect->x;
+      roiMinY = elements.pageHeight - rectBottomLeftY;
+      roiMaxX = largestRect->x + largestRect->width;
+      roiMaxY = elements.pageHeight - rectTopLeftY;
+      out << "  ROI: largest rectangle (" << largestRect->width
+          << " x " << largestRect->height << " pt)" << std::endl;
+    } else if (l1 && !elements.images.empty()) {
+      const ocr::OCRAnalysis::PDFEmbeddedImage *largestImg = nullptr;
+      double largestImgArea = 0;
+      for (const auto &img : elements.images) {
+        double area = img.displayWidth * img.displayHeight;
+        if (area > largestImgArea) {
+          largestImgArea = area;
+          largestImg = &img;
         }
       }
 
-      if (largestRect) {
-        double rectTopLeftY = largestRect->y;
-        double rectBottomLeftY = rectTopLeftY + largestRect->height;
-        roiMinX = largestRect->x;
-        roiMinY = elements.pageHeight - rectBottomLeftY;
-        roiMaxX = largestRect->x + largestRect->width;
-        roiMaxY = elements.pageHeight - rectTopLeftY;
-        std::cout << "  ROI: largest rectangle (" << largestRect->width
-                  << " x " << largestRect->height << " pt)" << std::endl;
-      } else if (l1 && !elements.images.empty()) {
-        const ocr::OCRAnalysis::PDFEmbeddedImage *largestImg = nullptr;
-        double largestImgArea = 0;
-        for (const auto &img : elements.images) {
-          double area = img.displayWidth * img.displayHeight;
-          if (area > largestImgArea) {
-            largestImgArea = area;
-            largestImg = &img;
-          }
-        }
-
-        if (largestImg &&
-            largestImgArea > elements.pageWidth * elements.pageHeight * 0.1) {
-          std::cout << "  ANOMALY: L1 has no rectangle but has image "
-                       "resembling one ("
-                    << largestImg->displayWidth << " x "
-                    << largestImg->displayHeight << " pt)" << std::endl;
-
-          ocr::OCRAnalysis::PNGRenderResult renderResult =
-              analyzer.renderElementsToPNG(elements, pdfStr, dpi,
-                                           anomaliesDir.string(), boundsMode);
-          std::ofstream note(anomaliesDir / (stem + "_note.txt"));
-          note << "L1 file has no rectangle but contains an image "
-                  "resembling a rectangle."
-               << std::endl;
-          note << "Image: " << largestImg->displayWidth << " x "
-               << largestImg->displayHeight << " pt at ("
-               << largestImg->x << ", " << largestImg->y << ")" << std::endl;
-          if (renderResult.success)
-            note << "Rendered to: " << renderResult.outputPath << std::endl;
-          continue;
-        }
+      if (largestImg &&
+          largestImgArea > elements.pageWidth * elements.pageHeight * 0.1) {
+        out << "  ANOMALY: L1 has no rectangle but has image "
+               "resembling one ("
+            << largestImg->displayWidth << " x "
+            << largestImg->displayHeight << " pt)" << std::endl;
 
-        std::cout << "  ANOMALY: L1 has no rectangle and no suitable image"
-                  << std::endl;
-        std::ofstream note(anomaliesDir / (stem + "_note.txt"));
-        note << "L1 file has no rectangle of interest and no image "
+        ocr::OCRAnalysis::PNGRenderResult renderResult =
+            analyzer.renderElementsToPNG(elements, pdfStr, dpi,
+                                         anomaliesDir.string(), boundsMode);
+        std::ostream &note = record.openNote(notePath);
+        note << "L1 file has no rectangle but contains an image "
                 "resembling a rectangle."
              << std::endl;
-        continue;
-      } else {
-        std::cout << "  ANOMALY: No rectangle found" << std::endl;
-        std::ofstream note(anomaliesDir / (stem + "_note.txt"));
-        note << "No rectangle of interest found in PDF." << std::endl;
-        continue;
+        note << "Image: " << largestImg->displayWidth << " x "
+             << largestImg->displayHeight << " pt at ("
+             << largestImg->x << ", " << largestImg->y << ")" << std::endl;
+        if (renderResult.success) {
+          note << "Rendered to: " << renderResult.outputPath << std::endl;
+          record.outputs.push_back(renderResult.outputPath);
+        }
+        return;
       }
+
+      out << "  ANOMALY: L1 has no rectangle and no suitable image"
+          << std::endl;
+      std::ostream &note = record.openNote(notePath);
+      note << "L1 file has no rectangle of interest and no image "
+              "resembling a rectangle."
+           << std::endl;
+      return;
     } else {
-      // Crop marks mode
-      if (elements.linesBoundingBoxWidth > 0 &&
-          elements.linesBoundingBoxHeight > 0) {
-        roiMinX = elements.linesBoundingBoxX;
-        roiMinY = elements.linesBoundingBoxY;
-        roiMaxX = roiMinX + elements.linesBoundingBoxWidth;
-        roiMaxY = roiMinY + elements.linesBoundingBoxHeight;
-        std::cout << "  ROI: crop marks (" << elements.linesBoundingBoxWidth
-                  << " x " << elements.linesBoundingBoxHeight << " pt)"
-                  << std::endl;
-      } else {
-        std::cout << "  WARNING: No crop marks found, using full page"
-                  << std::endl;
-        roiMinX = elements.pageX;
-        roiMinY = elements.pageY;
-        roiMaxX = elements.pageX + elements.pageWidth;
-        roiMaxY = elements.pageY + elements.pageHeight;
-      }
+      out << "  ANOMALY: No rectangle found" << std::endl;
+      std::ostream &note = record.openNote(notePath);
+      note << "No rectangle of interest found in PDF." << std::endl;
+      return;
     }
-
-    // 3. Collect hidden text within ROI
-    std::vector<ocr::TextRegion> hiddenInROI;
-    for (const auto &hidden : elements.hiddenTextLines) {
-      if (regionInBounds(hidden, roiMinX, roiMinY, roiMaxX, roiMaxY))
-        hiddenInROI.push_back(hidden);
+  } else {
+    // Crop marks mode
+    if (elements.linesBoundingBoxWidth > 0 &&
+        elements.linesBoundingBoxHeight > 0) {
+      roiMinX = elements.linesBoundingBoxX;
+      roiMinY = elements.linesBoundingBoxY;
+      roiMaxX = roiMinX + elements.linesBoundingBoxWidth;
+      roiMaxY = roiMinY + elements.linesBoundingBoxHeight;
+      out << "  ROI: crop marks (" << elements.linesBoundingBoxWidth
+          << " x " << elements.linesBoundingBoxHeight << " pt)"
+          << std::endl;
+    } else {
+      out << "  WARNING: No crop marks found, using full page"
+          << std::endl;
+      roiMinX = elements.pageX;
+      roiMinY = elements.pageY;
+      roiMaxX = elements.pageX + elements.pageWidth;
+      roiMaxY = elements.pageY + elements.pageHeight;
     }
+  }
 
-    // 4. Collect DataMatrix barcodes within ROI (these are valid)
-    std::vector<ocr::OCRAnalysis::PDFDataMatrix> dmInROI;
-    for (const auto &dm : elements.dataMatrices) {
-      if (dataMatrixInBounds(dm, roiMinX, roiMinY, roiMaxX, roiMaxY))
-        dmInROI.push_back(dm);
-    }
+  // 3. Collect hidden text within ROI
+  std::vector<ocr::TextRegion> hiddenInROI;
+  for (const auto &hidden : elements.hiddenTextLines) {
+    if (regionInBounds(hidden, roiMinX, roiMinY, roiMaxX, roiMaxY))
+      hiddenInROI.push_back(hidden);
+  }
+
+  // 4. Collect DataMatrix barcodes within ROI (these are valid)
+  std::vector<ocr::OCRAnalysis::PDFDataMatrix> dmInROI;
+  for (const auto &dm : elements.dataMatrices) {
+    if (dataMatrixInBounds(dm, roiMinX, roiMinY, roiMaxX, roiMaxY))
+      dmInROI.push_back(dm);
+  }
 
-    // 5. Route: hidden elements in ROI → Anomalies, otherwise → Processed
-    bool isAnomaly = !hiddenInROI.empty();
-    fs::path destDir = isAnomaly ? anomaliesDir : processedDir;
+  // 5. Route: hidden elements in ROI → Anomalies, otherwise → Processed
+  bool isAnomaly = !hiddenInROI.empty();
+  fs::path destDir = isAnomaly ? anomaliesDir : processedDir;
 
-    ocr::OCRAnalysis::PNGRenderResult renderResult =
-        analyzer.renderElementsToPNG(elements, pdfStr, dpi,
-                                     destDir.string(), boundsMode);
+  // The render is kept in memory so annotation and the single PNG encode
+  // happen on the same pixels, without a write/read/re-write round trip.
+  ocr::OCRAnalysis::PNGRenderResult renderResult =
+      analyzer.renderElementsToPNG(elements, pdfStr, dpi,
+                                   destDir.string(), boundsMode, "", true);
 
-    if (!renderResult.success) {
-      std::cerr << "  FAILED to render: " << renderResult.errorMessage
-                << std::endl;
-      std::ofstream note(anomaliesDir / (stem + "_note.txt"));
-      note << "Failed to render PDF: " << renderResult.errorMessage
-           << std::endl;
-      continue;
+  if (!renderResult.success) {
+    err << "  FAILED to render: " << renderResult.errorMessage
+        << std::endl;
+    std::ostream &note = record.openNote(notePath);
+    note << "Failed to render PDF: " << renderResult.errorMessage
+         << std::endl;
+    return;
+  }
+
+  // 6. Annotate: red boxes for hidden elements, green for DataMatrix,
+  //    then write the (annotated) render
+  cv::Mat &img = renderResult.image;
+  if (!img.empty()) {
+    if (!hiddenInROI.empty() || !dmInROI.empty())
+      annotateImage(img, dpi, roiMinX, roiMinY, roiMaxY, hiddenInROI,
+                    dmInROI);
+    analyzer.writeImage(renderResult.outputPath, img);
+    record.outputs.push_back(renderResult.outputPath);
+  }
+
+  if (isAnomaly) {
+    out << "  ANOMALY: " << hiddenInROI.size()
+        << " hidden text element(s) in ROI → Anomalies" << std::endl;
+    for (const auto &h : hiddenInROI)
+      out << "    \"" << h.text << "\"" << std::endl;
+
+    std::ostream &note = record.openNote(notePath);
+    note << "Hidden text elements found within the rectangle of interest:"
+         << std::endl;
+    for (const auto &h : hiddenInROI)
+      note << "  \"" << h.text << "\" at (" << h.preciseX << ", "
+           << h.preciseY << ") size " << h.preciseWidth << " x "
+           << h.preciseHeight << " pt" << std::endl;
+  } else {
+    out << "  OK → Processed";
+    if (!dmInROI.empty())
+      out << " [" << dmInROI.size() << " DataMatrix marked green]";
+    out << std::endl;
+  }
+
+  out << std::endl;
+
+}
+
+// Per-worker deques of document indices.  Documents are dealt round-robin so
+// every worker starts near the front of the sorted list; a worker takes from
+// the front of its own deque and, once that is empty, steals from the back of
+// another worker's.  A run of slow documents therefore never leaves threads
+// idle while someone else still has a backlog.
+class WorkStealingQueues {
+public:
+  WorkStealingQueues(size_t count, int workers) {
+    for (int w = 0; w < workers; ++w)
+      m_lanes.push_back(std::make_unique<Lane>());
+    for (size_t i = 0; i < count; ++i)
+      m_lanes[i % m_lanes.size()]->items.push_back(i);
+  }
+
+  // Next document for @p worker; false once every deque is empty.
+  bool next(int worker, size_t &item) {
+    {
+      Lane &own = *m_lanes[worker];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.items.empty()) {
+        item = own.items.front();
+        own.items.pop_front();
+        return true;
+      }
     }
+    for (size_t k = 1; k < m_lanes.size(); ++k) {
+      Lane &victim = *m_lanes[(worker + k) % m_lanes.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.items.empty()) {
+        item = victim.items.back();
+        victim.items.pop_back();
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  struct Lane {
+    std::mutex mutex;
+    std::deque<size_t> items;
+  };
+  std::vector<std::unique_ptr<Lane>> m_lanes;
+};
 
-    // 6. Annotate: red boxes for hidden elements, green for DataMatrix
-    if (!hiddenInROI.empty() || !dmInROI.empty()) {
-      cv::Mat img = cv::imread(renderResult.outputPath, cv::IMREAD_COLOR);
-      if (!img.empty()) {
-        annotateImage(img, dpi, roiMinX, roiMinY, roiMaxY, hiddenInROI,
-                      dmInROI);
-        // Overwrite the rendered image with the annotated version
-        cv::imwrite(renderResult.outputPath, img);
+// Process @p pdfFiles on @p jobs threads, each with its own analyzer (and so
+// its own Poppler documents and Tesseract engine).  Console output, the
+// library diagnostics logged while a document was processed, and note
+// files are released strictly in list order as soon as every earlier
+// document has finished.  @p records receives one entry per file.  Returns
+// the number of image writes that failed.
+static size_t processParallel(const std::vector<fs::path> &pdfFiles, int jobs,
+                              const ocr::OCRConfig &config,
+                              const fs::path &processedDir,
+                              const fs::path &anomaliesDir, double dpi,
+                              std::vector<DocRecord> &records) {
+  struct Slot {
+    std::ostringstream out, err;
+    bool done = false;
+  };
+  std::vector<Slot> slots(pdfFiles.size());
+  std::mutex emitMutex;
+  size_t nextToEmit = 0;
+  std::atomic<size_t> failedWrites{0};
+  WorkStealingQueues queues(pdfFiles.size(), jobs);
+
+  auto worker = [&](int id) {
+    ocr::OCRAnalysis analyzer(config);
+    size_t i;
+    while (queues.next(id, i)) {
+      Slot &slot = slots[i];
+      try {
+        ScopedLogCapture capture(slot.err);
+        processPdf(analyzer, pdfFiles[i], processedDir, anomaliesDir, dpi,
+                   slot.out, slot.err, records[i]);
+      } catch (const std::exception &e) {
+        slot.err << "  FAILED: " << e.what() << std::endl;
+      }
+
+      std::lock_guard<std::mutex> lock(emitMutex);
+      slot.done = true;
+      while (nextToEmit < slots.size() && slots[nextToEmit].done) {
+        records[nextToEmit].writeNote();
+        Slot &ready = slots[nextToEmit++];
+        std::cout << ready.out.str() << std::flush;
+        std::cerr << ready.err.str() << std::flush;
+        ready.out.str({});
+        ready.err.str({});
       }
     }
+    failedWrites += analyzer.waitForImageWrites();
+  };
 
-    if (isAnomaly) {
-      std::cout << "  ANOMALY: " << hiddenInROI.size()
-                << " hidden text element(s) in ROI → Anomalies" << std::endl;
-      for (const auto &h : hiddenInROI)
-        std::cout << "    \"" << h.text << "\"" << std::endl;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < jobs; ++t)
+    threads.emplace_back(worker, t);
+  for (auto &t : threads)
+    t.join();
+  return failedWrites;
+}
 
-      std::ofstream note(anomaliesDir / (stem + "_note.txt"));
-      note << "Hidden text elements found within the rectangle of interest:"
-           << std::endl;
-      for (const auto &h : hiddenInROI)
-        note << "  \"" << h.text << "\" at (" << h.preciseX << ", "
-             << h.preciseY << ") size " << h.preciseWidth << " x "
-             << h.preciseHeight << " pt" << std::endl;
-    } else {
-      std::cout << "  OK → Processed";
-      if (!dmInROI.empty())
-        std::cout << " [" << dmInROI.size() << " DataMatrix marked green]";
-      std::cout << std::endl;
+// ── Incremental runs ─────────────────────────────────────────────────────────
+//
+// Every run records, per input PDF, the file's size, modification time and
+// content hash together with the files it produced.  An incremental run
+// (-i) skips a PDF whose hash and run options are unchanged and whose
+// outputs still exist, deletes the outputs of PDFs that have changed or
+// disappeared, and processes the rest.
+
+static const char *const kManifestName = ".pdfcheck_manifest";
+
+// What a run recorded for one input PDF.
+struct ManifestEntry {
+  std::uintmax_t size = 0;
+  long long mtime = 0;              ///< file_time_type ticks
+  std::string hash;                 ///< FNV-1a 64 of the contents (hex)
+  std::vector<std::string> outputs; ///< Relative to the input folder
+};
+
+struct Manifest {
+  std::string options; ///< Library and detection versions, render settings
+  std::map<std::string, ManifestEntry> entries; ///< Keyed by PDF file name
+};
+
+static std::string hashFile(const fs::path &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+    return {};
+  std::uint64_t h = 14695981039346656037ull;
+  std::vector<char> buf(1 << 16);
+  while (in) {
+    in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+    std::streamsize n = in.gcount();
+    for (std::streamsize i = 0; i < n; ++i) {
+      h ^= static_cast<unsigned char>(buf[i]);
+      h *= 1099511628211ull;
+    }
+  }
+  char hex[17];
+  std::snprintf(hex, sizeof(hex), "%016llx",
+                static_cast<unsigned long long>(h));
+  return hex;
+}
+
+// Tab-separated: a header line, an "options" line, then one line per PDF
+// (name, size, mtime, hash, outputs...).  Returns false if there is no
+// readable manifest.
+static bool loadManifest(const fs::path &path, Manifest &manifest) {
+  std::ifstream in(path);
+  std::string line;
+  if (!in || !std::getline(in, line) || line != "pdfcheck-manifest 1")
+    return false;
+  while (std::getline(in, line)) {
+    std::vector<std::string> fields;
+    std::istringstream ss(line);
+    for (std::string f; std::getline(ss, f, '\t');)
+      fields.push_back(f);
+    if (fields.size() == 2 && fields[0] == "options") {
+      manifest.options = fields[1];
+    } else if (fields.size() >= 4) {
+      ManifestEntry &e = manifest.entries[fields[0]];
+      e.size = std::strtoull(fields[1].c_str(), nullptr, 10);
+      e.mtime = std::strtoll(fields[2].c_str(), nullptr, 10);
+      e.hash = fields[3];
+      e.outputs.assign(fields.begin() + 4, fields.end());
     }
+  }
+  return true;
+}
 
-    std::cout << std::endl;
+// Written to a temporary file and renamed, so an interrupted run leaves the
+// previous manifest intact.
+static bool saveManifest(const fs::path &path, const Manifest &manifest) {
+  fs::path tmp = path;
+  tmp += ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out)
+      return false;
+    out << "pdfcheck-manifest 1\n";
+    out << "options\t" << manifest.options << "\n";
+    for (const auto &[name, e] : manifest.entries) {
+      out << name << '\t' << e.size << '\t' << e.mtime << '\t' << e.hash;
+      for (const auto &o : e.outputs)
+        out << '\t' << o;
+      out << '\n';
+    }
+    if (!out)
+      return false;
   }
+  std::error_code ec;
+  fs::rename(tmp, path, ec);
+  return !ec;
+}
 
-  // Summary
+static bool outputsExist(const fs::path &root,
+                         const std::vector<std::string> &outputs) {
+  for (const auto &o : outputs)
+    if (!fs::exists(root / o))
+      return false;
+  return true;
+}
+
+static void removeOutputs(const fs::path &root,
+                          const std::vector<std::string> &outputs) {
+  std::error_code ec;
+  for (const auto &o : outputs)
+    fs::remove(root / o, ec);
+}
+
+static void printSummary(const fs::path &processedDir,
+                         const fs::path &anomaliesDir) {
   int processedCount = 0, anomalyCount = 0;
   for (auto &entry : fs::directory_iterator(processedDir)) {
     if (entry.path().extension() == ".png")
@@ -332,6 +577,643 @@ int main(int argc, char *argv[]) {
             << std::endl;
   std::cout << "  Anomalies: " << anomalyCount << " PDF(s) flagged"
             << std::endl;
+}
+
+// ── Watch mode ───────────────────────────────────────────────────────────────
+
+static std::atomic<bool> g_stopWatching{false};
+
+static void onStopSignal(int) { g_stopWatching = true; }
+
+// Fixed-capacity FIFO between the folder watcher and the workers.  push()
+// blocks while the queue is full, so a burst of drops cannot grow memory
+// without bound; it gives up if @p stop is raised while waiting.
+template <typename T> class BoundedQueue {
+public:
+  explicit BoundedQueue(size_t capacity) : m_capacity(capacity) {}
+
+  bool push(T item, const std::atomic<bool> &stop) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_closed && m_items.size() >= m_capacity) {
+      if (stop)
+        return false;
+      m_notFull.wait_for(lock, std::chrono::milliseconds(200));
+    }
+    if (m_closed)
+      return false;
+    m_items.push_back(std::move(item));
+    m_notEmpty.notify_one();
+    return true;
+  }
+
+  // Next item; false once the queue has been closed.
+  bool pop(T &item) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notEmpty.wait(lock, [&] { return m_closed || !m_items.empty(); });
+    if (m_closed)
+      return false;
+    item = std::move(m_items.front());
+    m_items.pop_front();
+    m_notFull.notify_one();
+    return true;
+  }
+
+  // Wake every waiter; items still queued are dropped.
+  void close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = true;
+    m_notEmpty.notify_all();
+    m_notFull.notify_all();
+  }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_notEmpty, m_notFull;
+  std::deque<T> m_items;
+  size_t m_capacity;
+  bool m_closed = false;
+};
+
+// Reports PDFs that have been completely written to, or removed from, a
+// folder.  On Linux this uses inotify (IN_CLOSE_WRITE / IN_MOVED_TO, so a
+// file still being copied is never reported); elsewhere the folder is
+// polled and a file is reported once its size and mtime are unchanged
+// between two polls.  Files present at construction are not reported.
+// If the inotify queue overflows, events have been lost: every PDF in the
+// folder is reported as ready and poll() returns true, so the caller can
+// look for removals it missed.
+class FolderWatcher {
+public:
+  explicit FolderWatcher(const fs::path &dir) : m_dir(dir) {
+#ifdef __linux__
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd >= 0 &&
+        inotify_add_watch(m_fd, dir.c_str(),
+                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE |
+                              IN_MOVED_FROM) < 0) {
+      close(m_fd);
+      m_fd = -1;
+    }
+#else
+    std::vector<fs::path> ignored;
+    scan(ignored, ignored);
+    for (auto &[path, seen] : m_seen)
+      seen.reported = true;
+#endif
+  }
+
+  ~FolderWatcher() {
+#ifdef __linux__
+    if (m_fd >= 0)
+      close(m_fd);
+#endif
+  }
+
+  FolderWatcher(const FolderWatcher &) = delete;
+  FolderWatcher &operator=(const FolderWatcher &) = delete;
+
+  bool ok() const {
+#ifdef __linux__
+    return m_fd >= 0;
+#else
+    return true;
+#endif
+  }
+
+  // Wait up to @p timeoutMs for changes, appending finished PDFs to
+  // @p ready and deleted ones to @p removed.  Returns true if events were
+  // lost and the whole folder was reported instead.
+  bool poll(int timeoutMs, std::vector<fs::path> &ready,
+            std::vector<fs::path> &removed) {
+#ifdef __linux__
+    pollfd pfd{m_fd, POLLIN, 0};
+    if (::poll(&pfd, 1, timeoutMs) <= 0)
+      return false;
+    alignas(inotify_event) char buf[64 * 1024];
+    ssize_t n;
+    bool overflow = false;
+    while ((n = read(m_fd, buf, sizeof(buf))) > 0) {
+      for (char *p = buf; p < buf + n;) {
+        auto *ev = reinterpret_cast<inotify_event *>(p);
+        p += sizeof(inotify_event) + ev->len;
+        if (ev->mask & IN_Q_OVERFLOW)
+          overflow = true; // carries no name; handled below
+        if (ev->len == 0 || (ev->mask & IN_ISDIR))
+          continue;
+        fs::path file = m_dir / ev->name;
+        if (!isPdfFile(file))
+          continue;
+        if (ev->mask & (IN_DELETE | IN_MOVED_FROM))
+          removed.push_back(file);
+        else
+          ready.push_back(file);
+      }
+    }
+    if (overflow) {
+      // The events reported above are a subset of what happened; report
+      // every PDF present now.  Unchanged ones are skipped by their hash.
+      ready.clear();
+      removed.clear();
+      std::error_code ec;
+      for (auto &entry : fs::directory_iterator(m_dir, ec))
+        if (entry.is_regular_file() && isPdfFile(entry.path()))
+          ready.push_back(entry.path());
+    }
+    return overflow;
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+    scan(ready, removed);
+    return false;
+#endif
+  }
+
+private:
+#ifndef __linux__
+  struct Seen {
+    std::uintmax_t size = 0;
+    fs::file_time_type mtime;
+    bool reported = false;
+  };
+
+  void scan(std::vector<fs::path> &ready, std::vector<fs::path> &removed) {
+    std::set<fs::path> present;
+    std::error_code ec;
+    for (auto &entry : fs::directory_iterator(m_dir, ec)) {
+      if (!entry.is_regular_file() || !isPdfFile(entry.path()))
+        continue;
+      present.insert(entry.path());
+      std::uintmax_t size = entry.file_size(ec);
+      fs::file_time_type mtime = entry.last_write_time(ec);
+      Seen &seen = m_seen[entry.path()];
+      if (seen.size != size || seen.mtime != mtime) {
+        seen.size = size;
+        seen.mtime = mtime;
+        seen.reported = false;
+      } else if (!seen.reported) {
+        seen.reported = true;
+        ready.push_back(entry.path());
+      }
+    }
+    for (auto it = m_seen.begin(); it != m_seen.end();) {
+      if (present.count(it->first)) {
+        ++it;
+      } else {
+        removed.push_back(it->first);
+        it = m_seen.erase(it);
+      }
+    }
+  }
+
+  std::map<fs::path, Seen> m_seen;
+#endif
+
+  fs::path m_dir;
+#ifdef __linux__
+  int m_fd = -1;
+#endif
+};
+
+// Keep checking PDFs as they arrive until SIGINT/SIGTERM.  @p jobs warm
+// workers, each with its own analyzer, take files from a bounded queue fed
+// by @p watcher.  A file is never processed by two workers at once: one
+// that changes while it is being processed is queued again, once, when
+// that pass finishes.  Every finished document is recorded in @p manifest,
+// which is saved at most once a second and again on the way out, so a
+// later -i run sees the same state.
+static void watchFolder(FolderWatcher &watcher, int jobs,
+                        const ocr::OCRConfig &config, const fs::path &inputDir,
+                        const fs::path &processedDir,
+                        const fs::path &anomaliesDir, double dpi,
+                        Manifest &manifest, const fs::path &manifestPath) {
+  BoundedQueue<fs::path> queue(64);
+  std::mutex stateMutex;          // manifest, the sets below and console
+  std::set<std::string> queued;   // names waiting in the queue
+  std::set<std::string> inFlight; // names a worker is processing
+  std::set<std::string> changed;  // in flight and changed since it started
+  std::vector<fs::path> requeue;  // finished, changed meanwhile: queue again
+  bool manifestDirty = false;     // manifest changed since the last save
+
+  // Write the manifest if it changed.  Only the watch loop calls this, and
+  // the file is written from a copy so workers are not held up by the I/O.
+  auto saveIfDirty = [&] {
+    Manifest snapshot;
+    {
+      std::lock_guard<std::mutex> lock(stateMutex);
+      if (!manifestDirty)
+        return;
+      snapshot = manifest;
+      manifestDirty = false;
+    }
+    if (!saveManifest(manifestPath, snapshot)) {
+      std::lock_guard<std::mutex> lock(stateMutex);
+      manifestDirty = true; // try again next time
+      std::cerr << "WARNING: could not write " << manifestPath.string()
+                << std::endl;
+    }
+  };
+
+  // Check one PDF and record it in the manifest.
+  auto checkOne = [&](ocr::OCRAnalysis &analyzer, const fs::path &pdfPath) {
+    const std::string name = pdfPath.filename().string();
+    ManifestEntry entry;
+    std::error_code ec;
+    entry.size = fs::file_size(pdfPath, ec);
+    entry.mtime = static_cast<long long>(
+        fs::last_write_time(pdfPath, ec).time_since_epoch().count());
+    entry.hash = hashFile(pdfPath);
+    if (entry.hash.empty())
+      return; // removed again before we got to it
+
+    {
+      std::lock_guard<std::mutex> lock(stateMutex);
+      auto it = manifest.entries.find(name);
+      if (it != manifest.entries.end()) {
+        if (it->second.hash == entry.hash &&
+            outputsExist(inputDir, it->second.outputs))
+          return; // rewritten with identical contents
+        removeOutputs(inputDir, it->second.outputs);
+      }
+    }
+
+    std::ostringstream out, err;
+    DocRecord record;
+    try {
+      ScopedLogCapture capture(err);
+      processPdf(analyzer, pdfPath, processedDir, anomaliesDir, dpi, out,
+                 err, record);
+    } catch (const std::exception &e) {
+      err << "  FAILED: " << e.what() << std::endl;
+    }
+    record.writeNote();
+    // The report is complete only once its images are on disk.
+    if (size_t failed = analyzer.waitForImageWrites())
+      err << "WARNING: " << failed << " image file(s) failed to write"
+          << std::endl;
+
+    for (const auto &o : record.outputs) {
+      fs::path rel = o.lexically_relative(inputDir);
+      entry.outputs.push_back((rel.empty() ? o : rel).generic_string());
+    }
+
+    std::lock_guard<std::mutex> lock(stateMutex);
+    manifest.entries[name] = std::move(entry);
+    manifestDirty = true;
+    std::cout << out.str() << std::flush;
+    std::cerr << err.str() << std::flush;
+  };
+
+  auto worker = [&]() {
+    ocr::OCRAnalysis analyzer(config);
+    fs::path pdfPath;
+    while (queue.pop(pdfPath)) {
+      const std::string name = pdfPath.filename().string();
+      {
+        // Changes from here on are remembered in `changed` rather than
+        // queueing the file while this pass is still running.
+        std::lock_guard<std::mutex> lock(stateMutex);
+        queued.erase(name);
+        inFlight.insert(name);
+      }
+      checkOne(analyzer, pdfPath);
+      std::lock_guard<std::mutex> lock(stateMutex);
+      inFlight.erase(name);
+      // Handed to the watch loop: pushing here could block every worker
+      // on a full queue that only workers drain.
+      if (changed.erase(name))
+        requeue.push_back(pdfPath);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < jobs; ++t)
+    threads.emplace_back(worker);
+
+  std::vector<fs::path> ready, removed;
+  auto lastSave = std::chrono::steady_clock::now();
+  while (!g_stopWatching) {
+    ready.clear();
+    removed.clear();
+    if (watcher.poll(500, ready, removed)) {
+      // Events were lost: every PDF present has been reported, and anything
+      // in the manifest that has gone must have been removed.
+      std::lock_guard<std::mutex> lock(stateMutex);
+      std::cout << "WARNING: change events lost, rescanning "
+                << inputDir.string() << std::endl;
+      for (const auto &[name, entry] : manifest.entries)
+        if (!fs::exists(inputDir / name))
+          removed.push_back(inputDir / name);
+    }
+    {
+      std::lock_guard<std::mutex> lock(stateMutex);
+      ready.insert(ready.end(), requeue.begin(), requeue.end());
+      requeue.clear();
+    }
+
+    for (const auto &path : removed) {
+      std::lock_guard<std::mutex> lock(stateMutex);
+      auto it = manifest.entries.find(path.filename().string());
+      if (it == manifest.entries.end())
+        continue;
+      removeOutputs(inputDir, it->second.outputs);
+      manifest.entries.erase(it);
+      manifestDirty = true;
+      std::cout << "--- Removed: " << path.stem().string() << " ---"
+                << std::endl
+                << std::endl;
+    }
+
+    for (const auto &path : ready) {
+      {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        const std::string name = path.filename().string();
+        if (inFlight.count(name)) {
+          changed.insert(name); // queued again when that pass ends
+          continue;
+        }
+        if (!queued.insert(name).second)
+          continue; // already waiting
+      }
+      if (!queue.push(path, g_stopWatching))
+        break;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastSave >= std::chrono::seconds(1)) {
+      saveIfDirty();
+      lastSave = now;
+    }
+  }
+
+  // Let each worker finish its current document; anything still queued is
+  // picked up by the start-up scan of the next run.
+  queue.close();
+  for (auto &t : threads)
+    t.join();
+  saveIfDirty();
+}
+
+int main(int argc, char *argv[]) {
+  // Parse "[-i] [-w] [-j N] [--trace FILE] <folder>"; -j 0 uses one worker
+  // per hardware thread.
+  int jobs = 1;
+  bool incremental = false;
+  bool watch = false;
+  fs::path inputDir;
+  fs::path tracePath;
+  bool badArgs = false;
+  for (int a = 1; a < argc; ++a) {
+    std::string arg = argv[a];
+    if (arg == "-i")
+      incremental = true;
+    else if (arg == "-w")
+      watch = true;
+    else if (arg == "-j" && a + 1 < argc)
+      jobs = std::atoi(argv[++a]);
+    else if (arg.rfind("-j", 0) == 0 && arg.size() > 2)
+      jobs = std::atoi(arg.c_str() + 2);
+    else if (arg == "--trace" && a + 1 < argc)
+      tracePath = argv[++a];
+    else if (inputDir.empty() && arg[0] != '-')
+      inputDir = arg;
+    else
+      badArgs = true;
+  }
+
+  if (badArgs || inputDir.empty() || jobs < 0) {
+    std::cerr << "Usage: pdfcheck [-i] [-w] [-j N] [--trace FILE] <folder>"
+              << std::endl;
+    std::cerr << "  Processes all PDF files in <folder>." << std::endl;
+    std::cerr << "  Creates Processed/ and Anomalies/ subfolders." << std::endl;
+    std::cerr << "  -i    Incremental: only re-check PDFs that changed since "
+                 "the last run"
+              << std::endl;
+    std::cerr << "  -w    Keep running and check PDFs as they are added "
+                 "(Ctrl+C to stop)"
+              << std::endl;
+    std::cerr << "  -j N  Check N PDFs at a time (0 = one per hardware thread)"
+              << std::endl;
+    std::cerr << "  --trace FILE  Write a Chrome trace of the run to FILE "
+                 "(open in Perfetto; not with -w)"
+              << std::endl;
+    return 1;
+  }
+  if (jobs == 0)
+    jobs = std::max(1u, std::thread::hardware_concurrency());
+
+  // Trace events stay in memory until the file is written at exit, which a
+  // watch never reaches in bounded memory.
+  if (watch && !tracePath.empty()) {
+    std::cerr << "Error: --trace cannot be combined with -w." << std::endl;
+    return 1;
+  }
+
+  if (!fs::is_directory(inputDir)) {
+    std::cerr << "Error: \"" << inputDir.string() << "\" is not a directory."
+              << std::endl;
+    return 1;
+  }
+
+  // The trace is written when main returns, whichever way it does.
+  struct TraceWriter {
+    fs::path path;
+    ~TraceWriter() {
+      if (path.empty())
+        return;
+      if (ocr::Tracer::writeJson(path.string()))
+        std::cout << "Trace written to " << path.string() << std::endl;
+      else
+        std::cerr << "WARNING: could not write " << path.string()
+                  << std::endl;
+    }
+  } traceWriter{tracePath};
+  if (!tracePath.empty())
+    ocr::Tracer::start();
+
+  fs::path processedDir = inputDir / "Processed";
+  fs::path anomaliesDir = inputDir / "Anomalies";
+
+  std::cout << "Input folder : " << inputDir.string() << std::endl;
+  std::cout << "Processed    : " << processedDir.string() << std::endl;
+  std::cout << "Anomalies    : " << anomaliesDir.string() << std::endl;
+
+  // An incremental run keeps the existing outputs, but only if there is a
+  // manifest saying which PDF produced them; otherwise start clean.
+  const fs::path manifestPath = inputDir / kManifestName;
+  Manifest previous;
+  if (incremental && !loadManifest(manifestPath, previous)) {
+    std::cout << "No manifest found; checking every PDF." << std::endl;
+    incremental = false;
+  }
+  if (incremental) {
+    fs::create_directories(processedDir);
+    fs::create_directories(anomaliesDir);
+  } else {
+    ensureEmptyDir(processedDir);
+    ensureEmptyDir(anomaliesDir);
+  }
+
+  // In watch mode, start watching before the folder is listed so that a
+  // file dropped during the initial pass is not missed.
+  std::unique_ptr<FolderWatcher> watcher;
+  if (watch) {
+    watcher = std::make_unique<FolderWatcher>(inputDir);
+    if (!watcher->ok()) {
+      std::cerr << "Error: cannot watch \"" << inputDir.string() << "\"."
+                << std::endl;
+      return 1;
+    }
+  }
+
+  // Collect PDF files
+  std::vector<fs::path> pdfFiles;
+  for (auto &entry : fs::directory_iterator(inputDir)) {
+    if (entry.is_regular_file() && isPdfFile(entry.path()))
+      pdfFiles.push_back(entry.path());
+  }
+
+  if (pdfFiles.empty() && previous.entries.empty() && !watcher) {
+    std::cout << "No PDF files found in " << inputDir.string() << std::endl;
+    return 0;
+  }
+
+  std::sort(pdfFiles.begin(), pdfFiles.end());
+  std::cout << "Found " << pdfFiles.size() << " PDF file(s)." << std::endl
+            << std::endl;
+
+  // PNGs are encoded on background threads while the next PDF is analysed;
+  // waitForImageWrites() below flushes them before the summary.
+  ocr::OCRConfig config;
+  config.imageWriterThreads = 2;
+  const double dpi = 300.0;
+
+  // ── Decide what needs checking ─────────────────────────────────────────────
+  Manifest manifest;
+  manifest.options =
+      "lib=" + ocr::OCRAnalysis::getLibraryVersion() + " detect=" +
+      std::to_string(ocr::OCRAnalysis::getDetectionRevision()) +
+      " tesseract=" + ocr::OCRAnalysis::getTesseractVersion() +
+      " dpi=" + std::to_string(static_cast<int>(dpi));
+  const bool sameOptions = incremental && previous.options == manifest.options;
+
+  // Size and mtime of every input; the contents are only re-hashed when
+  // either differs from the manifest.
+  std::vector<ManifestEntry> current(pdfFiles.size());
+  std::vector<size_t> toHash;
+  for (size_t i = 0; i < pdfFiles.size(); ++i) {
+    std::error_code ec;
+    current[i].size = fs::file_size(pdfFiles[i], ec);
+    current[i].mtime = static_cast<long long>(
+        fs::last_write_time(pdfFiles[i], ec).time_since_epoch().count());
+    auto it = previous.entries.find(pdfFiles[i].filename().string());
+    if (it != previous.entries.end() && it->second.size == current[i].size &&
+        it->second.mtime == current[i].mtime)
+      current[i].hash = it->second.hash;
+    else
+      toHash.push_back(i);
+  }
+  cv::parallel_for_(cv::Range(0, static_cast<int>(toHash.size())),
+                    [&](const cv::Range &range) {
+                      for (int k = range.start; k < range.end; ++k)
+                        current[toHash[k]].hash = hashFile(pdfFiles[toHash[k]]);
+                    });
+
+  std::vector<fs::path> todo;
+  std::vector<size_t> todoIndex;
+  std::set<std::string> present;
+  size_t unchanged = 0, removed = 0;
+  for (size_t i = 0; i < pdfFiles.size(); ++i) {
+    std::string name = pdfFiles[i].filename().string();
+    present.insert(name);
+    auto it = previous.entries.find(name);
+    if (it != previous.entries.end()) {
+      const ManifestEntry &old = it->second;
+      if (sameOptions && !current[i].hash.empty() &&
+          old.hash == current[i].hash && outputsExist(inputDir, old.outputs)) {
+        ManifestEntry &kept = manifest.entries[name];
+        kept = current[i];
+        kept.outputs = old.outputs;
+        ++unchanged;
+        continue;
+      }
+      removeOutputs(inputDir, old.outputs);
+    }
+    todo.push_back(pdfFiles[i]);
+    todoIndex.push_back(i);
+  }
+  for (const auto &[name, old] : previous.entries) {
+    if (!present.count(name)) {
+      removeOutputs(inputDir, old.outputs);
+      ++removed;
+    }
+  }
+  if (incremental)
+    std::cout << "Incremental: " << unchanged << " unchanged, "
+              << todo.size() << " to check, " << removed
+              << " removed since the last run." << std::endl
+              << std::endl;
+
+  // ── Check ──────────────────────────────────────────────────────────────────
+  std::vector<DocRecord> records(todo.size());
+  const int workers = jobs;
+  jobs = static_cast<int>(std::min<size_t>(jobs, todo.size()));
+
+  // Documents are the unit of parallelism with several workers; share the
+  // remaining cores between the workers' own OpenCV loops instead of
+  // oversubscribing.
+  if (jobs > 1 || (watch && workers > 1)) {
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    cv::setNumThreads(std::max(1, hw / workers));
+  }
+
+  size_t failedWrites = 0;
+  if (jobs > 1) {
+    failedWrites = processParallel(todo, jobs, config, processedDir,
+                                   anomaliesDir, dpi, records);
+  } else if (!todo.empty()) {
+    ocr::OCRAnalysis analyzer(config);
+    for (size_t k = 0; k < todo.size(); ++k) {
+      try {
+        processPdf(analyzer, todo[k], processedDir, anomaliesDir, dpi,
+                   std::cout, std::cerr, records[k]);
+      } catch (const std::exception &e) {
+        std::cerr << "  FAILED: " << e.what() << std::endl;
+      }
+      records[k].writeNote();
+    }
+    failedWrites = analyzer.waitForImageWrites();
+  }
+
+  for (size_t k = 0; k < todo.size(); ++k) {
+    ManifestEntry &entry = manifest.entries[todo[k].filename().string()];
+    entry = current[todoIndex[k]];
+    for (const auto &o : records[k].outputs) {
+      fs::path rel = o.lexically_relative(inputDir);
+      entry.outputs.push_back((rel.empty() ? o : rel).generic_string());
+    }
+  }
+  if (!saveManifest(manifestPath, manifest))
+    std::cerr << "WARNING: could not write " << manifestPath.string()
+              << std::endl;
+
+  // Summary
+  if (failedWrites)
+    std::cerr << "WARNING: " << failedWrites << " image file(s) failed to write"
+              << std::endl;
+
+  printSummary(processedDir, anomaliesDir);
+
+  if (watch) {
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+    std::cout << std::endl
+              << "Watching " << inputDir.string() << " (Ctrl+C to stop)..."
+              << std::endl
+              << std::endl;
+    watchFolder(*watcher, workers, config, inputDir, processedDir,
+                anomaliesDir, dpi, manifest, manifestPath);
+    std::cout << "Stopped watching." << std::endl;
+    printSummary(processedDir, anomaliesDir);
+  }
 
   return 0;
 }
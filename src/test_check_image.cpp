@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <opencv2/opencv.hpp>
 #include <string>
 #include <vector>
 
@@ -119,8 +120,11 @@ int main(int argc, char *argv[]) {
 #ifndef NDEBUG
     std::cout << "\nBuilding relative map…\n";
 #endif
+    // The same photo is mapped and then checked, so locate its backing
+    // paper once and share the result between the two calls.
+    auto prepared = ocr::OCRAnalysis::preparePhoto(photo);
     auto relMap = analyzer.createRelativeMap(
-        l1Elements, photo, imagePath, /*markImage=*/false,
+        l1Elements, photo, prepared, imagePath, /*markImage=*/false,
         l1PdfPath, 300.0, l2PdfPath);
 
     if (!relMap.success) {
@@ -147,11 +151,46 @@ int main(int argc, char *argv[]) {
 #endif
 
     // ── Run check ─────────────────────────────────────────────────────────
+    // checkImage replaces `photo` with the annotated working image; keep a
+    // handle on the original pixels and a copy to compare them against.
+    const cv::Mat photoBuffer = photo;
+    const cv::Mat original = photo.clone();
+    std::vector<ocr::OCRAnalysis::ElementCheckResult> elements;
     auto t0 = std::chrono::steady_clock::now();
-    bool ok = analyzer.checkImage(photo, placeholders);
+    bool ok = analyzer.checkImage(relMap, photo, prepared, placeholders,
+                                  &elements);
     auto t1 = std::chrono::steady_clock::now();
     double checkMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
 
+    // ── Compare against the reference annotation ──────────────────────────
+    // The annotated image must be what checkImage has always produced: the
+    // backing-paper crop, turned by the map's rotation, with a green or red
+    // box round each checked region.  The photo itself must be untouched.
+    cv::Mat reference = ocr::OCRAnalysis::cropToLabel(original, 50, 40,
+                                                      /*tightLabel=*/false);
+    if (reference.empty())
+      reference = original.clone();
+    for (int r = 0; r < relMap.cwRotations; ++r) {
+      cv::Mat next;
+      cv::rotate(reference, next, cv::ROTATE_90_CLOCKWISE);
+      reference = next;
+    }
+    for (const auto &e : elements)
+      cv::rectangle(reference, e.roi,
+                    e.match ? cv::Scalar(0, 255, 0) : cv::Scalar(0, 0, 255), 2);
+
+    bool sameAnnotation = reference.size() == photo.size() &&
+                          reference.type() == photo.type() &&
+                          cv::norm(reference, photo, cv::NORM_INF) == 0;
+    bool photoUntouched = cv::norm(original, photoBuffer, cv::NORM_INF) == 0;
+    if (!sameAnnotation || !photoUntouched) {
+      std::cout << "Annotation mismatch:"
+                << (sameAnnotation ? "" : " annotated image differs from "
+                                          "the reference")
+                << (photoUntouched ? "" : " photo was modified") << "\n";
+      return 1;
+    }
+
     // ── Save annotated output ─────────────────────────────────────────────
     std::filesystem::path imgPath(imagePath);
     std::string outputPath = imgPath.parent_path().string() + "/" +
@@ -1,5 +1,7 @@
 #include "OCRAnalysis.hpp"
 
+#include <algorithm>
+#include <cstdlib>
 #include <filesystem>
 #include <iostream>
 #include <opencv2/opencv.hpp>
@@ -9,15 +11,54 @@ namespace fs = std::filesystem;
 static void printUsage(const char *prog) {
   std::cerr << "Usage: " << prog
             << " <input_image> <output_dir> <output_name> [--backing]\n"
+            << "       " << prog << " --compare <input_image> [...]\n"
             << "\n"
             << "  input_image  Path to the source image (PNG, JPEG, BMP, …)\n"
             << "  output_dir   Directory where the crop will be written\n"
             << "  output_name  Filename for the cropped image (e.g. crop.png)\n"
             << "  --backing    Return the full backing-paper region (step 1)\n"
-            << "               instead of the default tight label crop (step 2).\n";
+            << "               instead of the default tight label crop (step 2).\n"
+            << "  --compare    For each photo, compare the downscaled search\n"
+            << "               against the full-resolution search, for both\n"
+            << "               the backing paper and the label.  Fails if any\n"
+            << "               edge differs by more than 2 pixels.\n";
+}
+
+// ── --compare ───────────────────────────────────────────────────────────────
+// The pyramid search must find the same rectangle as the original
+// single-level search, within a couple of pixels, on real photos.
+static int compareWithFullResolution(int argc, char *argv[]) {
+  const int tolerancePx = 2;
+  int failures = 0;
+  for (int i = 2; i < argc; ++i) {
+    cv::Mat input = cv::imread(argv[i], cv::IMREAD_UNCHANGED);
+    if (input.empty()) {
+      std::cerr << "Error: could not read image: " << argv[i] << "\n";
+      ++failures;
+      continue;
+    }
+    for (bool tight : {false, true}) {
+      cv::Rect fast = ocr::OCRAnalysis::cropToLabelRect(input, 50, 40, tight);
+      cv::Rect full =
+          ocr::OCRAnalysis::cropToLabelRect(input, 50, 40, tight, true);
+      int diff = std::max({std::abs(fast.x - full.x),
+                           std::abs(fast.y - full.y),
+                           std::abs(fast.br().x - full.br().x),
+                           std::abs(fast.br().y - full.br().y)});
+      bool ok = fast.empty() == full.empty() && diff <= tolerancePx;
+      std::cout << (ok ? "OK   " : "FAIL ") << argv[i] << "  ("
+                << (tight ? "label" : "backing") << ")  pyramid " << fast
+                << "  full " << full << "  max edge diff " << diff << "\n";
+      if (!ok) ++failures;
+    }
+  }
+  return failures == 0 ? 0 : 1;
 }
 
 int main(int argc, char *argv[]) {
+  if (argc >= 3 && std::string(argv[1]) == "--compare")
+    return compareWithFullResolution(argc, argv);
+
   if (argc < 4 || argc > 5) {
     printUsage(argv[0]);
     return 1;
@@ -0,0 +1,88 @@
+#include "OCRAnalysis.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Extracts a PDF's elements and checks that every expected DataMatrix text
+// was decoded, once with the default targeted scan and once with the
+// full-page 600 DPI scan added.  datamatrix_two_codes.pdf has one code drawn
+// as filled squares (a filled-shape candidate) and one drawn as stroked
+// lines (a cluster of other marks):
+//
+//   test_datamatrix datamatrix_two_codes.pdf DM-A1 DM-B2
+int main(int argc, char *argv[]) {
+  std::cout << "=== PDF DataMatrix Detection Test ===" << std::endl
+            << std::endl;
+
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <pdf_file> [expected_text ...]"
+              << std::endl;
+    return 1;
+  }
+
+#ifndef HAVE_ZXING
+  std::cout << "Built without ZXing; DataMatrix detection is disabled, "
+               "skipping."
+            << std::endl;
+  return 0;
+#else
+  std::string pdfPath = argv[1];
+  std::vector<std::string> expected(argv + 2, argv + argc);
+
+  std::cout << "Loading PDF: " << pdfPath << std::endl << std::endl;
+
+  int failures = 0;
+  for (bool fullPage : {false, true}) {
+    ocr::OCRConfig config;
+    config.fullPageDataMatrixScan = fullPage;
+    ocr::OCRAnalysis analyzer(config);
+
+    std::cout << (fullPage ? "Targeted and full-page scan" : "Targeted scan")
+              << std::endl;
+    ocr::OCRAnalysis::PDFElements result =
+        analyzer.extractPDFElements(pdfPath);
+    if (!result.success) {
+      std::cerr << "Failed to extract elements: " << result.errorMessage
+                << std::endl;
+      return 1;
+    }
+
+    std::cout << "DataMatrix codes found: " << result.dataMatrices.size()
+              << std::endl;
+    for (const auto &dm : result.dataMatrices) {
+      std::cout << "  \"" << dm.text << "\" at (" << std::fixed
+                << std::setprecision(1) << dm.x << ", " << dm.y << ") size "
+                << dm.width << "x" << dm.height
+                << (dm.sourceImageIndex < 0 ? " [page raster]" : " [image]")
+                << std::endl;
+    }
+
+    int missing = 0;
+    for (const auto &text : expected) {
+      bool found = std::any_of(
+          result.dataMatrices.begin(), result.dataMatrices.end(),
+          [&](const ocr::OCRAnalysis::PDFDataMatrix &dm) {
+            return dm.text == text;
+          });
+      if (!found) {
+        std::cerr << "MISSING: \"" << text << "\"" << std::endl;
+        missing++;
+      }
+    }
+    if (missing > 0) {
+      std::cerr << missing << " of " << expected.size()
+                << " expected code(s) not found" << std::endl;
+      failures++;
+    }
+    std::cout << std::endl;
+  }
+
+  if (failures > 0)
+    return 1;
+  std::cout << "All expected codes found." << std::endl;
+  return 0;
+#endif
+}
@@ -0,0 +1,241 @@
+#include "ElementStore.hpp"
+#include "OCRAnalysis.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string &what) {
+  std::cout << (ok ? "  ok    " : "  FAIL  ") << what << std::endl;
+  if (!ok)
+    failures++;
+}
+
+ocr::TextRegion makeRegion(const std::string &text, double x, double y,
+                           double w, double h, const std::string &font,
+                           int level) {
+  ocr::TextRegion r;
+  r.text = text;
+  r.boundingBox = cv::Rect(static_cast<int>(x), static_cast<int>(y),
+                           static_cast<int>(w), static_cast<int>(h + 0.5));
+  r.confidence = 80.0f;
+  r.level = level;
+  r.orientation = ocr::TextOrientation::Horizontal;
+  r.preciseX = x;
+  r.preciseY = y;
+  r.preciseWidth = w;
+  r.preciseHeight = h;
+  r.fontName = font;
+  r.fontSize = h;
+  r.isBold = font.find("Bold") != std::string::npos;
+  r.isItalic = font.find("Italic") != std::string::npos;
+  return r;
+}
+
+// A small label: two lines that share Y within the tolerance, an empty
+// word, a region without precise geometry and a page number above the
+// int8 range.
+std::vector<ocr::TextRegion> syntheticRegions() {
+  std::vector<ocr::TextRegion> v;
+  v.push_back(makeRegion("Batch", 120.0, 300.5, 30.0, 9.0, "Arial-Bold", 1));
+  v.push_back(makeRegion("LOT", 20.0, 301.0, 18.0, 9.0, "Arial-Bold", 1));
+  v.push_back(makeRegion("12345", 60.0, 299.8, 28.0, 9.0, "Arial", 1));
+  v.push_back(makeRegion("Expiry", 20.0, 280.0, 32.0, 8.0, "Arial", 1));
+  v.push_back(makeRegion("2027-01", 70.0, 281.5, 40.0, 8.0, "Arial-Italic", 1));
+  v.push_back(makeRegion("", 5.0, 5.0, 0.0, 0.0, "", 1));
+  v.push_back(makeRegion("Page", 200.0, 10.0, 20.0, 6.0, "Courier", 300));
+  ocr::TextRegion ocrWord = makeRegion("ocr", 0, 0, 0, 0, "", 1);
+  ocrWord.boundingBox = cv::Rect(150, 40, 25, 10); // pixels only
+  v.push_back(ocrWord);
+  return v;
+}
+
+bool sameRegion(const ocr::TextRegion &a, const ocr::TextRegion &b) {
+  return a.text == b.text && a.boundingBox == b.boundingBox &&
+         a.confidence == b.confidence && a.level == b.level &&
+         a.orientation == b.orientation && a.preciseX == b.preciseX &&
+         a.preciseY == b.preciseY && a.preciseWidth == b.preciseWidth &&
+         a.preciseHeight == b.preciseHeight && a.fontName == b.fontName &&
+         a.fontSize == b.fontSize && a.isBold == b.isBold &&
+         a.isItalic == b.isItalic;
+}
+
+// The vector code the store replaces: the union box used for text-only
+// bounds in create_relative_map, a centre-in-box filter and a Y-then-X
+// reading order with lines cut at yTolerance from their first region.
+void vectorBounds(const std::vector<ocr::TextRegion> &regions, double &minX,
+                  double &minY, double &maxX, double &maxY) {
+  minX = minY = std::numeric_limits<double>::max();
+  maxX = maxY = std::numeric_limits<double>::lowest();
+  for (const auto &t : regions) {
+    double tx = (t.preciseWidth > 0) ? t.preciseX : t.boundingBox.x;
+    double ty = (t.preciseWidth > 0) ? t.preciseY : t.boundingBox.y;
+    double tw = (t.preciseWidth > 0) ? t.preciseWidth : t.boundingBox.width;
+    double th = (t.preciseWidth > 0) ? t.preciseHeight : t.boundingBox.height;
+    minX = std::min(minX, tx);
+    minY = std::min(minY, ty);
+    maxX = std::max(maxX, tx + tw);
+    maxY = std::max(maxY, ty + th);
+  }
+}
+
+std::vector<uint32_t>
+vectorInBounds(const std::vector<ocr::TextRegion> &regions, double minX,
+               double minY, double maxX, double maxY) {
+  std::vector<uint32_t> out;
+  for (size_t i = 0; i < regions.size(); i++) {
+    const auto &t = regions[i];
+    double cx = t.preciseX + t.preciseWidth / 2.0;
+    double cy = t.preciseY + t.preciseHeight / 2.0;
+    if (cx >= minX && cx <= maxX && cy >= minY && cy <= maxY)
+      out.push_back(static_cast<uint32_t>(i));
+  }
+  return out;
+}
+
+std::vector<uint32_t>
+vectorReadingOrder(const std::vector<ocr::TextRegion> &regions,
+                   double yTolerance) {
+  std::vector<uint32_t> order(regions.size());
+  std::iota(order.begin(), order.end(), 0u);
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    return regions[a].preciseY < regions[b].preciseY;
+  });
+
+  std::vector<uint32_t> out;
+  std::vector<uint32_t> line;
+  for (uint32_t idx : order) {
+    if (!line.empty() &&
+        regions[idx].preciseY - regions[line.front()].preciseY > yTolerance) {
+      std::stable_sort(line.begin(), line.end(), [&](uint32_t a, uint32_t b) {
+        return regions[a].preciseX < regions[b].preciseX;
+      });
+      out.insert(out.end(), line.begin(), line.end());
+      line.clear();
+    }
+    line.push_back(idx);
+  }
+  std::stable_sort(line.begin(), line.end(), [&](uint32_t a, uint32_t b) {
+    return regions[a].preciseX < regions[b].preciseX;
+  });
+  out.insert(out.end(), line.begin(), line.end());
+  return out;
+}
+
+void checkStore(const std::string &name,
+                const std::vector<ocr::TextRegion> &regions) {
+  std::cout << name << " (" << regions.size() << " regions)" << std::endl;
+
+  ocr::TextRegionStore store = ocr::TextRegionStore::fromRegions(regions);
+  check(store.size() == regions.size(), "size matches");
+
+  // Round trip
+  std::vector<ocr::TextRegion> back = store.toRegions();
+  bool same = back.size() == regions.size();
+  for (size_t i = 0; same && i < regions.size(); i++)
+    same = sameRegion(back[i], regions[i]);
+  check(same, "toRegions() reproduces every field");
+
+  // Font interning: one id per distinct name, empty name is id 0
+  std::vector<std::string> distinct;
+  for (const auto &r : regions)
+    if (!r.fontName.empty())
+      distinct.push_back(r.fontName);
+  std::sort(distinct.begin(), distinct.end());
+  distinct.erase(std::unique(distinct.begin(), distinct.end()),
+                 distinct.end());
+  check(store.fonts().size() == distinct.size() + 1,
+        "font table holds " + std::to_string(distinct.size()) +
+            " distinct names plus the empty one");
+  bool idsOk = true;
+  for (size_t i = 0; i < regions.size() && idsOk; i++) {
+    idsOk = store.fontName(i) == regions[i].fontName &&
+            (store.fontId(i) == 0) == regions[i].fontName.empty();
+    for (size_t j = 0; j < i && idsOk; j++)
+      idsOk = (store.fontId(i) == store.fontId(j)) ==
+              (regions[i].fontName == regions[j].fontName);
+  }
+  check(idsOk, "equal names share an id, different names do not");
+
+  if (regions.empty())
+    return;
+
+  // Bounds
+  double sMinX, sMinY, sMaxX, sMaxY, vMinX, vMinY, vMaxX, vMaxY;
+  bool haveBounds = store.bounds(sMinX, sMinY, sMaxX, sMaxY);
+  vectorBounds(regions, vMinX, vMinY, vMaxX, vMaxY);
+  check(haveBounds && sMinX == vMinX && sMinY == vMinY && sMaxX == vMaxX &&
+            sMaxY == vMaxY,
+        "bounds() matches the vector union box");
+
+  // indicesInBounds over the whole box and each quadrant
+  double midX = (vMinX + vMaxX) / 2.0, midY = (vMinY + vMaxY) / 2.0;
+  const double boxes[][4] = {{vMinX, vMinY, vMaxX, vMaxY},
+                             {vMinX, vMinY, midX, midY},
+                             {midX, vMinY, vMaxX, midY},
+                             {vMinX, midY, midX, vMaxY},
+                             {midX, midY, vMaxX, vMaxY}};
+  bool inOk = true;
+  for (const auto &b : boxes)
+    inOk = inOk && store.indicesInBounds(b[0], b[1], b[2], b[3]) ==
+                       vectorInBounds(regions, b[0], b[1], b[2], b[3]);
+  check(inOk, "indicesInBounds() matches the vector filter");
+
+  // Reading order at a few tolerances
+  bool orderOk = true;
+  for (double tol : {0.0, 2.0, 25.0})
+    orderOk = orderOk &&
+              store.sortedByPosition(tol) == vectorReadingOrder(regions, tol);
+  check(orderOk, "sortedByPosition() matches the vector reading order");
+
+  size_t vectorBytes = regions.capacity() * sizeof(ocr::TextRegion);
+  std::cout << "        store " << store.memoryBytes() << " bytes, vector at "
+            << "least " << vectorBytes << " bytes" << std::endl;
+}
+
+} // namespace
+
+// Checks TextRegionStore against the std::vector<TextRegion> code it stands
+// in for: fromRegions()/toRegions() round trip, font interning, bounds(),
+// indicesInBounds() and sortedByPosition().  A built-in region set is always
+// checked; given a PDF, its page-1 words (visible and hidden) are checked
+// too:
+//
+//   test_element_store [pdf_file]
+int main(int argc, char *argv[]) {
+  std::cout << "=== Text Region Store Test ===" << std::endl << std::endl;
+
+  checkStore("Built-in regions", syntheticRegions());
+  std::cout << std::endl;
+
+  if (argc >= 2) {
+    std::string pdfPath = argv[1];
+    ocr::OCRAnalysis analyzer;
+    ocr::OCRResult text = analyzer.extractTextFromPDF(
+        pdfPath, ocr::OCRAnalysis::PDFExtractionLevel::Word);
+    if (!text.success) {
+      std::cerr << "Failed to extract text: " << text.errorMessage
+                << std::endl;
+      return 1;
+    }
+    std::vector<ocr::TextRegion> words = text.regions;
+    words.insert(words.end(), text.hiddenRegions.begin(),
+                 text.hiddenRegions.end());
+    checkStore(pdfPath, words);
+    std::cout << std::endl;
+  }
+
+  if (failures > 0) {
+    std::cerr << failures << " check(s) failed" << std::endl;
+    return 1;
+  }
+  std::cout << "TextRegionStore matches the vector code." << std::endl;
+  return 0;
+}
@@ -0,0 +1,230 @@
+#include "OCRAnalysis.hpp"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using Analysis = ocr::OCRAnalysis;
+
+namespace {
+
+// Copies every page-1 element the visitor is handed.  The collecting
+// extractors only read page 1, so later pages are counted but not kept.
+struct Collector : Analysis::PDFVisitor {
+  std::vector<ocr::TextRegion> words;
+  std::vector<Analysis::PDFRectangle> rects;
+  std::vector<Analysis::PDFLine> lines;
+  std::vector<Analysis::PDFEmbeddedImage> images;
+  int page = 0;
+  int calls = 0;
+
+  void onPageBegin(int pageNumber, double, double) override {
+    page = pageNumber;
+  }
+  void onWord(const ocr::TextRegion &w) override {
+    calls++;
+    if (page == 1)
+      words.push_back(w);
+  }
+  void onRect(const Analysis::PDFRectangle &r) override {
+    calls++;
+    if (page == 1)
+      rects.push_back(r);
+  }
+  void onLine(const Analysis::PDFLine &l) override {
+    calls++;
+    if (page == 1)
+      lines.push_back(l);
+  }
+  void onImage(const Analysis::PDFEmbeddedImage &img) override {
+    calls++;
+    if (page == 1)
+      images.push_back(img);
+  }
+};
+
+// Tolerance in points for path and image coordinates, which the visitor
+// flips back from TextOutputDev's y-down space.
+constexpr double kTol = 0.5;
+
+bool near(double a, double b) { return std::abs(a - b) <= kTol; }
+
+int failures = 0;
+
+void check(bool ok, const std::string &what) {
+  std::cout << (ok ? "  ok    " : "  FAIL  ") << what << std::endl;
+  if (!ok)
+    failures++;
+}
+
+std::string countStr(size_t visited, size_t collected) {
+  return std::to_string(visited) + " visited, " + std::to_string(collected) +
+         " collected";
+}
+
+} // namespace
+
+// Visits a PDF and checks that the streamed words, rectangles, lines and
+// images match what extractTextFromPDF(), extractRectanglesFromPDF(),
+// extractLinesFromPDF() and extractEmbeddedImagesFromPDF() collect from
+// page 1 with the same thresholds:
+//
+//   test_visit_pdf L20033877.pdf [min_size] [min_length]
+int main(int argc, char *argv[]) {
+  std::cout << "=== PDF Visitor Test ===" << std::endl << std::endl;
+
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <pdf_file> [min_size] [min_length]"
+              << std::endl;
+    std::cerr << "  min_size    Minimum rectangle size in points (default: 5)"
+              << std::endl;
+    std::cerr << "  min_length  Minimum line length in points (default: 5)"
+              << std::endl;
+    return 1;
+  }
+
+  std::string pdfPath = argv[1];
+  double minSize = (argc >= 3) ? std::stod(argv[2]) : 5.0;
+  double minLength = (argc >= 4) ? std::stod(argv[3]) : 5.0;
+
+  std::cout << "Loading PDF: " << pdfPath << std::endl << std::endl;
+
+  Analysis analyzer;
+  Collector visitor;
+  Analysis::PDFVisitResult visit =
+      analyzer.visitPDF(pdfPath, visitor, minSize, minLength);
+  if (!visit.success) {
+    std::cerr << "Failed to visit PDF: " << visit.errorMessage << std::endl;
+    return 1;
+  }
+
+  ocr::OCRResult text =
+      analyzer.extractTextFromPDF(pdfPath, Analysis::PDFExtractionLevel::Word);
+  Analysis::PDFRectanglesResult rects =
+      analyzer.extractRectanglesFromPDF(pdfPath, minSize);
+  Analysis::PDFLinesResult lines =
+      analyzer.extractLinesFromPDF(pdfPath, minLength);
+  Analysis::PDFEmbeddedImagesResult images =
+      analyzer.extractEmbeddedImagesFromPDF(pdfPath);
+  if (!text.success || !rects.success || !lines.success || !images.success) {
+    std::cerr << "Failed to extract elements for comparison" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Visited " << visit.pageCount << " page(s) in " << std::fixed
+            << std::setprecision(2) << visit.processingTimeMs << " ms"
+            << std::endl;
+
+  check(visit.wordCount + visit.rectangleCount + visit.lineCount +
+                visit.imageCount ==
+            visitor.calls,
+        "result counts match the callbacks made");
+
+  // The visitor skips render-mode-3 text but does no covered-text
+  // filtering, so it sees the visible words plus the covered ones
+  // extractTextFromPDF() moves to hiddenRegions (confidence 0 marks the
+  // render-mode-3 ones).  Both keep Poppler's word order.
+  {
+    size_t covered = 0;
+    for (const auto &h : text.hiddenRegions)
+      if (h.confidence > 0)
+        covered++;
+    check(visitor.words.size() == text.regions.size() + covered,
+          "words: " + countStr(visitor.words.size(),
+                               text.regions.size() + covered));
+  }
+  {
+    size_t matched = 0, next = 0;
+    for (const auto &r : text.regions) {
+      while (next < visitor.words.size() &&
+             !(visitor.words[next].text == r.text &&
+               visitor.words[next].preciseX == r.preciseX &&
+               visitor.words[next].preciseY == r.preciseY &&
+               visitor.words[next].preciseWidth == r.preciseWidth &&
+               visitor.words[next].preciseHeight == r.preciseHeight))
+        next++;
+      if (next == visitor.words.size())
+        break;
+      next++;
+      matched++;
+    }
+    check(matched == text.regions.size(),
+          "visible words found in order with identical boxes (" +
+              std::to_string(matched) + " of " +
+              std::to_string(text.regions.size()) + ")");
+    if (!text.regions.empty() && !visitor.words.empty()) {
+      const auto &w = visitor.words.front();
+      std::cout << "        first word \"" << w.text << "\" at ("
+                << std::setprecision(1) << w.preciseX << ", " << w.preciseY
+                << ") page " << w.level << std::endl;
+    }
+  }
+
+  check(visitor.rects.size() == rects.rectangles.size(),
+        "rectangles: " +
+            countStr(visitor.rects.size(), rects.rectangles.size()));
+  if (visitor.rects.size() == rects.rectangles.size()) {
+    size_t bad = 0;
+    for (size_t i = 0; i < visitor.rects.size(); i++) {
+      const auto &a = visitor.rects[i], &b = rects.rectangles[i];
+      if (!near(a.x, b.x) || !near(a.y, b.y) || !near(a.width, b.width) ||
+          !near(a.height, b.height) || a.filled != b.filled ||
+          a.stroked != b.stroked) {
+        if (bad++ == 0)
+          std::cout << "        first mismatch #" << i << ": (" << a.x << ", "
+                    << a.y << " " << a.width << "x" << a.height << ") vs ("
+                    << b.x << ", " << b.y << " " << b.width << "x" << b.height
+                    << ")" << std::endl;
+      }
+    }
+    check(bad == 0, "rectangle boxes match");
+  }
+
+  check(visitor.lines.size() == lines.lines.size(),
+        "lines: " + countStr(visitor.lines.size(), lines.lines.size()));
+  if (visitor.lines.size() == lines.lines.size()) {
+    size_t bad = 0;
+    for (size_t i = 0; i < visitor.lines.size(); i++) {
+      const auto &a = visitor.lines[i], &b = lines.lines[i];
+      if (!near(a.x1, b.x1) || !near(a.y1, b.y1) || !near(a.x2, b.x2) ||
+          !near(a.y2, b.y2) || a.isHorizontal != b.isHorizontal ||
+          a.isVertical != b.isVertical) {
+        if (bad++ == 0)
+          std::cout << "        first mismatch #" << i << ": (" << a.x1
+                    << ", " << a.y1 << ")-(" << a.x2 << ", " << a.y2
+                    << ") vs (" << b.x1 << ", " << b.y1 << ")-(" << b.x2
+                    << ", " << b.y2 << ")" << std::endl;
+      }
+    }
+    check(bad == 0, "line endpoints match");
+  }
+
+  check(visitor.images.size() == images.images.size(),
+        "images: " + countStr(visitor.images.size(), images.images.size()));
+  if (visitor.images.size() == images.images.size()) {
+    size_t bad = 0;
+    for (size_t i = 0; i < visitor.images.size(); i++) {
+      const auto &a = visitor.images[i], &b = images.images[i];
+      if (a.width != b.width || a.height != b.height || !near(a.x, b.x) ||
+          !near(a.y, b.y) || !near(a.aabbMaxX, b.aabbMaxX) ||
+          !near(a.aabbMaxY, b.aabbMaxY)) {
+        if (bad++ == 0)
+          std::cout << "        first mismatch #" << i << ": (" << a.x << ", "
+                    << a.y << ")-(" << a.aabbMaxX << ", " << a.aabbMaxY
+                    << ") vs (" << b.x << ", " << b.y << ")-(" << b.aabbMaxX
+                    << ", " << b.aabbMaxY << ")" << std::endl;
+      }
+    }
+    check(bad == 0, "image sizes and placements match");
+  }
+
+  std::cout << std::endl;
+  if (failures > 0) {
+    std::cerr << failures << " check(s) failed" << std::endl;
+    return 1;
+  }
+  std::cout << "visitPDF matches the collecting extractors." << std::endl;
+  return 0;
+}